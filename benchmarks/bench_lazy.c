@@ -0,0 +1,75 @@
+// Benchmark of a filter pipeline evaluated eagerly and by vdl_Force.
+// The pipeline keeps the items of a double vector where two int vectors are equal and the
+// first one equals a given item, and the results of both evaluations are checked to agree.
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../include/vdl.h"
+
+#define BENCH_LENGTH 20000000
+#define BENCH_REPEAT 5
+
+static VDL_VECTOR_P bench_NewRandomVector(const VDL_TYPE_T type)
+{
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(type, BENCH_LENGTH);
+    v->Length      = BENCH_LENGTH;
+    vdl_for_i(BENCH_LENGTH)
+    {
+        if (type == VDL_TYPE_INT)
+            vdl_vector_primitive_UnsafeSetInt(v, i, rand() % 3);
+        else
+            vdl_vector_primitive_UnsafeSetDouble(v, i, (double) rand() / RAND_MAX);
+    }
+    return v;
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(-1);
+    srand(2023);
+
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a     = vdl_Root(bench_NewRandomVector(VDL_TYPE_INT));
+    VDL_VECTOR_P b     = vdl_Root(bench_NewRandomVector(VDL_TYPE_INT));
+    VDL_VECTOR_P x     = vdl_Root(bench_NewRandomVector(VDL_TYPE_DOUBLE));
+    VDL_VECTOR_P item  = vdl_Root(vdl_Slice(b, 0, 1, 1));
+    VDL_VECTOR_P graph = vdl_Root(vdl_LazySubset(x,
+                                                 vdl_LazyWhich(vdl_LazyStrictEqual(vdl_LazyStrictEqual(a, b),
+                                                                                   vdl_LazyStrictEqual(a, item)))));
+
+    double eager_time = -1;
+    double lazy_time  = -1;
+    for (int k = 0; k < BENCH_REPEAT; k++)
+    {
+        vdl_RootScopeBegin();
+        double start       = vdl_TimeInMicroseconds();
+        VDL_VECTOR_P eager = vdl_Root(vdl_Subset(x, vdl_Which(vdl_StrictEqual(vdl_StrictEqual(a, b), vdl_StrictEqual(a, item)))));
+        double time        = (vdl_TimeInMicroseconds() - start) / 1e3;
+        if (eager_time < 0 || time < eager_time)
+            eager_time = time;
+
+        start             = vdl_TimeInMicroseconds();
+        VDL_VECTOR_P lazy = vdl_Root(vdl_Force(graph));
+        time              = (vdl_TimeInMicroseconds() - start) / 1e3;
+        if (lazy_time < 0 || time < lazy_time)
+            lazy_time = time;
+
+        if (eager->Length != lazy->Length ||
+            memcmp(eager->Data, lazy->Data, sizeof(double) * (size_t) eager->Length) != 0)
+        {
+            printf("Results of vdl_Force differ from the eager evaluation!\n");
+            return 1;
+        }
+
+        vdl_RootScopeEnd();
+        vdl_GarbageCollectorCleanUp();
+    }
+
+    printf("%-10s %10s %8s\n", "Pipeline", "Time (ms)", "Speedup");
+    printf("%-10s %10.2f %7.2fx\n", "eager", eager_time, 1.0);
+    printf("%-10s %10.2f %7.2fx\n", "vdl_Force", lazy_time, eager_time / lazy_time);
+
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorKill();
+    return 0;
+}
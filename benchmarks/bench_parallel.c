@@ -0,0 +1,111 @@
+// Benchmark of the vector operations run by the thread pool.
+// Every operation is timed with one thread and with the default number of threads, and the
+// results of both runs are checked to agree.
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../include/vdl.h"
+
+#define BENCH_LENGTH 20000000
+#define BENCH_REPEAT 5
+#define BENCH_OP_NUM 4
+
+static const char *const bench_OpNames[BENCH_OP_NUM] = {"vdl_StrictEqual", "vdl_Subset", "vdl_vector_SetByIndex", "vdl_vector_Set"};
+
+// Run an operation once. The vector written by the operation is returned
+static VDL_VECTOR_P bench_RunOp(const int op, VDL_VECTOR_P a, VDL_VECTOR_P b, VDL_VECTOR_P x, VDL_VECTOR_P index)
+{
+    switch (op)
+    {
+        case 0:
+            return vdl_StrictEqual(a, b);
+        case 1:
+            return vdl_Subset(x, index);
+        case 2:
+        {
+            VDL_VECTOR_P result = vdl_ShallowCopy(x);
+            vdl_vector_SetByIndex(result, index, vdl_Slice(x, 0, 1, 1));
+            return result;
+        }
+        default:
+        {
+            VDL_VECTOR_P result = vdl_ShallowCopy(x);
+            vdl_vector_Set(result, vdl_Subset(x, vdl_vector_primitive_NewByIndex(BENCH_LENGTH - 1, 1)));
+            return result;
+        }
+    }
+}
+
+// Best time of a few runs in milliseconds. The result of the last run is returned by `result`
+static double bench_Op(const int op, VDL_VECTOR_P a, VDL_VECTOR_P b, VDL_VECTOR_P x, VDL_VECTOR_P index, VDL_VECTOR_P *result)
+{
+    double best = -1;
+    for (int k = 0; k < BENCH_REPEAT; k++)
+    {
+        const double start = vdl_TimeInMicroseconds();
+        *result            = bench_RunOp(op, a, b, x, index);
+        const double time  = (vdl_TimeInMicroseconds() - start) / 1e3;
+        if (best < 0 || time < best)
+            best = time;
+        if (k < BENCH_REPEAT - 1)
+            vdl_GarbageCollectorCleanUp();
+    }
+    return best;
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(-1);
+    srand(2023);
+
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a     = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, BENCH_LENGTH));
+    VDL_VECTOR_P b     = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, BENCH_LENGTH));
+    VDL_VECTOR_P x     = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, BENCH_LENGTH));
+    VDL_VECTOR_P index = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INDEX, BENCH_LENGTH));
+    a->Length          = BENCH_LENGTH;
+    b->Length          = BENCH_LENGTH;
+    x->Length          = BENCH_LENGTH;
+    index->Length      = BENCH_LENGTH;
+    vdl_for_i(BENCH_LENGTH)
+    {
+        vdl_vector_primitive_UnsafeSetInt(a, i, rand() % 3);
+        vdl_vector_primitive_UnsafeSetInt(b, i, rand() % 3);
+        vdl_vector_primitive_UnsafeSetDouble(x, i, (double) rand() / RAND_MAX);
+        vdl_vector_primitive_UnsafeSetIndex(index, i, (VDL_INDEX_T) (rand() % BENCH_LENGTH));
+    }
+
+    const int thread_num = vdl_ThreadPoolThreadNum();
+    printf("%-22s %-8s %10s %8s\n", "Operation", "Threads", "Time (ms)", "Speedup");
+
+    for (int op = 0; op < BENCH_OP_NUM; op++)
+    {
+        vdl_RootScopeBegin();
+
+        vdl_ThreadPoolSetThreadNum(1);
+        VDL_VECTOR_P expected    = NULL;
+        const double serial_time = bench_Op(op, a, b, x, index, &expected);
+        vdl_Root(expected);
+
+        vdl_ThreadPoolSetThreadNum(thread_num);
+        VDL_VECTOR_P result        = NULL;
+        const double parallel_time = bench_Op(op, a, b, x, index, &result);
+
+        if (result->Length != expected->Length ||
+            memcmp(expected->Data, result->Data, VDL_TYPE_SIZE[result->Type] * (size_t) result->Length) != 0)
+        {
+            printf("Results of %s differ between thread numbers!\n", bench_OpNames[op]);
+            return 1;
+        }
+
+        printf("%-22s %-8d %10.2f %7.2fx\n", bench_OpNames[op], 1, serial_time, 1.0);
+        printf("%-22s %-8d %10.2f %7.2fx\n", bench_OpNames[op], thread_num, parallel_time, serial_time / parallel_time);
+
+        vdl_RootScopeEnd();
+        vdl_GarbageCollectorCleanUp();
+    }
+
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorKill();
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Benchmark of vdl_StrictEqual with each SIMD instruction set supported by the CPU.
+// Every type is compared item by item and against a broadcast item, and the results of
+// the SIMD kernels are checked against the scalar loops.
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../include/vdl.h"
+
+#define BENCH_LENGTH 10000000
+#define BENCH_REPEAT 7
+
+static VDL_VECTOR_P bench_NewRandomVector(const VDL_TYPE_T type)
+{
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(type, BENCH_LENGTH);
+    v->Length      = BENCH_LENGTH;
+
+    // Few distinct values, so about a third of the items are equal
+    vdl_for_i(BENCH_LENGTH)
+    {
+        const int r = rand() % 3;
+        switch (type)
+        {
+            case VDL_TYPE_CHAR:
+                vdl_vector_primitive_UnsafeSetChar(v, i, (char) r);
+                break;
+            case VDL_TYPE_INT:
+                vdl_vector_primitive_UnsafeSetInt(v, i, r);
+                break;
+            case VDL_TYPE_DOUBLE:
+                vdl_vector_primitive_UnsafeSetDouble(v, i, (double) r);
+                break;
+            case VDL_TYPE_VECTOR_POINTER:
+                vdl_vector_primitive_UnsafeSetVectorPointer(v, i, r == 0 ? NULL : v);
+                break;
+            case VDL_TYPE_INDEX:
+                vdl_vector_primitive_UnsafeSetIndex(v, i, r);
+                break;
+        }
+    }
+    return v;
+}
+
+// Best time of a few runs in milliseconds. The result of the last run is returned by `result`
+static double bench_StrictEqual(VDL_VECTOR_P v1, VDL_VECTOR_P v2, VDL_VECTOR_P *result)
+{
+    double best = -1;
+    for (int k = 0; k < BENCH_REPEAT; k++)
+    {
+        const double start = vdl_TimeInMicroseconds();
+        *result            = vdl_StrictEqual(v1, v2);
+        const double time  = (vdl_TimeInMicroseconds() - start) / 1e3;
+        if (best < 0 || time < best)
+            best = time;
+    }
+    return best;
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(-1);
+    srand(2023);
+
+    const VDL_SIMD_T supported = vdl_SimdDetect();
+    printf("Best instruction set: %s\n", VDL_SIMD_STRING[supported]);
+    printf("%-24s %-10s %-16s %10s %8s\n", "Type", "Operand", "Instruction set", "Time (ms)", "Speedup");
+
+    for (int type = 0; type < VDL_TYPE_NUM; type++)
+    {
+        vdl_RootScopeBegin();
+        VDL_VECTOR_P v1   = vdl_Root(bench_NewRandomVector((VDL_TYPE_T) type));
+        VDL_VECTOR_P v2   = vdl_Root(bench_NewRandomVector((VDL_TYPE_T) type));
+        VDL_VECTOR_P item = vdl_Root(vdl_Slice(v2, 0, 1, 1));
+
+        VDL_VECTOR_P operands[2]          = {v2, item};
+        static const char *const names[2] = {"vector", "broadcast"};
+
+        for (int k = 0; k < 2; k++)
+        {
+            vdl_RootScopeBegin();
+            VDL_VECTOR_P expected = NULL;
+            double scalar_time    = 0;
+            for (int level = VDL_SIMD_NONE; level <= (int) supported; level++)
+            {
+                vdl_SimdSetLevel((VDL_SIMD_T) level);
+
+                VDL_VECTOR_P result = NULL;
+                const double time   = bench_StrictEqual(v1, operands[k], &result);
+                if (level == VDL_SIMD_NONE)
+                {
+                    expected    = vdl_Root(result);
+                    scalar_time = time;
+                }
+                else if (memcmp(expected->Data, result->Data, sizeof(int) * BENCH_LENGTH) != 0)
+                {
+                    printf("Results of %s differ from the scalar loops!\n", VDL_SIMD_STRING[level]);
+                    return 1;
+                }
+
+                printf("%-24s %-10s %-16s %10.2f %7.2fx\n",
+                       VDL_TYPE_STRING[type],
+                       names[k],
+                       VDL_SIMD_STRING[level],
+                       time,
+                       scalar_time / time);
+                vdl_GarbageCollectorCleanUp();
+            }
+            vdl_RootScopeEnd();
+        }
+
+        vdl_RootScopeEnd();
+        vdl_GarbageCollectorCleanUp();
+    }
+
+    vdl_GarbageCollectorKill();
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Benchmark of vdl_Which and vdl_WhichParallel on masks of different densities.
+// Every SIMD instruction set supported by the CPU is timed, and the results are checked
+// against the scalar loops.
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../include/vdl.h"
+
+#define BENCH_LENGTH 50000000
+#define BENCH_REPEAT 5
+
+static VDL_VECTOR_P bench_NewRandomMask(const int density)
+{
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, BENCH_LENGTH);
+    v->Length      = BENCH_LENGTH;
+    vdl_for_i(BENCH_LENGTH) vdl_vector_primitive_UnsafeSetInt(v, i, rand() % 100 < density);
+    return v;
+}
+
+// Best time of a few runs in milliseconds. A thread number of zero runs vdl_Which, and any other
+// number runs vdl_WhichParallel with that many threads in the pool.
+// The result of the last run is returned by `result`
+static double bench_Which(VDL_VECTOR_P v, const int thread_num, VDL_VECTOR_P *result)
+{
+    if (thread_num > 0)
+        vdl_ThreadPoolSetThreadNum(thread_num);
+
+    double best = -1;
+    for (int k = 0; k < BENCH_REPEAT; k++)
+    {
+        const double start = vdl_TimeInMicroseconds();
+        *result            = thread_num == 0 ? vdl_Which(v) : vdl_WhichParallel(v);
+        const double time  = (vdl_TimeInMicroseconds() - start) / 1e3;
+        if (best < 0 || time < best)
+            best = time;
+        if (k < BENCH_REPEAT - 1)
+            vdl_GarbageCollectorCleanUp();
+    }
+    return best;
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(-1);
+    srand(2023);
+
+    const VDL_SIMD_T supported = vdl_SimdDetect();
+    static const int densities[4]   = {1, 10, 50, 90};
+    static const int thread_nums[5] = {0, 2, 4, 8, 16};
+
+    printf("Best instruction set: %s\n", VDL_SIMD_STRING[supported]);
+    printf("%-8s %-16s %-8s %10s %8s\n", "Density", "Instruction set", "Threads", "Time (ms)", "Speedup");
+
+    for (int d = 0; d < 4; d++)
+    {
+        vdl_RootScopeBegin();
+        VDL_VECTOR_P mask     = vdl_Root(bench_NewRandomMask(densities[d]));
+        VDL_VECTOR_P expected = NULL;
+        double scalar_time    = 0;
+
+        for (int level = VDL_SIMD_NONE; level <= (int) supported; level++)
+        {
+            vdl_SimdSetLevel((VDL_SIMD_T) level);
+            for (int t = 0; t < 5; t++)
+            {
+                // Only the best instruction set is timed with multiple threads
+                if (t > 0 && level != (int) supported)
+                    continue;
+
+                VDL_VECTOR_P result = NULL;
+                const double time   = bench_Which(mask, thread_nums[t], &result);
+                if (expected == NULL)
+                {
+                    expected    = vdl_Root(result);
+                    scalar_time = time;
+                }
+                else if (result->Length != expected->Length ||
+                         memcmp(expected->Data, result->Data, sizeof(VDL_INDEX_T) * (size_t) result->Length) != 0)
+                {
+                    printf("Results of %s differ from the scalar loops!\n", VDL_SIMD_STRING[level]);
+                    return 1;
+                }
+
+                printf("%6d%%  %-16s %-8d %10.2f %7.2fx\n",
+                       densities[d],
+                       VDL_SIMD_STRING[level],
+                       thread_nums[t] == 0 ? 1 : thread_nums[t],
+                       time,
+                       scalar_time / time);
+                vdl_GarbageCollectorCleanUp();
+            }
+        }
+
+        vdl_RootScopeEnd();
+        vdl_GarbageCollectorCleanUp();
+    }
+
+    vdl_GarbageCollectorKill();
+    return 0;
+}
@@ -17,16 +17,48 @@
 /// Users can disable backtrace to improve performance. But the error message will not contain a backtrace for debugging.
 // #define VDL_BACKTRACE_DISABLE
 
+/// Users can change the alignment of the data containers of vectors. It must be a power of two and at least 16.
+// #define VDL_DATA_ALIGNMENT 64
+
+/// Users can store vector lengths, capacities and indices in a 64-bit long instead of an int to hold more than `INT_MAX` items.
+// #define VDL_64BIT_SIZE
+
+/// Users can poison the data of vectors constructed without initialization to catch reads of uninitialized elements in debug builds.
+// #define VDL_POISON_UNINITIALIZED
+
+/// Users can disable the SIMD kernels, such that only the scalar loops are used.
+// #define VDL_SIMD_DISABLE
+
 /*-----------------------------------------------------------------------------
  |  Standard libraries
  ----------------------------------------------------------------------------*/
 
+// `mremap` is a GNU extension. It only takes effect if this header is included first
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
+#include <sched.h>
 #include <setjmp.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// SIMD kernels are written with x86 intrinsics. Each kernel enables its own instruction set
+// by a target attribute, so the library does not need to be compiled for a specific CPU
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(VDL_SIMD_DISABLE)
+#define VDL_SIMD_X86
+#include <immintrin.h>
+#endif
 
 /*-----------------------------------------------------------------------------
  |  Header declaration sections
@@ -40,6 +72,7 @@
 #include "vdl_6_garbage_collector.h"
 #include "vdl_7_vector_memory.h"
 #include "vdl_8_vector_portal.h"
+#include "vdl_9_lazy_evaluation.h"
 
 
 /*-----------------------------------------------------------------------------
@@ -54,5 +87,6 @@
 #include "vdl_6_garbage_collector_def.h"
 #include "vdl_7_vector_memory_def.h"
 #include "vdl_8_vector_portal_def.h"
+#include "vdl_9_lazy_evaluation_def.h"
 
 #endif//VDL_VDL_H
@@ -36,6 +36,23 @@
 /// Get the fifth argument.
 #define vdl_GetArg5(arg1, arg2, arg3, arg4, arg5, ...) arg5
 
+/*-----------------------------------------------------------------------------
+ |  Index type
+ ----------------------------------------------------------------------------*/
+
+/// Integer type of vector lengths, capacities and indices.
+/// @details It is an int by default. Define `VDL_64BIT_SIZE` to use a long, so a vector
+/// can hold more than `INT_MAX` items. The long type needs to be 64-bit.
+#ifdef VDL_64BIT_SIZE
+#define VDL_INDEX_T long
+#define VDL_INDEX_MAX LONG_MAX
+#define VDL_INDEX_FORMAT "%ld"
+#else
+#define VDL_INDEX_T int
+#define VDL_INDEX_MAX INT_MAX
+#define VDL_INDEX_FORMAT "%d"
+#endif
+
 /*-----------------------------------------------------------------------------
  |  For loop
  ----------------------------------------------------------------------------*/
@@ -43,35 +60,35 @@
 #define vdl_for_i_name(line) vdl_PasteArg(_i, line)
 #define vdl_for_j_name(line) vdl_PasteArg(_j, line)
 
-/// A variadic macro similar to `range()` in python. The counter i is an int.
-/// @arg1 start (int). The start.
-/// @arg2 start (int), end (int). The start and the end.
-/// @arg3 start (int), end (int), step (int). The start, the end and the step size.
+/// A variadic macro similar to `range()` in python. The counter i is a VDL_INDEX_T.
+/// @arg1 end (VDL_INDEX_T). The end.
+/// @arg2 start (VDL_INDEX_T), end (VDL_INDEX_T). The start and the end.
+/// @arg3 start (VDL_INDEX_T), end (VDL_INDEX_T), step (VDL_INDEX_T). The start, the end and the step size.
 #define vdl_for_i(...) vdl_GetArg4(__VA_ARGS__, vdl_for_i_3, vdl_for_i_2, vdl_for_i_1)(__VA_ARGS__)
-#define vdl_for_i_1(end)                      \
-    const int vdl_for_i_name(__LINE__) = end; \
-    for (int i = 0; i < vdl_for_i_name(__LINE__); i++)
-#define vdl_for_i_2(start, end)               \
-    const int vdl_for_i_name(__LINE__) = end; \
-    for (int i = start; i < vdl_for_i_name(__LINE__); i++)
-#define vdl_for_i_3(start, end, step)         \
-    const int vdl_for_i_name(__LINE__) = end; \
-    for (int i = start; i < vdl_for_i_name(__LINE__); i += (step))
-
-/// A variadic macro similar to `range()` in python. The counter j is an int.
-/// @arg1 start (int). The start.
-/// @arg2 start (int), end (int). The start and the end.
-/// @arg3 start (int), end (int), step (int). The start, the end and the step size.
+#define vdl_for_i_1(end)                              \
+    const VDL_INDEX_T vdl_for_i_name(__LINE__) = end; \
+    for (VDL_INDEX_T i = 0; i < vdl_for_i_name(__LINE__); i++)
+#define vdl_for_i_2(start, end)                       \
+    const VDL_INDEX_T vdl_for_i_name(__LINE__) = end; \
+    for (VDL_INDEX_T i = start; i < vdl_for_i_name(__LINE__); i++)
+#define vdl_for_i_3(start, end, step)                 \
+    const VDL_INDEX_T vdl_for_i_name(__LINE__) = end; \
+    for (VDL_INDEX_T i = start; i < vdl_for_i_name(__LINE__); i += (step))
+
+/// A variadic macro similar to `range()` in python. The counter j is a VDL_INDEX_T.
+/// @arg1 end (VDL_INDEX_T). The end.
+/// @arg2 start (VDL_INDEX_T), end (VDL_INDEX_T). The start and the end.
+/// @arg3 start (VDL_INDEX_T), end (VDL_INDEX_T), step (VDL_INDEX_T). The start, the end and the step size.
 #define vdl_for_j(...) vdl_GetArg4(__VA_ARGS__, vdl_for_j_3, vdl_for_j_2, vdl_for_j_1)(__VA_ARGS__)
-#define vdl_for_j_1(end)                      \
-    const int vdl_for_j_name(__LINE__) = end; \
-    for (int j = 0; j < vdl_for_j_name(__LINE__); j++)
-#define vdl_for_j_2(start, end)               \
-    const int vdl_for_j_name(__LINE__) = end; \
-    for (int j = start; j < vdl_for_j_name(__LINE__); j++)
-#define vdl_for_j_3(start, end, step)         \
-    const int vdl_for_j_name(__LINE__) = end; \
-    for (int j = start; j < vdl_for_j_name(__LINE__); j += (step))
+#define vdl_for_j_1(end)                              \
+    const VDL_INDEX_T vdl_for_j_name(__LINE__) = end; \
+    for (VDL_INDEX_T j = 0; j < vdl_for_j_name(__LINE__); j++)
+#define vdl_for_j_2(start, end)                       \
+    const VDL_INDEX_T vdl_for_j_name(__LINE__) = end; \
+    for (VDL_INDEX_T j = start; j < vdl_for_j_name(__LINE__); j++)
+#define vdl_for_j_3(start, end, step)                 \
+    const VDL_INDEX_T vdl_for_j_name(__LINE__) = end; \
+    for (VDL_INDEX_T j = start; j < vdl_for_j_name(__LINE__); j += (step))
 
 /*-----------------------------------------------------------------------------
  |  Paste argument
@@ -118,5 +135,220 @@ static inline int vdl_CompareDouble(const void *a, const void *b);
 /// @return 1 if a > b, -1 if a < b and 0 if a == b.
 static inline int vdl_CompareAddress(const void *a, const void *b);
 
+/*-----------------------------------------------------------------------------
+ |  Hash address (mainly used by the vector table)
+ ----------------------------------------------------------------------------*/
+
+/// Hash an address.
+/// @details The low bits of heap addresses are mostly zero, so the bits are mixed
+/// before the hash value is reduced to a slot.
+/// @param p (const void *). An address.
+/// @return (size_t) The hash value.
+static inline size_t vdl_HashAddress(const void *p);
+
+/*-----------------------------------------------------------------------------
+ |  Alignment
+ ----------------------------------------------------------------------------*/
+
+/// Round an integer up to a multiple of an alignment.
+/// @param value (uintptr_t/size_t). An integer.
+/// @param alignment (uintptr_t/size_t). A power of two.
+#define vdl_AlignUp(value, alignment) (((value) + (alignment) - 1) & ~((alignment) - 1))
+
+/// Get the alignment of an address.
+/// @param p (const void *). An address.
+/// @return (size_t) The largest power of two that divides the address. 0 for NULL.
+static inline size_t vdl_AddressAlignment(const void *p);
+
+/*-----------------------------------------------------------------------------
+ |  Monotonic clock
+ ----------------------------------------------------------------------------*/
+
+/// Get the time of a monotonic clock.
+/// @return (double) The time in microseconds.
+static inline double vdl_TimeInMicroseconds(void);
+
+/*-----------------------------------------------------------------------------
+ |  SIMD instruction sets
+ ----------------------------------------------------------------------------*/
+
+/// SIMD instruction sets used by the vector kernels.
+/// @details
+/// VDL_SIMD_NONE: 0, scalar loops only. \n\n
+/// VDL_SIMD_SSE2: 1, 128-bit x86 vectors. \n\n
+/// VDL_SIMD_AVX2: 2, 256-bit x86 vectors. \n\n
+/// VDL_SIMD_AVX512: 3, 512-bit x86 vectors with AVX-512F and AVX-512BW.
+typedef enum VDL_SIMD_T
+{
+    VDL_SIMD_NONE   = 0,
+    VDL_SIMD_SSE2   = 1,
+    VDL_SIMD_AVX2   = 2,
+    VDL_SIMD_AVX512 = 3
+} VDL_SIMD_T;
+
+/// String representation of SIMD instruction sets.
+static const char *const VDL_SIMD_STRING[4] = {
+        [VDL_SIMD_NONE]   = "VDL_SIMD_NONE",
+        [VDL_SIMD_SSE2]   = "VDL_SIMD_SSE2",
+        [VDL_SIMD_AVX2]   = "VDL_SIMD_AVX2",
+        [VDL_SIMD_AVX512] = "VDL_SIMD_AVX512"};
+
+/// SIMD instruction set used by the vector kernels. -1 before it is detected.
+static int vdl_GlobalVar_SimdLevel = -1;
+
+/// Get the best SIMD instruction set supported by the CPU.
+/// @details The CPU is queried by cpuid. It is always `VDL_SIMD_NONE` if the SIMD kernels
+/// are not compiled.
+/// @return (VDL_SIMD_T) The instruction set.
+static inline VDL_SIMD_T vdl_SimdDetect(void);
+
+/// Get the SIMD instruction set used by the vector kernels.
+/// @details It is detected on the first call.
+/// @return (VDL_SIMD_T) The instruction set.
+static inline VDL_SIMD_T vdl_SimdLevel(void);
+
+/// Set the SIMD instruction set used by the vector kernels.
+/// @details An instruction set not supported by the CPU is lowered to the best supported one.
+/// This is mainly used to compare the kernels with the scalar loops.
+/// @param level (VDL_SIMD_T). The instruction set.
+static inline void vdl_SimdSetLevel(VDL_SIMD_T level);
+
+/*-----------------------------------------------------------------------------
+ |  Thread pool
+ ----------------------------------------------------------------------------*/
+
+#define VDL_THREAD_POOL_MAX_THREAD_NUM 64
+
+/// Minimum number of items for a parallel loop to use more than one thread.
+#define VDL_PARALLEL_MIN_LENGTH 65536
+
+/// Number of items of a chunk of the parallel vector operations. It is a multiple of 64,
+/// so the chunks of an aligned result do not share cache lines.
+#define VDL_PARALLEL_GRAIN 16384
+
+/// A function run on a chunk of a parallel loop.
+/// @details It is run by a worker thread, so it must not allocate vectors or throw exceptions.
+/// @param begin (VDL_INDEX_T). Index of the first item of the chunk.
+/// @param end (VDL_INDEX_T). Index after the last item of the chunk.
+/// @param context (void *). Context of the loop.
+typedef void (*VDL_PARALLEL_FUNCTION_T)(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// A range of chunks owned by a worker of a parallel loop.
+/// @details The owner takes chunks from the front, while other workers steal the back half.
+/// @param Lock (pthread_mutex_t). Lock of the range.
+/// @param Next (VDL_INDEX_T). The next chunk.
+/// @param End (VDL_INDEX_T). The chunk after the last one.
+typedef struct VDL_PARALLEL_RANGE_T
+{
+    pthread_mutex_t Lock;
+    VDL_INDEX_T Next;
+    VDL_INDEX_T End;
+} VDL_PARALLEL_RANGE_T;
+
+/// A global variable for storing the state of the thread pool.
+/// @details Worker threads are started by the first parallel loop that needs them, and they
+/// sleep between loops. The calling thread works as the first worker of every loop.
+/// @param ThreadNum (int). Number of threads used by a loop, including the calling thread. 0 before it is detected.
+/// @param StartedNum (int). Number of started worker threads.
+/// @param Threads (pthread_t [VDL_THREAD_POOL_MAX_THREAD_NUM]). Worker threads. The first one is not used.
+/// @param Generations (unsigned int [VDL_THREAD_POOL_MAX_THREAD_NUM]). The last loop seen by every worker thread.
+/// @param Lock (pthread_mutex_t). Lock of the pool.
+/// @param WorkReady (pthread_cond_t). Signaled when a loop is started or the pool is shut down.
+/// @param WorkDone (pthread_cond_t). Signaled when the last worker thread finishes a loop.
+/// @param Generation (unsigned int). Number of loops started.
+/// @param Shutdown (int). Whether the worker threads should exit.
+/// @param Running (int). Whether a loop is running.
+/// @param Busy (int). Number of worker threads that have not finished the loop.
+/// @param WorkerNum (int). Number of workers of the loop, including the calling thread.
+/// @param Begin (VDL_INDEX_T). Index of the first item of the loop.
+/// @param End (VDL_INDEX_T). Index after the last item of the loop.
+/// @param Grain (VDL_INDEX_T). Number of items of a chunk.
+/// @param Function (VDL_PARALLEL_FUNCTION_T). Function of the loop.
+/// @param Context (void *). Context of the loop.
+/// @param Ranges (VDL_PARALLEL_RANGE_T [VDL_THREAD_POOL_MAX_THREAD_NUM]). Chunks owned by the workers.
+static struct
+{
+    int ThreadNum;
+    int StartedNum;
+    pthread_t Threads[VDL_THREAD_POOL_MAX_THREAD_NUM];
+    unsigned int Generations[VDL_THREAD_POOL_MAX_THREAD_NUM];
+    pthread_mutex_t Lock;
+    pthread_cond_t WorkReady;
+    pthread_cond_t WorkDone;
+    unsigned int Generation;
+    int Shutdown;
+    int Running;
+    int Busy;
+    int WorkerNum;
+    VDL_INDEX_T Begin;
+    VDL_INDEX_T End;
+    VDL_INDEX_T Grain;
+    VDL_PARALLEL_FUNCTION_T Function;
+    void *Context;
+    VDL_PARALLEL_RANGE_T Ranges[VDL_THREAD_POOL_MAX_THREAD_NUM];
+} vdl_GlobalVar_ThreadPool = {.Lock      = PTHREAD_MUTEX_INITIALIZER,
+                              .WorkReady = PTHREAD_COND_INITIALIZER,
+                              .WorkDone  = PTHREAD_COND_INITIALIZER};
+
+/// Get the number of threads used by a parallel loop.
+/// @details It is the number of online CPUs by default, which is detected on the first call.
+/// @return (int) Number of threads, including the calling thread.
+static inline int vdl_ThreadPoolThreadNum(void);
+
+/// Set the number of threads used by a parallel loop.
+/// @param thread_num (int). Number of threads, including the calling thread.
+#define vdl_ThreadPoolSetThreadNum(...) vdl_CallVoidFunction(vdl_ThreadPoolSetThreadNum_BT, __VA_ARGS__)
+static inline void vdl_ThreadPoolSetThreadNum_BT(int thread_num);
+
+/// Start worker threads until a loop can use `thread_num` threads. No checks will be performed.
+/// @details The pool keeps fewer threads if a thread fails to start.
+/// @param thread_num (int). Number of threads, including the calling thread.
+static inline void vdl_ThreadPoolUnsafeStart(int thread_num);
+
+/// Stop and join all the worker threads.
+/// @details They will be started again by the next parallel loop that needs them.
+static inline void vdl_ThreadPoolShutdown(void);
+
+/// Wait for parallel loops and run them until the pool is shut down.
+/// @param arg (void *). Worker id stored as an intptr_t.
+/// @return (void *) NULL.
+static inline void *vdl_ThreadPoolWorker(void *arg);
+
+/// Run the chunks of the current loop until no chunk is left in any range. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param id (int). Worker id.
+static inline void vdl_ParallelUnsafeRunWorker(int id);
+
+/// Run a function on the chunks of a range of items with the thread pool.
+/// @details The range is split into chunks of `grain` items, which are dealt to the workers in
+/// contiguous ranges. A worker that runs out of chunks steals the back half of the range of
+/// another worker. Loops shorter than `VDL_PARALLEL_MIN_LENGTH` items, loops of one chunk and
+/// loops started inside another loop are run by the calling thread as a single chunk. The
+/// function returns after all the chunks are run.
+/// @param begin (VDL_INDEX_T). Index of the first item.
+/// @param end (VDL_INDEX_T). Index after the last item.
+/// @param grain (VDL_INDEX_T). Number of items of a chunk. Values less than 1 are treated as 1.
+/// @param fn (VDL_PARALLEL_FUNCTION_T). A function.
+/// @param context (void *). Context passed to the function.
+static inline void vdl_ParallelFor(VDL_INDEX_T begin, VDL_INDEX_T end, VDL_INDEX_T grain, VDL_PARALLEL_FUNCTION_T fn, void *context);
+
+/// Run a number of tasks with the thread pool.
+/// @details Task `i` is run as the chunk `[i, i + 1)`, so the tasks are spread over the workers
+/// even if there are fewer tasks than `VDL_PARALLEL_MIN_LENGTH`. A task that has not started when
+/// another worker runs out of tasks is stolen by that worker. With one thread or inside another
+/// loop, the calling thread runs the function once on `[0, task_num)`.
+/// @param task_num (int). Number of tasks.
+/// @param fn (VDL_PARALLEL_FUNCTION_T). A function.
+/// @param context (void *). Context passed to the function.
+static inline void vdl_ParallelRun(int task_num, VDL_PARALLEL_FUNCTION_T fn, void *context);
+
+/// Split a range of items into chunks and run them with the thread pool. No checks will be performed.
+/// @details The range must not be empty.
+/// @param begin (VDL_INDEX_T). Index of the first item.
+/// @param end (VDL_INDEX_T). Index after the last item.
+/// @param chunk_length (VDL_INDEX_T). Number of items of a chunk. It must be positive.
+/// @param fn (VDL_PARALLEL_FUNCTION_T). A function.
+/// @param context (void *). Context passed to the function.
+static inline void vdl_ParallelUnsafeDispatch(VDL_INDEX_T begin, VDL_INDEX_T end, VDL_INDEX_T chunk_length, VDL_PARALLEL_FUNCTION_T fn, void *context);
 
 #endif//VDL_VDL_1_UTILITIES_H
@@ -48,4 +48,292 @@ static inline int vdl_CompareAddress(const void *a, const void *b)
     return 0;
 }
 
+static inline size_t vdl_HashAddress(const void *const p)
+{
+    uint64_t h = (uint64_t) (uintptr_t) p;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t) h;
+}
+
+static inline size_t vdl_AddressAlignment(const void *const p)
+{
+    const uintptr_t address = (uintptr_t) p;
+    return (size_t) (address & (~address + 1));
+}
+
+static inline double vdl_TimeInMicroseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e6 + (double) ts.tv_nsec / 1e3;
+}
+
+static inline VDL_SIMD_T vdl_SimdDetect(void)
+{
+#ifdef VDL_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return VDL_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return VDL_SIMD_AVX2;
+
+    // SSE2 is part of x86-64
+    return VDL_SIMD_SSE2;
+#else
+    return VDL_SIMD_NONE;
+#endif//VDL_SIMD_X86
+}
+
+static inline VDL_SIMD_T vdl_SimdLevel(void)
+{
+    if (vdl_GlobalVar_SimdLevel < 0)
+        vdl_GlobalVar_SimdLevel = (int) vdl_SimdDetect();
+    return (VDL_SIMD_T) vdl_GlobalVar_SimdLevel;
+}
+
+static inline void vdl_SimdSetLevel(const VDL_SIMD_T level)
+{
+    const VDL_SIMD_T supported = vdl_SimdDetect();
+    vdl_GlobalVar_SimdLevel    = (int) (level < supported ? level : supported);
+}
+
+static inline int vdl_ThreadPoolThreadNum(void)
+{
+    if (vdl_GlobalVar_ThreadPool.ThreadNum == 0)
+    {
+        const long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpu_num < 1)
+            vdl_GlobalVar_ThreadPool.ThreadNum = 1;
+        else if (cpu_num > VDL_THREAD_POOL_MAX_THREAD_NUM)
+            vdl_GlobalVar_ThreadPool.ThreadNum = VDL_THREAD_POOL_MAX_THREAD_NUM;
+        else
+            vdl_GlobalVar_ThreadPool.ThreadNum = (int) cpu_num;
+    }
+    return vdl_GlobalVar_ThreadPool.ThreadNum;
+}
+
+static inline void vdl_ThreadPoolSetThreadNum_BT(const int thread_num)
+{
+    vdl_Expect(thread_num > 0 && thread_num <= VDL_THREAD_POOL_MAX_THREAD_NUM,
+               VDL_EXCEPTION_INVALID_THREAD_NUMBER,
+               "The requested number of threads [%d] is not in (0, %d]!",
+               thread_num,
+               VDL_THREAD_POOL_MAX_THREAD_NUM);
+
+    vdl_GlobalVar_ThreadPool.ThreadNum = thread_num;
+}
+
+static inline void vdl_ThreadPoolUnsafeStart(const int thread_num)
+{
+    const int was_empty = vdl_GlobalVar_ThreadPool.StartedNum == 0;
+    if (was_empty)
+    {
+        for (int id = 0; id < VDL_THREAD_POOL_MAX_THREAD_NUM; id++)
+            pthread_mutex_init(&vdl_GlobalVar_ThreadPool.Ranges[id].Lock, NULL);
+    }
+
+    // A new thread waits for the loops after the current one
+    while (vdl_GlobalVar_ThreadPool.StartedNum + 1 < thread_num)
+    {
+        const int id                             = vdl_GlobalVar_ThreadPool.StartedNum + 1;
+        vdl_GlobalVar_ThreadPool.Generations[id] = vdl_GlobalVar_ThreadPool.Generation;
+        if (pthread_create(&vdl_GlobalVar_ThreadPool.Threads[id], NULL, vdl_ThreadPoolWorker, (void *) (intptr_t) id) != 0)
+            break;
+        vdl_GlobalVar_ThreadPool.StartedNum = id;
+    }
+
+    if (was_empty && vdl_GlobalVar_ThreadPool.StartedNum == 0)
+    {
+        for (int id = 0; id < VDL_THREAD_POOL_MAX_THREAD_NUM; id++)
+            pthread_mutex_destroy(&vdl_GlobalVar_ThreadPool.Ranges[id].Lock);
+    }
+}
+
+static inline void vdl_ThreadPoolShutdown(void)
+{
+    if (vdl_GlobalVar_ThreadPool.StartedNum == 0)
+        return;
+
+    pthread_mutex_lock(&vdl_GlobalVar_ThreadPool.Lock);
+    vdl_GlobalVar_ThreadPool.Shutdown = 1;
+    pthread_cond_broadcast(&vdl_GlobalVar_ThreadPool.WorkReady);
+    pthread_mutex_unlock(&vdl_GlobalVar_ThreadPool.Lock);
+
+    for (int id = 1; id <= vdl_GlobalVar_ThreadPool.StartedNum; id++)
+        pthread_join(vdl_GlobalVar_ThreadPool.Threads[id], NULL);
+
+    for (int id = 0; id < VDL_THREAD_POOL_MAX_THREAD_NUM; id++)
+        pthread_mutex_destroy(&vdl_GlobalVar_ThreadPool.Ranges[id].Lock);
+
+    vdl_GlobalVar_ThreadPool.StartedNum = 0;
+    vdl_GlobalVar_ThreadPool.Shutdown   = 0;
+}
+
+static inline void *vdl_ThreadPoolWorker(void *const arg)
+{
+    const int id = (int) (intptr_t) arg;
+
+    pthread_mutex_lock(&vdl_GlobalVar_ThreadPool.Lock);
+    while (1)
+    {
+        while (!vdl_GlobalVar_ThreadPool.Shutdown &&
+               vdl_GlobalVar_ThreadPool.Generations[id] == vdl_GlobalVar_ThreadPool.Generation)
+            pthread_cond_wait(&vdl_GlobalVar_ThreadPool.WorkReady, &vdl_GlobalVar_ThreadPool.Lock);
+
+        if (vdl_GlobalVar_ThreadPool.Shutdown)
+            break;
+        vdl_GlobalVar_ThreadPool.Generations[id] = vdl_GlobalVar_ThreadPool.Generation;
+
+        // Threads beyond the workers of the loop go back to sleep
+        if (id >= vdl_GlobalVar_ThreadPool.WorkerNum)
+            continue;
+
+        pthread_mutex_unlock(&vdl_GlobalVar_ThreadPool.Lock);
+        vdl_ParallelUnsafeRunWorker(id);
+        pthread_mutex_lock(&vdl_GlobalVar_ThreadPool.Lock);
+
+        vdl_GlobalVar_ThreadPool.Busy--;
+        if (vdl_GlobalVar_ThreadPool.Busy == 0)
+            pthread_cond_signal(&vdl_GlobalVar_ThreadPool.WorkDone);
+    }
+    pthread_mutex_unlock(&vdl_GlobalVar_ThreadPool.Lock);
+
+    return NULL;
+}
+
+static inline void vdl_ParallelUnsafeRunWorker(const int id)
+{
+    const int worker_num            = vdl_GlobalVar_ThreadPool.WorkerNum;
+    const VDL_INDEX_T begin         = vdl_GlobalVar_ThreadPool.Begin;
+    const VDL_INDEX_T end           = vdl_GlobalVar_ThreadPool.End;
+    const VDL_INDEX_T grain         = vdl_GlobalVar_ThreadPool.Grain;
+    VDL_PARALLEL_RANGE_T *const own = &vdl_GlobalVar_ThreadPool.Ranges[id];
+
+    while (1)
+    {
+        VDL_INDEX_T chunk = -1;
+
+        pthread_mutex_lock(&own->Lock);
+        if (own->Next < own->End)
+        {
+            chunk = own->Next;
+            own->Next++;
+        }
+        pthread_mutex_unlock(&own->Lock);
+
+        // Steal the back half of the range of another worker if the own range is empty
+        for (int k = 1; chunk < 0 && k < worker_num; k++)
+        {
+            VDL_PARALLEL_RANGE_T *const victim = &vdl_GlobalVar_ThreadPool.Ranges[(id + k) % worker_num];
+            VDL_INDEX_T stolen                 = 0;
+
+            pthread_mutex_lock(&victim->Lock);
+            if (victim->End > victim->Next)
+            {
+                stolen = (victim->End - victim->Next + 1) / 2;
+                victim->End -= stolen;
+                chunk = victim->End;
+            }
+            pthread_mutex_unlock(&victim->Lock);
+
+            if (stolen > 1)
+            {
+                pthread_mutex_lock(&own->Lock);
+                own->Next = chunk + 1;
+                own->End  = chunk + stolen;
+                pthread_mutex_unlock(&own->Lock);
+            }
+        }
+
+        if (chunk < 0)
+            return;
+
+        const VDL_INDEX_T chunk_begin = begin + chunk * grain;
+        const VDL_INDEX_T chunk_end   = end - chunk_begin > grain ? chunk_begin + grain : end;
+        vdl_GlobalVar_ThreadPool.Function(chunk_begin, chunk_end, vdl_GlobalVar_ThreadPool.Context);
+    }
+}
+
+static inline void vdl_ParallelFor(const VDL_INDEX_T begin, const VDL_INDEX_T end, const VDL_INDEX_T grain, const VDL_PARALLEL_FUNCTION_T fn, void *const context)
+{
+    if (end <= begin)
+        return;
+
+    // Short loops are run by the calling thread
+    if (end - begin < VDL_PARALLEL_MIN_LENGTH)
+    {
+        fn(begin, end, context);
+        return;
+    }
+
+    vdl_ParallelUnsafeDispatch(begin, end, grain > 0 ? grain : 1, fn, context);
+}
+
+static inline void vdl_ParallelRun(const int task_num, const VDL_PARALLEL_FUNCTION_T fn, void *const context)
+{
+    if (task_num <= 0)
+        return;
+
+    vdl_ParallelUnsafeDispatch(0, task_num, 1, fn, context);
+}
+
+static inline void vdl_ParallelUnsafeDispatch(const VDL_INDEX_T begin, const VDL_INDEX_T end, const VDL_INDEX_T chunk_length, const VDL_PARALLEL_FUNCTION_T fn, void *const context)
+{
+    const VDL_INDEX_T chunk_num = (end - begin - 1) / chunk_length + 1;
+    const int thread_num        = vdl_ThreadPoolThreadNum();
+
+    // Loops of one chunk and nested loops are run by the calling thread
+    if (chunk_num == 1 || thread_num == 1 || vdl_GlobalVar_ThreadPool.Running)
+    {
+        fn(begin, end, context);
+        return;
+    }
+
+    vdl_ThreadPoolUnsafeStart(thread_num);
+
+    int worker_num = vdl_GlobalVar_ThreadPool.StartedNum + 1;
+    if (worker_num > thread_num)
+        worker_num = thread_num;
+    if (worker_num > chunk_num)
+        worker_num = (int) chunk_num;
+    if (worker_num == 1)
+    {
+        fn(begin, end, context);
+        return;
+    }
+
+    // Deal the chunks to the workers in contiguous ranges
+    for (int id = 0; id < worker_num; id++)
+    {
+        vdl_GlobalVar_ThreadPool.Ranges[id].Next = (VDL_INDEX_T) ((long long) chunk_num * id / worker_num);
+        vdl_GlobalVar_ThreadPool.Ranges[id].End  = (VDL_INDEX_T) ((long long) chunk_num * (id + 1) / worker_num);
+    }
+
+    // The instruction set is detected before the workers read it
+    (void) vdl_SimdLevel();
+
+    pthread_mutex_lock(&vdl_GlobalVar_ThreadPool.Lock);
+    vdl_GlobalVar_ThreadPool.Running   = 1;
+    vdl_GlobalVar_ThreadPool.Busy      = worker_num - 1;
+    vdl_GlobalVar_ThreadPool.WorkerNum = worker_num;
+    vdl_GlobalVar_ThreadPool.Begin     = begin;
+    vdl_GlobalVar_ThreadPool.End       = end;
+    vdl_GlobalVar_ThreadPool.Grain     = chunk_length;
+    vdl_GlobalVar_ThreadPool.Function  = fn;
+    vdl_GlobalVar_ThreadPool.Context   = context;
+    vdl_GlobalVar_ThreadPool.Generation++;
+    pthread_cond_broadcast(&vdl_GlobalVar_ThreadPool.WorkReady);
+    pthread_mutex_unlock(&vdl_GlobalVar_ThreadPool.Lock);
+
+    vdl_ParallelUnsafeRunWorker(0);
+
+    pthread_mutex_lock(&vdl_GlobalVar_ThreadPool.Lock);
+    while (vdl_GlobalVar_ThreadPool.Busy > 0)
+        pthread_cond_wait(&vdl_GlobalVar_ThreadPool.WorkDone, &vdl_GlobalVar_ThreadPool.Lock);
+    vdl_GlobalVar_ThreadPool.Running = 0;
+    pthread_mutex_unlock(&vdl_GlobalVar_ThreadPool.Lock);
+}
+
 #endif//VDL_VDL_1_UTILITIES_DEF_H
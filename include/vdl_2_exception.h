@@ -44,6 +44,11 @@
 #define VDL_EXCEPTION_ATTRIBUTE_NOT_FOUND 0x13
 #define VDL_EXCEPTION_MISSING_VALUE 0x14
 #define VDL_EXCEPTION_NEGATIVE_INDEX 0x15
+#define VDL_EXCEPTION_INVALID_THREAD_NUMBER 0x16
+#define VDL_EXCEPTION_INVALID_ARENA_STATE 0x17
+#define VDL_EXCEPTION_FAILED_FILE_MAPPING 0x18
+#define VDL_EXCEPTION_READ_ONLY_VECTOR 0x19
+#define VDL_EXCEPTION_INVALID_SLICE 0x1a
 
 /*-----------------------------------------------------------------------------
  |  Error message
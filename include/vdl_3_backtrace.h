@@ -96,23 +96,36 @@ _Noreturn static void vdl_BacktraceNoCatchHandler(void);
  ----------------------------------------------------------------------------*/
 
 // If the backtrace is enabled, properly define the try catch statement.
+// The hooks are also kept under their own names, so later modules can chain them.
 #ifndef VDL_BACKTRACE_DISABLE
     // The backtrace frame count needs to be saved before a try and restore after a try
     // such that a long jump will not cause the frame count to be incorrect.
-    #ifdef VDL_EXCEPTION_HOOK_START_TRY
-        #undef VDL_EXCEPTION_HOOK_START_TRY
-    #endif//VDL_EXCEPTION_HOOK_START_TRY
-    #define VDL_EXCEPTION_HOOK_START_TRY                                            \
+    #define VDL_BACKTRACE_HOOK_START_TRY                                            \
         do {                                                                        \
             vdl_GlobalVar_FrameCountBeforeTry = vdl_GlobalVar_Backtrace.FrameCount; \
         } while (0)
 
+    #define VDL_BACKTRACE_HOOK_AFTER_TRY                                            \
+        do {                                                                        \
+            vdl_GlobalVar_Backtrace.FrameCount = vdl_GlobalVar_FrameCountBeforeTry; \
+        } while (0)
+
+    #ifdef VDL_EXCEPTION_HOOK_START_TRY
+        #undef VDL_EXCEPTION_HOOK_START_TRY
+    #endif//VDL_EXCEPTION_HOOK_START_TRY
+    #define VDL_EXCEPTION_HOOK_START_TRY VDL_BACKTRACE_HOOK_START_TRY
+
     #ifdef VDL_EXCEPTION_HOOK_AFTER_TRY
         #undef VDL_EXCEPTION_HOOK_AFTER_TRY
     #endif//VDL_EXCEPTION_HOOK_AFTER_TRY
-    #define VDL_EXCEPTION_HOOK_AFTER_TRY                                            \
-        do {                                                                        \
-            vdl_GlobalVar_Backtrace.FrameCount = vdl_GlobalVar_FrameCountBeforeTry; \
+    #define VDL_EXCEPTION_HOOK_AFTER_TRY VDL_BACKTRACE_HOOK_AFTER_TRY
+#else
+    #define VDL_BACKTRACE_HOOK_START_TRY \
+        do {                             \
+        } while (0)
+
+    #define VDL_BACKTRACE_HOOK_AFTER_TRY \
+        do {                             \
         } while (0)
 #endif//VDL_BACKTRACE_DISABLE
 
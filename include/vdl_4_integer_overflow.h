@@ -52,21 +52,62 @@ static inline int vdl_MulIntOverflow_BT(int x, int y);
 /// @param x (long). A long.
 /// @param y (long). Another long.
 /// @param (long) A long.
-#define vdl_AddLongOverflow(...) vdl_CallFunction(vdl_AddLongOverflow_BT, int, __VA_ARGS__)
+#define vdl_AddLongOverflow(...) vdl_CallFunction(vdl_AddLongOverflow_BT, long, __VA_ARGS__)
 static inline long vdl_AddLongOverflow_BT(long x, long y);
 
 /// Safely subtract two long integers. Integer overflow will cause an exception.
 /// @param x (long). A long.
 /// @param y (long). Another long.
 /// @param (long) A long.
-#define vdl_SubLongOverflow(...) vdl_CallFunction(vdl_SubLongOverflow_BT, int, __VA_ARGS__)
+#define vdl_SubLongOverflow(...) vdl_CallFunction(vdl_SubLongOverflow_BT, long, __VA_ARGS__)
 static inline long vdl_SubLongOverflow_BT(long x, long y);
 
 /// Safely multiply two long integers. Integer overflow will cause an exception.
 /// @param x (long). A long.
 /// @param y (long). Another long.
 /// @param (long) A long.
-#define vdl_MulLongOverflow(...) vdl_CallFunction(vdl_MulLongOverflow_BT, int, __VA_ARGS__)
+#define vdl_MulLongOverflow(...) vdl_CallFunction(vdl_MulLongOverflow_BT, long, __VA_ARGS__)
 static inline long vdl_MulLongOverflow_BT(long x, long y);
 
+/*-----------------------------------------------------------------------------
+ |  Integer overflow handle (index)
+ ----------------------------------------------------------------------------*/
+
+#ifdef VDL_64BIT_SIZE
+vdl_CompileTimeAssert(sizeof(long) >= 8, integer_overflow);
+#endif
+
+/// Safely add two indices. Integer overflow will cause an exception.
+/// @details It checks int overflow by default, and long overflow if `VDL_64BIT_SIZE` is defined.
+/// @param x (VDL_INDEX_T). An index.
+/// @param y (VDL_INDEX_T). Another index.
+/// @param (VDL_INDEX_T) An index.
+#ifdef VDL_64BIT_SIZE
+#define vdl_AddIndexOverflow(...) vdl_AddLongOverflow(__VA_ARGS__)
+#else
+#define vdl_AddIndexOverflow(...) vdl_AddIntOverflow(__VA_ARGS__)
+#endif
+
+/// Safely subtract two indices. Integer overflow will cause an exception.
+/// @details It checks int overflow by default, and long overflow if `VDL_64BIT_SIZE` is defined.
+/// @param x (VDL_INDEX_T). An index.
+/// @param y (VDL_INDEX_T). Another index.
+/// @param (VDL_INDEX_T) An index.
+#ifdef VDL_64BIT_SIZE
+#define vdl_SubIndexOverflow(...) vdl_SubLongOverflow(__VA_ARGS__)
+#else
+#define vdl_SubIndexOverflow(...) vdl_SubIntOverflow(__VA_ARGS__)
+#endif
+
+/// Safely multiply two indices. Integer overflow will cause an exception.
+/// @details It checks int overflow by default, and long overflow if `VDL_64BIT_SIZE` is defined.
+/// @param x (VDL_INDEX_T). An index.
+/// @param y (VDL_INDEX_T). Another index.
+/// @param (VDL_INDEX_T) An index.
+#ifdef VDL_64BIT_SIZE
+#define vdl_MulIndexOverflow(...) vdl_MulLongOverflow(__VA_ARGS__)
+#else
+#define vdl_MulIndexOverflow(...) vdl_MulIntOverflow(__VA_ARGS__)
+#endif
+
 #endif//VDL_VDL_4_INTEGER_OVERFLOW_H
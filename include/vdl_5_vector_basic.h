@@ -19,21 +19,27 @@
 /// VDL_TYPE_CHAR: 0, character type (could be signed or unsigned, this is implementation defined). \n\n
 /// VDL_TYPE_INT: 1, signed integer type. \n\n
 /// VDL_TYPE_DOUBLE: 2, signed double type. \n\n
-/// VDL_TYPE_VECTOR: 3, vector type.
+/// VDL_TYPE_VECTOR: 3, vector type. \n\n
+/// VDL_TYPE_INDEX: 4, index type (VDL_INDEX_T).
 typedef enum VDL_TYPE_T
 {
     VDL_TYPE_CHAR           = 0,
     VDL_TYPE_INT            = 1,
     VDL_TYPE_DOUBLE         = 2,
-    VDL_TYPE_VECTOR_POINTER = 3
+    VDL_TYPE_VECTOR_POINTER = 3,
+    VDL_TYPE_INDEX          = 4
 } VDL_TYPE_T;
 
+/// Number of primitive vector types.
+#define VDL_TYPE_NUM 5
+
 /// String representation of primitive array types.
-static const char *const VDL_TYPE_STRING[4] = {
+static const char *const VDL_TYPE_STRING[VDL_TYPE_NUM] = {
         [VDL_TYPE_CHAR]           = "VDL_TYPE_CHAR",
         [VDL_TYPE_INT]            = "VDL_TYPE_INT",
         [VDL_TYPE_DOUBLE]         = "VDL_TYPE_DOUBLE",
-        [VDL_TYPE_VECTOR_POINTER] = "VDL_TYPE_VECTOR_POINTER"};
+        [VDL_TYPE_VECTOR_POINTER] = "VDL_TYPE_VECTOR_POINTER",
+        [VDL_TYPE_INDEX]          = "VDL_TYPE_INDEX"};
 
 /*-----------------------------------------------------------------------------
  |  Vector storage modes
@@ -42,17 +48,26 @@ static const char *const VDL_TYPE_STRING[4] = {
 /// Storage mode of a vector.
 /// @details
 /// VDL_MODE_STACK: 0, stack allocated. \n\n
-/// VDL_MODE_HEAP: 1, heap allocated.
+/// VDL_MODE_HEAP: 1, heap allocated. \n\n
+/// VDL_MODE_ARENA: 2, arena allocated. \n\n
+/// VDL_MODE_MMAP: 3, data container mapped from a file. \n\n
+/// VDL_MODE_VIEW: 4, data container is a slice of the data container of another vector.
 typedef enum VDL_MODE_T
 {
     VDL_MODE_STACK = 0,
-    VDL_MODE_HEAP  = 1
+    VDL_MODE_HEAP  = 1,
+    VDL_MODE_ARENA = 2,
+    VDL_MODE_MMAP  = 3,
+    VDL_MODE_VIEW  = 4
 } VDL_MODE_T;
 
 /// String representation of storage mode of a vector.
-static const char *const VDL_MODE_STRING[2] = {
+static const char *const VDL_MODE_STRING[5] = {
         [VDL_MODE_STACK] = "VDL_MODE_STACK",
-        [VDL_MODE_HEAP]  = "VDL_MODE_HEAP"};
+        [VDL_MODE_HEAP]  = "VDL_MODE_HEAP",
+        [VDL_MODE_ARENA] = "VDL_MODE_ARENA",
+        [VDL_MODE_MMAP]  = "VDL_MODE_MMAP",
+        [VDL_MODE_VIEW]  = "VDL_MODE_VIEW"};
 
 
 /*-----------------------------------------------------------------------------
@@ -60,9 +75,52 @@ static const char *const VDL_MODE_STRING[2] = {
  ----------------------------------------------------------------------------*/
 
 /// Class is stored as an int.
+/// @details
+/// VDL_CLASS_VECTOR: 0, an ordinary vector. \n\n
+/// VDL_CLASS_EXPRESSION: 1, an expression node of a lazy operation, which is a vector pointer vector of its operands.
 #define VDL_CLASS_T int
 
 #define VDL_CLASS_VECTOR 0
+#define VDL_CLASS_EXPRESSION 1
+
+/*-----------------------------------------------------------------------------
+ |  Vector flags
+ ----------------------------------------------------------------------------*/
+
+/// Flags are stored as an unsigned int.
+/// @details
+/// VDL_FLAG_OLD: 1, the vector belongs to the old generation. \n\n
+/// VDL_FLAG_REMEMBERED: 2, the vector is in the remembered set. \n\n
+/// VDL_FLAG_INLINE: 4, the data container is allocated together with the vector struct. \n\n
+/// VDL_FLAG_READ_ONLY: 8, the data container can not be modified. \n\n
+/// VDL_FLAG_ATTRIBUTE: 16, the vector is an attribute of another vector. \n\n
+/// The bits from VDL_FLAG_ARENA_DEPTH_SHIFT store the depth of the arena that owns an arena vector.
+#define VDL_FLAG_T unsigned int
+
+#define VDL_FLAG_OLD 1u
+#define VDL_FLAG_REMEMBERED 2u
+#define VDL_FLAG_INLINE 4u
+#define VDL_FLAG_READ_ONLY 8u
+#define VDL_FLAG_ATTRIBUTE 16u
+#define VDL_FLAG_ARENA_DEPTH_SHIFT 8u
+
+/*-----------------------------------------------------------------------------
+ |  Shared data buffers
+ ----------------------------------------------------------------------------*/
+
+/// A data buffer shared by several vectors.
+/// @details The buffer is released when the last vector referencing it is freed.
+/// @param RefCount (size_t). Number of vectors referencing the buffer.
+/// @param Address (void*). Start of the buffer.
+/// @param Length (size_t). Length of the file mapping in bytes, or 0 if the buffer is heap allocated.
+/// @param ReadOnly (int). Whether the buffer is a read-only file mapping, which is never written in place.
+typedef struct VDL_SHARED_BUFFER_T
+{
+    size_t RefCount;
+    void *Address;
+    size_t Length;
+    int ReadOnly;
+} VDL_SHARED_BUFFER_T;
 
 /*-----------------------------------------------------------------------------
  |  Vector definition
@@ -77,22 +135,50 @@ typedef VDL_VECTOR_T *VDL_VECTOR_P;
 /// Vector struct.
 /// @param Type (const VDL_TYPE). Type of the vector.
 /// @param Mode (const VDL_MODE). Storage mode of the vector.
-/// @param Capacity (int). Capacity of the vector.
-/// @param Length (int). Length of the vector.
+/// @param Class (const VDL_CLASS_T). Class of the vector.
+/// @param Capacity (VDL_INDEX_T). Capacity of the vector.
+/// @param Length (VDL_INDEX_T). Length of the vector.
+/// @param Mark (unsigned int). Epoch of the last garbage collection that reached the vector.
+/// @param Flag (VDL_FLAG_T). Flags used by the memory manager.
+/// @param Attribute (VDL_VECTOR_P). Attribute of the vector.
 /// @param Data (void*). Data pointer.
+/// @param Buffer (VDL_SHARED_BUFFER_T*). Shared data buffer, or NULL if the data container is owned by the vector.
 struct VDL_VECTOR_T
 {
     const VDL_TYPE_T Type;
     const VDL_MODE_T Mode;
     const VDL_CLASS_T Class;
-    int Capacity;
-    int Length;
+    VDL_INDEX_T Capacity;
+    VDL_INDEX_T Length;
+    unsigned int Mark;
+    VDL_FLAG_T Flag;
     VDL_VECTOR_P Attribute;
     void *Data;
+    VDL_SHARED_BUFFER_T *Buffer;
 };
 
 
+/// Maximum capacity of a vector.
+/// @details In 64-bit size mode, it is bounded so the size of the data in bytes fits in a size_t.
+#ifdef VDL_64BIT_SIZE
+#define VDL_VECTOR_MAX_CAPACITY ((VDL_INDEX_T) 1 << 48)
+#else
 #define VDL_VECTOR_MAX_CAPACITY (INT_MAX - 512)
+#endif
+
+/// Maximum size of a data container that is stored inline after the vector struct.
+/// @details Small vectors are allocated in one block, so accessing the data does not
+/// need to follow a pointer to another block. The data spills to a separate block
+/// when the vector grows beyond this size.
+#define VDL_VECTOR_INLINE_DATA_SIZE ((size_t) 128)
+
+/// Alignment of the data containers of heap and arena vectors.
+/// @details The default is a cache line, which also covers the widest SIMD registers.
+#ifndef VDL_DATA_ALIGNMENT
+#define VDL_DATA_ALIGNMENT ((size_t) 64)
+#endif
+
+vdl_CompileTimeAssert(VDL_DATA_ALIGNMENT >= 16 && (VDL_DATA_ALIGNMENT & (VDL_DATA_ALIGNMENT - 1)) == 0, vector_basic);
 
 /*-----------------------------------------------------------------------------
  |  Missing values
@@ -106,6 +192,8 @@ struct VDL_VECTOR_T
 #define VDL_DOUBLE_NA ((double) NAN)
 /// Missing value of pointer.
 #define VDL_VECTOR_POINTER_NA NULL
+/// Missing value of index.
+#define VDL_INDEX_NA VDL_INDEX_MAX
 
 /*-----------------------------------------------------------------------------
  |  Different array types
@@ -123,16 +211,20 @@ struct VDL_VECTOR_T
 #define VDL_VECTOR_POINTER_ARRAY VDL_VECTOR_T **const
 #define VDL_VECTOR_CONST_POINTER_ARRAY VDL_VECTOR_T *const *const
 
+#define VDL_INDEX_ARRAY VDL_INDEX_T *const
+#define VDL_CONST_INDEX_ARRAY const VDL_INDEX_T *const
+
 /*-----------------------------------------------------------------------------
  |  Size of vector type
  ----------------------------------------------------------------------------*/
 
 /// Size of vector type.
-static const size_t VDL_TYPE_SIZE[4] = {
+static const size_t VDL_TYPE_SIZE[VDL_TYPE_NUM] = {
         [VDL_TYPE_CHAR]           = sizeof(char),
         [VDL_TYPE_INT]            = sizeof(int),
         [VDL_TYPE_DOUBLE]         = sizeof(double),
-        [VDL_TYPE_VECTOR_POINTER] = sizeof(VDL_VECTOR_P)};
+        [VDL_TYPE_VECTOR_POINTER] = sizeof(VDL_VECTOR_P),
+        [VDL_TYPE_INDEX]          = sizeof(VDL_INDEX_T)};
 
 /*-----------------------------------------------------------------------------
  |  Size of a vector
@@ -148,6 +240,14 @@ static const size_t VDL_TYPE_SIZE[4] = {
 /// @return (size_t). The size.
 #define vdl_vector_primitive_SizeOfVector(v) ((size_t) (v)->Capacity * VDL_TYPE_SIZE[(v)->Type] + sizeof(VDL_VECTOR_T))
 
+/// Get the alignment of the data container of a vector.
+/// @details Heap and arena vectors are aligned to at least `VDL_DATA_ALIGNMENT`.
+/// Stack vectors only have the alignment of their type, so kernels should query it
+/// before choosing aligned loads.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (size_t) The largest power of two that divides the data address.
+#define vdl_vector_primitive_DataAlignment(v) vdl_AddressAlignment((v)->Data)
+
 /*-----------------------------------------------------------------------------
  |  Vector basic checks
  ----------------------------------------------------------------------------*/
@@ -162,10 +262,10 @@ static const size_t VDL_TYPE_SIZE[4] = {
                                                 "Memory allocation of [%s] failed!", \
                                                 #p)
 
-#define vdl_CheckIndexOutOfBound(v, i) vdl_Expect((i) >= 0 && (i) < (v)->Length,                    \
-                                                  VDL_EXCEPTION_INDEX_OUT_OF_BOUND,                 \
-                                                  "Index out of bound! Index [%d] not in [0, %d)!", \
-                                                  i,                                                \
+#define vdl_CheckIndexOutOfBound(v, i) vdl_Expect((i) >= 0 && (i) < (v)->Length,                                                        \
+                                                  VDL_EXCEPTION_INDEX_OUT_OF_BOUND,                                                     \
+                                                  "Index out of bound! Index [" VDL_INDEX_FORMAT "] not in [0, " VDL_INDEX_FORMAT ")!", \
+                                                  (VDL_INDEX_T) (i),                                                                    \
                                                   (v)->Length)
 
 #define vdl_CheckType(input_type, expected_type) vdl_Expect((input_type) == (expected_type),                                    \
@@ -174,9 +274,9 @@ static const size_t VDL_TYPE_SIZE[4] = {
                                                             VDL_TYPE_STRING[input_type],                                        \
                                                             VDL_TYPE_STRING[expected_type])
 
-#define vdl_CheckUnknownType(input_type) vdl_Expect((input_type) >= VDL_TYPE_INT && (input_type) <= VDL_TYPE_VECTOR_POINTER, \
-                                                    VDL_EXCEPTION_UNKNOWN_TYPE,                                              \
-                                                    "Unknown vector type [%d] provided!",                                    \
+#define vdl_CheckUnknownType(input_type) vdl_Expect((input_type) >= VDL_TYPE_INT && (input_type) <= VDL_TYPE_INDEX, \
+                                                    VDL_EXCEPTION_UNKNOWN_TYPE,                                     \
+                                                    "Unknown vector type [%d] provided!",                           \
                                                     input_type)
 
 #define vdl_CheckMode(input_mode, expected_mode) vdl_Expect((input_mode) == (expected_mode),                                    \
@@ -185,29 +285,29 @@ static const size_t VDL_TYPE_SIZE[4] = {
                                                             VDL_MODE_STRING[input_mode],                                        \
                                                             VDL_MODE_STRING[expected_mode])
 
-#define vdl_CheckLength(input_length, expected_length) vdl_Expect((input_length) == (expected_length),                                    \
-                                                                  VDL_EXCEPTION_UNEXPECTED_LENGTH,                                        \
-                                                                  "Unexpected vector length [%d] provided! Vector length [%d] Expected!", \
-                                                                  input_length,                                                           \
-                                                                  expected_length)
+#define vdl_CheckLength(input_length, expected_length) vdl_Expect((input_length) == (expected_length),                                                                        \
+                                                                  VDL_EXCEPTION_UNEXPECTED_LENGTH,                                                                            \
+                                                                  "Unexpected vector length [" VDL_INDEX_FORMAT "] provided! Vector length [" VDL_INDEX_FORMAT "] Expected!", \
+                                                                  (VDL_INDEX_T) (input_length),                                                                               \
+                                                                  (VDL_INDEX_T) (expected_length))
 
 
-#define vdl_CheckIncompatibleLength(input_length, expected_length) vdl_Expect((input_length) == (expected_length) || (input_length) == 1,                      \
-                                                                              VDL_EXCEPTION_INCOMPATIBLE_LENGTH,                                               \
-                                                                              "Incompatible vector length [%d] provided! Vector length [%d] or [1] Expected!", \
-                                                                              input_length,                                                                    \
-                                                                              expected_length)
+#define vdl_CheckIncompatibleLength(input_length, expected_length) vdl_Expect((input_length) == (expected_length) || (input_length) == 1,                                                          \
+                                                                              VDL_EXCEPTION_INCOMPATIBLE_LENGTH,                                                                                   \
+                                                                              "Incompatible vector length [" VDL_INDEX_FORMAT "] provided! Vector length [" VDL_INDEX_FORMAT "] or [1] Expected!", \
+                                                                              (VDL_INDEX_T) (input_length),                                                                                        \
+                                                                              (VDL_INDEX_T) (expected_length))
 
-#define vdl_CheckZeroLength(input_length) vdl_Expect((input_length) > 0,                          \
-                                                     VDL_EXCEPTION_NON_POSITIVE_LENGTH,           \
-                                                     "Non-positive vector length [%d] provided!", \
-                                                     input_length)
+#define vdl_CheckZeroLength(input_length) vdl_Expect((input_length) > 0,                                            \
+                                                     VDL_EXCEPTION_NON_POSITIVE_LENGTH,                             \
+                                                     "Non-positive vector length [" VDL_INDEX_FORMAT "] provided!", \
+                                                     (VDL_INDEX_T) (input_length))
 
 
-#define vdl_CheckNumberOfItems(number) vdl_Expect((number) > 0,                                  \
-                                                  VDL_EXCEPTION_NON_POSITIVE_NUMBER_OF_ITEMS,    \
-                                                  "Non-positive number of items [%d] provided!", \
-                                                  number)
+#define vdl_CheckNumberOfItems(number) vdl_Expect((number) > 0,                                                    \
+                                                  VDL_EXCEPTION_NON_POSITIVE_NUMBER_OF_ITEMS,                      \
+                                                  "Non-positive number of items [" VDL_INDEX_FORMAT "] provided!", \
+                                                  (VDL_INDEX_T) (number))
 
 #define vdl_CheckNullVectorAndNullContainer(v) \
     do {                                       \
@@ -215,6 +315,11 @@ static const size_t VDL_TYPE_SIZE[4] = {
         vdl_CheckNullPointer((v)->Data);       \
     } while (0)
 
+#define vdl_CheckWritable(v) vdl_Expect(!((v)->Flag & VDL_FLAG_READ_ONLY), \
+                                        VDL_EXCEPTION_READ_ONLY_VECTOR,    \
+                                        "Read-only vector [%s] provided!", \
+                                        #v)
+
 #define vdl_CheckNullArrayAndNegativeLength(array, number) \
     do {                                                   \
         vdl_CheckNullPointer(array);                       \
@@ -245,6 +350,17 @@ static const size_t VDL_TYPE_SIZE[4] = {
         vdl_CheckType((v)->Type, VDL_TYPE_VECTOR_POINTER); \
     } while (0)
 
+#define vdl_CheckIndexVector(v)                                                                \
+    do {                                                                                       \
+        vdl_CheckNullVectorAndNullContainer(v);                                                \
+        vdl_Expect((v)->Type == VDL_TYPE_INT || (v)->Type == VDL_TYPE_INDEX,                   \
+                   VDL_EXCEPTION_UNEXPECTED_TYPE,                                              \
+                   "Unexpected vector type [%s] provided! Vector type [%s] or [%s] Expected!", \
+                   VDL_TYPE_STRING[(v)->Type],                                                 \
+                   VDL_TYPE_STRING[VDL_TYPE_INT],                                              \
+                   VDL_TYPE_STRING[VDL_TYPE_INDEX]);                                           \
+    } while (0)
+
 #define vdl_CheckCharNA(value) vdl_Expect((value) != VDL_INT_CHAR,     \
                                           VDL_EXCEPTION_MISSING_VALUE, \
                                           "Missing value provided!")
@@ -262,6 +378,10 @@ static const size_t VDL_TYPE_SIZE[4] = {
                                                    VDL_EXCEPTION_MISSING_VALUE,      \
                                                    "Missing value provided!")
 
+#define vdl_CheckIndexNA(value) vdl_Expect((value) != VDL_INDEX_NA,     \
+                                           VDL_EXCEPTION_MISSING_VALUE, \
+                                           "Missing value provided!")
+
 
 /*-----------------------------------------------------------------------------
  |  Accessing the vector data unsafely
@@ -281,6 +401,9 @@ static const size_t VDL_TYPE_SIZE[4] = {
 #define vdl_vector_primitive_UnsafeVectorPointerAt(v, i) (((VDL_VECTOR_POINTER_ARRAY) (v)->Data)[i])
 #define vdl_vector_primitive_UnsafeVectorConstPointerAt(v, i) (((VDL_VECTOR_CONST_POINTER_ARRAY) (v)->Data)[i])
 
+#define vdl_vector_primitive_UnsafeIndexAt(v, i) (((VDL_INDEX_ARRAY) (v)->Data)[i])
+#define vdl_vector_primitive_UnsafeConstIndexAt(v, i) (((VDL_CONST_INDEX_ARRAY) (v)->Data)[i])
+
 #define vdl_vector_primitive_Front(v) ((VDL_CHAR_ARRAY) (v)->Data)
 #define vdl_vector_primitive_Back(v) vdl_vector_primitive_UnsafeAddressOf(v, (v)->Length)
 
@@ -290,38 +413,53 @@ static const size_t VDL_TYPE_SIZE[4] = {
 
 /// Get the address of an item from a vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). Index of the item.
+/// @param i (VDL_INDEX_T). Index of the item.
 /// @return (void *) Pointer to the item.
 #define vdl_vector_primitive_GetAddress(...) vdl_CallFunction(vdl_vector_primitive_GetAddress_BT, void *, __VA_ARGS__)
-static inline void *vdl_vector_primitive_GetAddress_BT(VDL_VECTOR_P v, int i);
+static inline void *vdl_vector_primitive_GetAddress_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
 
 /// Get a char from a vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). Index of the item.
+/// @param i (VDL_INDEX_T). Index of the item.
 /// @return (char) A char.
 #define vdl_vector_primitive_GetChar(...) vdl_CallFunction(vdl_vector_primitive_GetChar_BT, char, __VA_ARGS__)
-static inline char vdl_vector_primitive_GetChar_BT(VDL_VECTOR_P v, int i);
+static inline char vdl_vector_primitive_GetChar_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
 
 /// Get an int from a vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). Index of the item.
+/// @param i (VDL_INDEX_T). Index of the item.
 /// @return (int) An int.
 #define vdl_vector_primitive_GetInt(...) vdl_CallFunction(vdl_vector_primitive_GetInt_BT, int, __VA_ARGS__)
-static inline int vdl_vector_primitive_GetInt_BT(VDL_VECTOR_P v, int i);
+static inline int vdl_vector_primitive_GetInt_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
 
 /// Get a double from a vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). Index of the item.
+/// @param i (VDL_INDEX_T). Index of the item.
 /// @return (double) An double.
 #define vdl_vector_primitive_GetDouble(...) vdl_CallFunction(vdl_vector_primitive_GetDouble_BT, double, __VA_ARGS__)
-static inline double vdl_vector_primitive_GetDouble_BT(VDL_VECTOR_P v, int i);
+static inline double vdl_vector_primitive_GetDouble_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
 
 /// Get a vector pointer from a vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). Index of the item.
+/// @param i (VDL_INDEX_T). Index of the item.
 /// @return (VDL_VECTOR_P) A vector pointer.
 #define vdl_vector_primitive_GetVectorPointer(...) vdl_CallFunction(vdl_vector_primitive_GetVectorPointer_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P v, int i);
+static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
+
+/// Get an index from a vector. Boundary conditions will be checked.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param i (VDL_INDEX_T). Index of the item.
+/// @return (VDL_INDEX_T) An index.
+#define vdl_vector_primitive_GetIndex(...) vdl_CallFunction(vdl_vector_primitive_GetIndex_BT, VDL_INDEX_T, __VA_ARGS__)
+static inline VDL_INDEX_T vdl_vector_primitive_GetIndex_BT(VDL_VECTOR_P v, VDL_INDEX_T i);
+
+/// Get the ith item of an int or an index vector as an index. No checks will be performed.
+/// @details Index vectors and int vectors can both be used to subset a vector. Missing
+/// values of int are converted to missing values of index.
+/// @param v (const VDL_VECTOR_T *). An int vector or an index vector.
+/// @param i (VDL_INDEX_T). Index of the item.
+/// @return (VDL_INDEX_T) An index.
+static inline VDL_INDEX_T vdl_vector_primitive_UnsafeIndexOf(const VDL_VECTOR_T *v, VDL_INDEX_T i);
 
 /*-----------------------------------------------------------------------------
  |  Set the vector data unsafely
@@ -329,7 +467,7 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 
 /// Set the ith item of a char vector. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (char). An item.
 #define vdl_vector_primitive_UnsafeSetChar(v, i, item)  \
     do {                                                \
@@ -338,7 +476,7 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 
 /// Set the ith item of an int vector. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (int). An item.
 #define vdl_vector_primitive_UnsafeSetInt(v, i, item)  \
     do {                                               \
@@ -347,7 +485,7 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 
 /// Set the ith item of a double vector. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (double). An item.
 #define vdl_vector_primitive_UnsafeSetDouble(v, i, item)  \
     do {                                                  \
@@ -356,43 +494,55 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 
 /// Set the ith item of a VDL_VECTOR_P vector. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (VDL_VECTOR_P). An item.
 #define vdl_vector_primitive_UnsafeSetVectorPointer(v, i, item)  \
     do {                                                         \
         vdl_vector_primitive_UnsafeVectorPointerAt(v, i) = item; \
+        vdl_GarbageCollectorWriteBarrier(v);                     \
+    } while (0)
+
+/// Set the ith item of an index vector. No checks will be performed.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param i (VDL_INDEX_T). An index.
+/// @param item (VDL_INDEX_T). An item.
+#define vdl_vector_primitive_UnsafeSetIndex(v, i, item)  \
+    do {                                                 \
+        vdl_vector_primitive_UnsafeIndexAt(v, i) = item; \
     } while (0)
 
 /// Set multiple items of a vector by using `memcpy`. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). The starting index.
+/// @param i (VDL_INDEX_T). The starting index.
 /// @param item_pointer (const void *). A pointer to items.
-/// @param number (int). Number of items to be set.
+/// @param number (VDL_INDEX_T). Number of items to be set.
 #define vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(v, i, item_pointer, number)   \
     do {                                                                             \
         void *_begin = vdl_vector_primitive_UnsafeAddressOf(v, i);                   \
         memmove(_begin, item_pointer, VDL_TYPE_SIZE[(v)->Type] * (size_t) (number)); \
+        vdl_GarbageCollectorWriteBarrier(v);                                         \
     } while (0)
 
 /// Set multiple items of a vector by using `memmove`. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). The starting index.
+/// @param i (VDL_INDEX_T). The starting index.
 /// @param item_pointer (const void *). A pointer to items.
-/// @param number (int). Number of items to be set.
+/// @param number (VDL_INDEX_T). Number of items to be set.
 #define vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i, item_pointer, number)  \
     do {                                                                             \
         void *_begin = vdl_vector_primitive_UnsafeAddressOf(v, i);                   \
         memmove(_begin, item_pointer, VDL_TYPE_SIZE[(v)->Type] * (size_t) (number)); \
+        vdl_GarbageCollectorWriteBarrier(v);                                         \
     } while (0)
 
 /// Set multiple items of a char vector by indices. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const char *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_UnsafeSetCharByArrayAndIndex(v, item_pointer, index_pointer, number) \
     do {                                                                                          \
-        VDL_CONST_INT_ARRAY index_array = index_pointer;                                          \
+        VDL_CONST_INDEX_ARRAY index_array = index_pointer;                                          \
         VDL_CONST_CHAR_ARRAY item_array = item_pointer;                                           \
         VDL_CHAR_ARRAY data_array       = (v)->Data;                                              \
         vdl_for_j(number)                                                                         \
@@ -404,11 +554,11 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 /// Set multiple items of an int vector by indices. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const int *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_UnsafeSetIntByArrayAndIndex(v, item_pointer, index_pointer, number) \
     do {                                                                                         \
-        VDL_CONST_INT_ARRAY index_array = index_pointer;                                         \
+        VDL_CONST_INDEX_ARRAY index_array = index_pointer;                                         \
         VDL_CONST_INT_ARRAY item_array  = item_pointer;                                          \
         VDL_INT_ARRAY data_array        = (v)->Data;                                             \
         vdl_for_j(number)                                                                        \
@@ -420,11 +570,11 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 /// Set multiple items of a double vector by indices. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const double *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_UnsafeSetDoubleByArrayAndIndex(v, item_pointer, index_pointer, number) \
     do {                                                                                            \
-        VDL_CONST_INT_ARRAY index_array   = index_pointer;                                          \
+        VDL_CONST_INDEX_ARRAY index_array   = index_pointer;                                          \
         VDL_CONST_DOUBLE_ARRAY item_array = item_pointer;                                           \
         VDL_DOUBLE_ARRAY data_array       = (v)->Data;                                              \
         vdl_for_j(number)                                                                           \
@@ -436,17 +586,18 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 /// Set multiple items of a VDL_VECTOR_P vector by indices. No checks will be performed.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (VDL_VECTOR_T *const *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_UnsafeSetVectorPointerByArrayAndIndex(v, item_pointer, index_pointer, number) \
     do {                                                                                                   \
-        VDL_CONST_INT_ARRAY index_array           = index_pointer;                                         \
+        VDL_CONST_INDEX_ARRAY index_array           = index_pointer;                                         \
         VDL_VECTOR_CONST_POINTER_ARRAY item_array = item_pointer;                                          \
         VDL_VECTOR_POINTER_ARRAY data_array       = (v)->Data;                                             \
         vdl_for_j(number)                                                                                  \
         {                                                                                                  \
             data_array[index_array[j]] = item_array[j];                                                    \
         }                                                                                                  \
+        vdl_GarbageCollectorWriteBarrier(v);                                                               \
     } while (0)
 
 /*-----------------------------------------------------------------------------
@@ -455,79 +606,86 @@ static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_P
 
 /// Set the ith item of a char vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (char). An item.
 #define vdl_vector_primitive_SetChar(...) vdl_CallVoidFunction(vdl_vector_primitive_SetChar_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetChar_BT(VDL_VECTOR_P v, int i, char item);
+static inline void vdl_vector_primitive_SetChar_BT(VDL_VECTOR_P v, VDL_INDEX_T i, char item);
 
 /// Set the ith item of an int vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (int). An item.
 #define vdl_vector_primitive_SetInt(...) vdl_CallVoidFunction(vdl_vector_primitive_SetInt_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetInt_BT(VDL_VECTOR_P v, int i, int item);
+static inline void vdl_vector_primitive_SetInt_BT(VDL_VECTOR_P v, VDL_INDEX_T i, int item);
 
 /// Set the ith item of a double vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (double). An item.
 #define vdl_vector_primitive_SetDouble(...) vdl_CallVoidFunction(vdl_vector_primitive_SetDouble_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetDouble_BT(VDL_VECTOR_P v, int i, double item);
+static inline void vdl_vector_primitive_SetDouble_BT(VDL_VECTOR_P v, VDL_INDEX_T i, double item);
 
 /// Set the ith item of a VDL_VECTOR_P vector. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). An index.
+/// @param i (VDL_INDEX_T). An index.
 /// @param item (VDL_VECTOR_P). An item.
 #define vdl_vector_primitive_SetVectorPointer(...) vdl_CallVoidFunction(vdl_vector_primitive_SetVectorPointer_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetVectorPointer_BT(VDL_VECTOR_P v, int i, VDL_VECTOR_P item);
+static inline void vdl_vector_primitive_SetVectorPointer_BT(VDL_VECTOR_P v, VDL_INDEX_T i, VDL_VECTOR_P item);
+
+/// Set the ith item of an index vector. Boundary conditions will be checked.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param i (VDL_INDEX_T). An index.
+/// @param item (VDL_INDEX_T). An item.
+#define vdl_vector_primitive_SetIndex(...) vdl_CallVoidFunction(vdl_vector_primitive_SetIndex_BT, __VA_ARGS__)
+static inline void vdl_vector_primitive_SetIndex_BT(VDL_VECTOR_P v, VDL_INDEX_T i, VDL_INDEX_T item);
 
 /// Set many items of a vector by using `memmove`. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). The staring index.
+/// @param i (VDL_INDEX_T). The staring index.
 /// @param item_pointer (const void *). A pointer to items.
-/// @param number (int). Number of items to be set.
+/// @param number (VDL_INDEX_T). Number of items to be set.
 #define vdl_vector_primitive_SetByArrayAndMemmove(...) vdl_CallVoidFunction(vdl_vector_primitive_SetByArrayAndMemmove_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetByArrayAndMemmove_BT(VDL_VECTOR_P v, int i, const void *item_pointer, int number);
+static inline void vdl_vector_primitive_SetByArrayAndMemmove_BT(VDL_VECTOR_P v, VDL_INDEX_T i, const void *item_pointer, VDL_INDEX_T number);
 
 /// Set many items of a vector by using `memcpy`. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param i (int). The staring index.
+/// @param i (VDL_INDEX_T). The staring index.
 /// @param item_pointer (const void *). A pointer to items.
-/// @param number (int). Number of items to be set.
+/// @param number (VDL_INDEX_T). Number of items to be set.
 #define vdl_vector_primitive_SetByArrayAndMemcpy(...) vdl_CallVoidFunction(vdl_vector_primitive_SetByArrayAndMemcpy_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetByArrayAndMemcpy_BT(VDL_VECTOR_P v, int i, const void *item_pointer, int number);
+static inline void vdl_vector_primitive_SetByArrayAndMemcpy_BT(VDL_VECTOR_P v, VDL_INDEX_T i, const void *item_pointer, VDL_INDEX_T number);
 
 /// Set multiple items of a char vector by indices. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const char *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (const int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_SetCharByArrayAndIndex(...) vdl_CallVoidFunction(vdl_vector_primitive_SetCharByArrayAndIndex_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetCharByArrayAndIndex_BT(VDL_VECTOR_P v, const char *item_pointer, const int *index_pointer, int number);
+static inline void vdl_vector_primitive_SetCharByArrayAndIndex_BT(VDL_VECTOR_P v, const char *item_pointer, const VDL_INDEX_T *index_pointer, VDL_INDEX_T number);
 
 /// Set multiple items of an int vector by indices. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const int *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_SetIntByIndices(...) vdl_CallVoidFunction(vdl_vector_primitive_SetIntByArrayAndIndex_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetIntByArrayAndIndex_BT(VDL_VECTOR_P v, const int *item_pointer, const int *index_pointer, int number);
+static inline void vdl_vector_primitive_SetIntByArrayAndIndex_BT(VDL_VECTOR_P v, const int *item_pointer, const VDL_INDEX_T *index_pointer, VDL_INDEX_T number);
 
 /// Set multiple items of a double vector by indices. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (const double *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_SetDoubleByArrayAndIndex(...) vdl_CallVoidFunction(vdl_vector_primitive_SetDoubleByArrayAndIndex_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetDoubleByArrayAndIndex_BT(VDL_VECTOR_P v, const double *item_pointer, const int *index_pointer, int number);
+static inline void vdl_vector_primitive_SetDoubleByArrayAndIndex_BT(VDL_VECTOR_P v, const double *item_pointer, const VDL_INDEX_T *index_pointer, VDL_INDEX_T number);
 
 /// Set multiple items of a VDL_VECTOR_P vector by indices. Boundary conditions will be checked.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item_pointer (VDL_VECTOR_T *const *). A pointer to items.
-/// @param index_pointer (const int *). A pointer to indices.
-/// @param number (int). Number of items.
+/// @param index_pointer (const VDL_INDEX_T *). A pointer to indices.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_SetVectorPointerByArrayAndIndex(...) vdl_CallVoidFunction(vdl_vector_primitive_SetVectorPointerByArrayAndIndex_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_SetVectorPointerByArrayAndIndex_BT(VDL_VECTOR_P v, VDL_VECTOR_T *const *item_pointer, const int *index_pointer, int number);
+static inline void vdl_vector_primitive_SetVectorPointerByArrayAndIndex_BT(VDL_VECTOR_P v, VDL_VECTOR_T *const *item_pointer, const VDL_INDEX_T *index_pointer, VDL_INDEX_T number);
 
 
 /*-----------------------------------------------------------------------------
@@ -9,176 +9,216 @@
  |  Primitive functions to access the vector data safely
  ----------------------------------------------------------------------------*/
 
-static inline void *vdl_vector_primitive_GetAddress_BT(VDL_VECTOR_T *const v, const int i)
+static inline void *vdl_vector_primitive_GetAddress_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
 {
     vdl_CheckNullVectorAndNullContainer(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
     return vdl_vector_primitive_UnsafeAddressOf(v, i);
 }
 
-static inline char vdl_vector_primitive_GetChar_BT(VDL_VECTOR_T *const v, const int i)
+static inline char vdl_vector_primitive_GetChar_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
 {
     vdl_CheckCharVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
     return vdl_vector_primitive_UnsafeConstCharAt(v, i);
 }
 
-static inline int vdl_vector_primitive_GetInt_BT(VDL_VECTOR_T *const v, const int i)
+static inline int vdl_vector_primitive_GetInt_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
 {
     vdl_CheckIntVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
     return vdl_vector_primitive_UnsafeConstIntAt(v, i);
 }
 
-static inline double vdl_vector_primitive_GetDouble_BT(VDL_VECTOR_T *const v, const int i)
+static inline double vdl_vector_primitive_GetDouble_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
 {
     vdl_CheckDoubleVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
     return vdl_vector_primitive_UnsafeConstDoubleAt(v, i);
 }
 
-static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_T *const v, const int i)
+static inline VDL_VECTOR_P vdl_vector_primitive_GetVectorPointer_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
 {
     vdl_CheckVectorPointerVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
     return vdl_vector_primitive_UnsafeVectorConstPointerAt(v, i);
 }
 
+static inline VDL_INDEX_T vdl_vector_primitive_GetIndex_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckType(v->Type, VDL_TYPE_INDEX);
+    vdl_CheckIndexNA(i);
+    vdl_CheckIndexOutOfBound(v, i);
+
+    return vdl_vector_primitive_UnsafeConstIndexAt(v, i);
+}
+
+static inline VDL_INDEX_T vdl_vector_primitive_UnsafeIndexOf(const VDL_VECTOR_T *const v, const VDL_INDEX_T i)
+{
+    if (v->Type == VDL_TYPE_INDEX)
+        return vdl_vector_primitive_UnsafeConstIndexAt(v, i);
+
+    const int index = vdl_vector_primitive_UnsafeConstIntAt(v, i);
+    return index == VDL_INT_NA ? VDL_INDEX_NA : (VDL_INDEX_T) index;
+}
+
 /*-----------------------------------------------------------------------------
  |  Primitive functions to set the vector data safely
  ----------------------------------------------------------------------------*/
 
-static inline void vdl_vector_primitive_SetChar_BT(VDL_VECTOR_T *const v, const int i, const char item)
+static inline void vdl_vector_primitive_SetChar_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const char item)
 {
     vdl_CheckCharVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetChar(v, i, item);
 }
 
-static inline void vdl_vector_primitive_SetInt_BT(VDL_VECTOR_T *const v, const int i, const int item)
+static inline void vdl_vector_primitive_SetInt_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const int item)
 {
     vdl_CheckIntVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetInt(v, i, item);
 }
 
-static inline void vdl_vector_primitive_SetDouble_BT(VDL_VECTOR_T *const v, const int i, const double item)
+static inline void vdl_vector_primitive_SetDouble_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const double item)
 {
     vdl_CheckDoubleVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetDouble(v, i, item);
 }
 
-static inline void vdl_vector_primitive_SetVectorPointer_BT(VDL_VECTOR_T *const v, const int i, VDL_VECTOR_T *const item)
+static inline void vdl_vector_primitive_SetVectorPointer_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, VDL_VECTOR_T *const item)
 {
     vdl_CheckVectorPointerVector(v);
-    vdl_CheckIntNA(i);
+    vdl_CheckIndexNA(i);
     vdl_CheckIndexOutOfBound(v, i);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetVectorPointer(v, i, item);
 }
 
-static inline void vdl_vector_primitive_SetByArrayAndMemcpy_BT(VDL_VECTOR_T *const v, int i, const void *const item_pointer, const int number)
+static inline void vdl_vector_primitive_SetIndex_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const VDL_INDEX_T item)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckType(v->Type, VDL_TYPE_INDEX);
+    vdl_CheckIndexNA(i);
+    vdl_CheckIndexOutOfBound(v, i);
+
+    vdl_vector_primitive_PrepareWrite(v);
+    vdl_vector_primitive_UnsafeSetIndex(v, i, item);
+}
+
+static inline void vdl_vector_primitive_SetByArrayAndMemcpy_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const void *const item_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
-    vdl_CheckIntNA(i);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(i);
+    vdl_CheckIndexNA(number);
     vdl_CheckIndexOutOfBound(v, i);
-    vdl_CheckIndexOutOfBound(v, vdl_AddIntOverflow(i, number) - 1);
+    vdl_CheckIndexOutOfBound(v, vdl_AddIndexOverflow(i, number) - 1);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(v, i, item_pointer, number);
 }
 
-static inline void vdl_vector_primitive_SetByArrayAndMemmove_BT(VDL_VECTOR_T *const v, int i, const void *const item_pointer, const int number)
+static inline void vdl_vector_primitive_SetByArrayAndMemmove_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const void *const item_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
-    vdl_CheckIntNA(i);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(i);
+    vdl_CheckIndexNA(number);
     vdl_CheckIndexOutOfBound(v, i);
-    vdl_CheckIndexOutOfBound(v, vdl_AddIntOverflow(i, number) - 1);
+    vdl_CheckIndexOutOfBound(v, vdl_AddIndexOverflow(i, number) - 1);
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i, item_pointer, number);
 }
 
-static inline void vdl_vector_primitive_SetCharByArrayAndIndex_BT(VDL_VECTOR_T *const v, const char *const item_pointer, const int *const index_pointer, const int number)
+static inline void vdl_vector_primitive_SetCharByArrayAndIndex_BT(VDL_VECTOR_T *const v, const char *const item_pointer, const VDL_INDEX_T *const index_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckCharVector(v);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(number);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
     vdl_CheckNullPointer(index_pointer);
 
     vdl_for_i(number)
     {
-        vdl_CheckIntNA(index_pointer[i]);
+        vdl_CheckIndexNA(index_pointer[i]);
         vdl_CheckIndexOutOfBound(v, index_pointer[i]);
     }
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetCharByArrayAndIndex(v, item_pointer, index_pointer, number);
 }
 
-static inline void vdl_vector_primitive_SetIntByArrayAndIndex_BT(VDL_VECTOR_T *const v, const int *item_pointer, const int *const index_pointer, const int number)
+static inline void vdl_vector_primitive_SetIntByArrayAndIndex_BT(VDL_VECTOR_T *const v, const int *item_pointer, const VDL_INDEX_T *const index_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckIntVector(v);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(number);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
     vdl_CheckNullPointer(index_pointer);
 
     vdl_for_i(number)
     {
-        vdl_CheckIntNA(index_pointer[i]);
+        vdl_CheckIndexNA(index_pointer[i]);
         vdl_CheckIndexOutOfBound(v, index_pointer[i]);
     }
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetIntByArrayAndIndex(v, item_pointer, index_pointer, number);
 }
 
-static inline void vdl_vector_primitive_SetDoubleByArrayAndIndex_BT(VDL_VECTOR_T *const v, const double *const item_pointer, const int *const index_pointer, const int number)
+static inline void vdl_vector_primitive_SetDoubleByArrayAndIndex_BT(VDL_VECTOR_T *const v, const double *const item_pointer, const VDL_INDEX_T *const index_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckDoubleVector(v);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(number);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
     vdl_CheckNullPointer(index_pointer);
 
     vdl_for_i(number)
     {
-        vdl_CheckIntNA(index_pointer[i]);
+        vdl_CheckIndexNA(index_pointer[i]);
         vdl_CheckIndexOutOfBound(v, index_pointer[i]);
     }
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetDoubleByArrayAndIndex(v, item_pointer, index_pointer, number);
 }
 
-static inline void vdl_vector_primitive_SetVectorPointerByArrayAndIndex_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const *const item_pointer, const int *const index_pointer, const int number)
+static inline void vdl_vector_primitive_SetVectorPointerByArrayAndIndex_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const *const item_pointer, const VDL_INDEX_T *const index_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckVectorPointerVector(v);
-    vdl_CheckIntNA(number);
+    vdl_CheckIndexNA(number);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
     vdl_CheckNullPointer(index_pointer);
 
     vdl_for_i(number)
     {
-        vdl_CheckIntNA(index_pointer[i]);
+        vdl_CheckIndexNA(index_pointer[i]);
         vdl_CheckIndexOutOfBound(v, index_pointer[i]);
     }
 
+    vdl_vector_primitive_PrepareWrite(v);
     vdl_vector_primitive_UnsafeSetVectorPointerByArrayAndIndex(v, item_pointer, index_pointer, number);
 }
 
@@ -8,10 +8,175 @@
 
 // TODO: use restrict to increase performance
 
+/*-----------------------------------------------------------------------------
+ |  Allocator
+ ----------------------------------------------------------------------------*/
+
+/// Subsystems of the library that allocate memory.
+/// @details The subsystem is passed to every function of the allocator, so a custom allocator
+/// can account or place memory per subsystem. \n\n
+/// VDL_SUBSYSTEM_VECTOR_HEADER: 0, vector structs, together with their inline data containers. \n\n
+/// VDL_SUBSYSTEM_VECTOR_DATA: 1, data containers of vectors and shared data buffers. \n\n
+/// VDL_SUBSYSTEM_ATTRIBUTE: 2, vector structs of attributes. \n\n
+/// VDL_SUBSYSTEM_VECTOR_TABLE: 3, vector tables, including the nursery and the remembered set. \n\n
+/// VDL_SUBSYSTEM_ARENA: 4, arena chunks and the bookkeeping of escaping arena vectors. \n\n
+/// VDL_SUBSYSTEM_STACK: 5, the root stack, the root scopes and the mark stack. \n\n
+/// VDL_SUBSYSTEM_CLEANUP: 6, memory freed by the exception cleanup, which does not know the subsystem
+/// that allocated it. \n\n
+/// VDL_SUBSYSTEM_WORKSPACE: 7, temporary buffers of vector operations and lazy expressions.
+typedef enum VDL_SUBSYSTEM_T
+{
+    VDL_SUBSYSTEM_VECTOR_HEADER = 0,
+    VDL_SUBSYSTEM_VECTOR_DATA   = 1,
+    VDL_SUBSYSTEM_ATTRIBUTE     = 2,
+    VDL_SUBSYSTEM_VECTOR_TABLE  = 3,
+    VDL_SUBSYSTEM_ARENA         = 4,
+    VDL_SUBSYSTEM_STACK         = 5,
+    VDL_SUBSYSTEM_CLEANUP       = 6,
+    VDL_SUBSYSTEM_WORKSPACE     = 7
+} VDL_SUBSYSTEM_T;
+
+#define VDL_SUBSYSTEM_NUM 8
+
+/// Allocator interface.
+/// @details Every function receives the context of the allocator as the first argument, and
+/// the subsystem requesting the memory as the last argument.
+/// Allocation functions return NULL on failure, and `Free` ignores NULL.
+/// @param Alloc (void *(*)(void *, size_t, VDL_SUBSYSTEM_T)). Allocate a number of bytes.
+/// @param Calloc (void *(*)(void *, size_t, size_t, VDL_SUBSYSTEM_T)). Allocate a number of zero-initialized slots.
+/// @param Realloc (void *(*)(void *, void *, size_t, VDL_SUBSYSTEM_T)). Resize a memory block.
+/// @param Free (void (*)(void *, void *, VDL_SUBSYSTEM_T)). Free a memory block.
+/// @param Context (void *). Context of the allocator.
+typedef struct VDL_ALLOCATOR_T
+{
+    void *(*Alloc)(void *context, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+    void *(*Calloc)(void *context, size_t count, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+    void *(*Realloc)(void *context, void *object, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+    void (*Free)(void *context, void *object, VDL_SUBSYSTEM_T subsystem);
+    void *Context;
+} VDL_ALLOCATOR_T;
+
+/// Allocator functions backed by the C standard library.
+static inline void *vdl_LibcAlloc(void *context, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void *vdl_LibcCalloc(void *context, size_t count, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void *vdl_LibcRealloc(void *context, void *object, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void vdl_LibcFree(void *context, void *object, VDL_SUBSYSTEM_T subsystem);
+
+/// Allocator functions backed by the memory pool.
+static inline void *vdl_MemoryPoolAlloc(void *context, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void *vdl_MemoryPoolCalloc(void *context, size_t count, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void *vdl_MemoryPoolRealloc(void *context, void *object, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+static inline void vdl_MemoryPoolFree(void *context, void *object, VDL_SUBSYSTEM_T subsystem);
+
+/// Allocator backed by the C standard library.
+static const VDL_ALLOCATOR_T vdl_LibcAllocator = {.Alloc   = vdl_LibcAlloc,
+                                                  .Calloc  = vdl_LibcCalloc,
+                                                  .Realloc = vdl_LibcRealloc,
+                                                  .Free    = vdl_LibcFree,
+                                                  .Context = NULL};
+
+/// Allocator backed by the memory pool.
+static const VDL_ALLOCATOR_T vdl_MemoryPoolAllocator = {.Alloc   = vdl_MemoryPoolAlloc,
+                                                        .Calloc  = vdl_MemoryPoolCalloc,
+                                                        .Realloc = vdl_MemoryPoolRealloc,
+                                                        .Free    = vdl_MemoryPoolFree,
+                                                        .Context = NULL};
+
+/// A global variable for storing the allocator used by the library.
+/// @details It defaults to the memory pool allocator. Vectors, vector tables,
+/// attributes, arena chunks and the buffers of the garbage collector are all allocated by it.
+/// Mark deques of parallel marking are allocated by the C standard library, as they grow
+/// on worker threads.
+static VDL_ALLOCATOR_T vdl_GlobalVar_Allocator = {.Alloc   = vdl_MemoryPoolAlloc,
+                                                  .Calloc  = vdl_MemoryPoolCalloc,
+                                                  .Realloc = vdl_MemoryPoolRealloc,
+                                                  .Free    = vdl_MemoryPoolFree,
+                                                  .Context = NULL};
+
+/// Set the allocator used by the library.
+/// @details The allocator can only be swapped when no memory allocated by the current
+/// allocator is owned by the library, i.e., before the garbage collector is initialized
+/// or after it is killed.
+/// @param allocator (const VDL_ALLOCATOR_T *). An allocator. It will be copied.
+#define vdl_SetAllocator(...) vdl_CallVoidFunction(vdl_SetAllocator_BT, __VA_ARGS__)
+static inline void vdl_SetAllocator_BT(const VDL_ALLOCATOR_T *allocator);
+
 /*-----------------------------------------------------------------------------
  |  Memory bookkeeping
  ----------------------------------------------------------------------------*/
 
+/// Size of the prefix of a memory block.
+/// @details The prefix stores the size class of the block, and keeps the payload aligned
+/// for any fundamental type.
+#define VDL_MEMORY_BLOCK_PREFIX_SIZE ((size_t) 16)
+
+/// Number of size classes served by the memory pool.
+#define VDL_MEMORY_SIZE_CLASS_NUM 11
+
+/// Payload sizes of the size classes.
+/// @details The small classes are tuned for vector headers and short data containers.
+/// Requests larger than the last class are served by `malloc` directly.
+static const size_t VDL_MEMORY_SIZE_CLASS[VDL_MEMORY_SIZE_CLASS_NUM] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 2048, 4096};
+
+/// Size class of a block allocated by `malloc` directly.
+/// @details The second word of the prefix stores the requested size.
+#define VDL_MEMORY_SIZE_CLASS_LARGE SIZE_MAX
+
+/// Size class of a block mapped by `mmap` directly.
+/// @details The second word of the prefix stores the length of the mapping.
+#define VDL_MEMORY_SIZE_CLASS_MAPPED (SIZE_MAX - 1)
+
+/// Whether large blocks are mapped by `mmap` and grown by `mremap`.
+/// @details `mremap` moves the pages of a mapping instead of copying the content,
+/// so growing a large data container does not touch the existing data.
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+#define VDL_MEMORY_MREMAP_ENABLE
+#endif
+
+/// Minimum size of a mapped block.
+/// @details Smaller blocks are cheaper to copy than to map.
+#define VDL_MEMORY_MAP_THRESHOLD ((size_t) 64 * 1024)
+
+/// Get the prefix of a memory block.
+/// @param object (void *). The payload of the block.
+/// @return (size_t *) The prefix.
+#define vdl_MemoryBlockPrefix(object) ((size_t *) ((char *) (object) - VDL_MEMORY_BLOCK_PREFIX_SIZE))
+
+/// Length of a mapping that holds a memory block.
+/// @param bytes (size_t). Size of the payload.
+/// @return (size_t) Size of the payload and the prefix, rounded up to whole pages.
+static inline size_t vdl_MemoryMappedLength(size_t bytes);
+
+/// Size of a slab carved into blocks of a size class.
+#define VDL_MEMORY_SLAB_SIZE ((size_t) 64 * 1024)
+
+/// A free block of the memory pool.
+/// @param Next (struct VDL_MEMORY_FREE_BLOCK_T *). Next free block of the same size class.
+typedef struct VDL_MEMORY_FREE_BLOCK_T
+{
+    struct VDL_MEMORY_FREE_BLOCK_T *Next;
+} VDL_MEMORY_FREE_BLOCK_T;
+
+/// A global variable for storing the memory pool.
+/// @param FreeList (VDL_MEMORY_FREE_BLOCK_T *[VDL_MEMORY_SIZE_CLASS_NUM]). Free blocks of each size class.
+/// @param Cursor (char *[VDL_MEMORY_SIZE_CLASS_NUM]). Next unused block of the current slab of each size class.
+/// @param End (char *[VDL_MEMORY_SIZE_CLASS_NUM]). End of the current slab of each size class.
+/// @param Slab (void *). The latest slab. Every slab stores the previous one in its prefix.
+/// @param BlockInUse (size_t). Number of pool blocks in use.
+static struct
+{
+    VDL_MEMORY_FREE_BLOCK_T *FreeList[VDL_MEMORY_SIZE_CLASS_NUM];
+    char *Cursor[VDL_MEMORY_SIZE_CLASS_NUM];
+    char *End[VDL_MEMORY_SIZE_CLASS_NUM];
+    void *Slab;
+    size_t BlockInUse;
+} vdl_GlobalVar_MemoryPool = {0};
+
+/// Release all the slabs of the memory pool.
+/// @details Nothing will be released if any pool block is still in use.
+#define vdl_MemoryPoolRelease(...) vdl_CallVoidFunction(vdl_MemoryPoolRelease_BT, __VA_ARGS__)
+static inline void vdl_MemoryPoolRelease_BT(void);
+
 /*-----------------------------------------------------------------------------
  |  Malloc, calloc and free
  ----------------------------------------------------------------------------*/
@@ -20,29 +185,109 @@
 /// @param bytes (size_t). Size of the memory block.
 /// @param register_object (int). Whether to register the allocated object to be cleaned up
 /// when an exception raised.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem requesting the memory.
 #define vdl_Malloc(...) vdl_CallFunction(vdl_Malloc_BT, void *, __VA_ARGS__)
-static inline void *vdl_Malloc_BT(size_t bytes, int register_object);
+static inline void *vdl_Malloc_BT(size_t bytes, int register_object, VDL_SUBSYSTEM_T subsystem);
 
 /// Allocate memory and fill them with 0.
 /// @param count (size_t). Number of slots.
 /// @param bytes (size_t). Size of each slot.
 /// @param register_object (int). Whether to register the allocated object to be cleaned up
 /// when an exception raised.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem requesting the memory.
 #define vdl_Calloc(...) vdl_CallFunction(vdl_Calloc_BT, void *, __VA_ARGS__)
-static inline void *vdl_Calloc_BT(size_t count, size_t bytes, int register_object);
-#define vdl_Free free
+static inline void *vdl_Calloc_BT(size_t count, size_t bytes, int register_object, VDL_SUBSYSTEM_T subsystem);
+
+/// Resize memory allocated by `vdl_Malloc`, `vdl_Calloc` or `vdl_Realloc`.
+/// @details The object will not be registered to be cleaned up. The original object
+/// is left untouched if an exception is raised.
+/// @param object (void *). A memory block.
+/// @param bytes (size_t). New size of the memory block.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem owning the memory.
+#define vdl_Realloc(...) vdl_CallFunction(vdl_Realloc_BT, void *, __VA_ARGS__)
+static inline void *vdl_Realloc_BT(void *object, size_t bytes, VDL_SUBSYSTEM_T subsystem);
+
+/// Free memory allocated by `vdl_Malloc`, `vdl_Calloc` or `vdl_Realloc`.
+/// @param object (void *). A memory block. NULL will be ignored.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem owning the memory.
+static inline void vdl_Free(void *object, VDL_SUBSYSTEM_T subsystem);
+
+/// Free memory registered to be cleaned up by `vdl_Malloc` or `vdl_Calloc`.
+/// @details Cleanup functions only receive the object, so the memory is freed as `VDL_SUBSYSTEM_CLEANUP`.
+/// @param object (void *). A memory block. NULL will be ignored.
+static inline void vdl_FreeCleanUp(void *object);
+
+/// Allocate memory aligned to a boundary.
+/// @details The distance to the start of the underlying block is stored right before
+/// the returned address.
+/// @param bytes (size_t). Size of the memory block.
+/// @param alignment (size_t). A power of two that is at least `sizeof(size_t)`.
+/// @param register_object (int). Whether to register the allocated object to be cleaned up
+/// when an exception raised.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem requesting the memory.
+#define vdl_AlignedMalloc(...) vdl_CallFunction(vdl_AlignedMalloc_BT, void *, __VA_ARGS__)
+static inline void *vdl_AlignedMalloc_BT(size_t bytes, size_t alignment, int register_object, VDL_SUBSYSTEM_T subsystem);
+
+/// Allocate memory aligned to a boundary and fill them with 0.
+/// @param bytes (size_t). Size of the memory block.
+/// @param alignment (size_t). A power of two that is at least `sizeof(size_t)`.
+/// @param register_object (int). Whether to register the allocated object to be cleaned up
+/// when an exception raised.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem requesting the memory.
+#define vdl_AlignedCalloc(...) vdl_CallFunction(vdl_AlignedCalloc_BT, void *, __VA_ARGS__)
+static inline void *vdl_AlignedCalloc_BT(size_t bytes, size_t alignment, int register_object, VDL_SUBSYSTEM_T subsystem);
+
+/// Resize memory allocated by `vdl_AlignedMalloc`, `vdl_AlignedCalloc` or `vdl_AlignedRealloc`.
+/// @details The alignment must be the same as the one used to allocate the object.
+/// The object will not be registered to be cleaned up.
+/// @param object (void *). A memory block.
+/// @param bytes (size_t). New size of the memory block.
+/// @param alignment (size_t). A power of two that is at least `sizeof(size_t)`.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem owning the memory.
+#define vdl_AlignedRealloc(...) vdl_CallFunction(vdl_AlignedRealloc_BT, void *, __VA_ARGS__)
+static inline void *vdl_AlignedRealloc_BT(void *object, size_t bytes, size_t alignment, VDL_SUBSYSTEM_T subsystem);
+
+/// Free memory allocated by `vdl_AlignedMalloc`, `vdl_AlignedCalloc` or `vdl_AlignedRealloc`.
+/// @param object (void *). A memory block. NULL will be ignored.
+/// @param subsystem (VDL_SUBSYSTEM_T). Subsystem owning the memory.
+static inline void vdl_AlignedFree(void *object, VDL_SUBSYSTEM_T subsystem);
+
+/// Free aligned memory registered to be cleaned up by `vdl_AlignedMalloc` or `vdl_AlignedCalloc`.
+/// @details The memory is freed as `VDL_SUBSYSTEM_CLEANUP`.
+/// @param object (void *). A memory block. NULL will be ignored.
+static inline void vdl_AlignedFreeCleanUp(void *object);
+
+/// Get the subsystem of the vector struct of a vector. No checks will be performed.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (VDL_SUBSYSTEM_T) `VDL_SUBSYSTEM_ATTRIBUTE` for attributes, `VDL_SUBSYSTEM_VECTOR_HEADER` otherwise.
+#define vdl_HeaderSubsystemOf(v) ((v)->Flag & VDL_FLAG_ATTRIBUTE ? VDL_SUBSYSTEM_ATTRIBUTE : VDL_SUBSYSTEM_VECTOR_HEADER)
+
+/// Free a heap allocated vector and its data container.
+/// @details The attribute of a vector is a vector recorded by the garbage collector,
+/// so it will be freed by the garbage collector separately. The data container of a
+/// file mapped vector is unmapped. A shared data buffer is only released together with
+/// the last vector referencing it.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_FreeVector(...) vdl_CallVoidFunction(vdl_FreeVector_BT, __VA_ARGS__)
+static inline void vdl_FreeVector_BT(VDL_VECTOR_P v);
 
 /*-----------------------------------------------------------------------------
  |  Vector table
  ----------------------------------------------------------------------------*/
 
+/// Initial number of slots of a vector table. It must be a power of two.
 #define VDL_VECTOR_TABLE_INIT_CAPACITY 8
-#define VDL_VECTOR_TABLE_MAX_CAPACITY (INT_MAX - 512)
+/// Maximum number of slots of a vector table. It must be a power of two.
+#define VDL_VECTOR_TABLE_MAX_CAPACITY (1 << 30)
 
 /// Vector table struct.
-/// @param Capacity (int). Capacity.
-/// @param Length (int). Length.
-/// @param Data (VDL_VECTOR_P *). Data.
+/// @details A vector table is an open-addressing hash set of vector pointers with
+/// linear probing. Empty slots are NULL. Deletion shifts the following entries of the
+/// probe sequence backward, so no tombstone is needed. The table is grown to keep
+/// the load factor under three quarters.
+/// @param Capacity (int). Number of slots. Always a power of two.
+/// @param Length (int). Number of recorded vectors.
+/// @param Data (VDL_VECTOR_P *). Slots.
 typedef struct VDL_VECTOR_TABLE_T
 {
     int Capacity;
@@ -53,6 +298,17 @@ typedef struct VDL_VECTOR_TABLE_T
 /// A pointer to a vector table struct.
 typedef VDL_VECTOR_TABLE_T *VDL_VECTOR_TABLE_P;
 
+/// Home slot of a vector in a vector table.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (int) The slot.
+#define vdl_VectorTableHomeSlot(vector_table, v) ((int) (vdl_HashAddress(v) & (size_t) ((vector_table)->Capacity - 1)))
+
+/// Number of vectors a vector table can hold without growing.
+/// @param capacity (int). Number of slots.
+/// @return (int) Maximum number of vectors.
+#define vdl_VectorTableMaxLoad(capacity) ((capacity) / 4 * 3)
+
 /*-----------------------------------------------------------------------------
  |  Vector table operations
  ----------------------------------------------------------------------------*/
@@ -62,6 +318,12 @@ typedef VDL_VECTOR_TABLE_T *VDL_VECTOR_TABLE_P;
 #define vdl_NewVectorTable(...) vdl_CallFunction(vdl_NewVectorTable_BT, VDL_VECTOR_TABLE_P, __VA_ARGS__)
 static inline VDL_VECTOR_TABLE_P vdl_NewVectorTable_BT(void);
 
+/// Rehash a vector table into a given number of slots.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
+/// @param capacity (int) Number of slots. It must be a power of two.
+#define vdl_RehashVectorTable(...) vdl_CallVoidFunction(vdl_RehashVectorTable_BT, __VA_ARGS__)
+static inline void vdl_RehashVectorTable_BT(VDL_VECTOR_TABLE_P vector_table, int capacity);
+
 /// Shrink the size of a vector table. Unused space will be removed.
 /// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
 #define vdl_ShrinkVectorTable(...) vdl_CallVoidFunction(vdl_ShrinkVectorTable_BT, __VA_ARGS__)
@@ -80,7 +342,7 @@ static inline void vdl_DeleteVectorTable_BT(VDL_VECTOR_TABLE_P vector_table, int
 
 /// Reserve space for a vector table.
 /// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
-/// @param capacity (int) Requested capacity.
+/// @param capacity (int) Requested number of vectors.
 #define vdl_ReserveForVectorTable(...) vdl_CallVoidFunction(vdl_ReserveForVectorTable_BT, __VA_ARGS__)
 static inline void vdl_ReserveForVectorTable_BT(VDL_VECTOR_TABLE_P vector_table, int capacity);
 
@@ -98,7 +360,7 @@ static inline void vdl_PrintVectorTable_BT(VDL_VECTOR_TABLE_P vector_table);
 /// Find a vector in a vector table.
 /// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @return (int) Index of the vector. If not found, -1 will be returned.
+/// @return (int) Slot of the vector. If not found, -1 will be returned.
 #define vdl_FindInVectorTable(...) vdl_CallFunction(vdl_FindInVectorTable_BT, int, __VA_ARGS__)
 static inline int vdl_FindInVectorTable_BT(VDL_VECTOR_TABLE_P vector_table, VDL_VECTOR_P v);
 
@@ -117,33 +379,523 @@ static inline void vdl_VectorTableRecord_BT(VDL_VECTOR_TABLE_P vector_table, VDL
 #define vdl_VectorTableUntrack(...) vdl_CallVoidFunction(vdl_VectorTableUntrack_BT, __VA_ARGS__)
 static inline void vdl_VectorTableUntrack_BT(VDL_VECTOR_TABLE_P vector_table, VDL_VECTOR_P v, int free_content);
 
+/// Remove the vector stored in a slot. No checks will be performed.
+/// @details Following entries of the probe sequence are shifted backward, so the slot
+/// may hold another vector afterwards and needs to be visited again by an iteration.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
+/// @param slot (int). An occupied slot.
+static inline void vdl_VectorTableUnsafeRemoveSlot(VDL_VECTOR_TABLE_P vector_table, int slot);
+
+/*-----------------------------------------------------------------------------
+ |  Vector table iteration
+ ----------------------------------------------------------------------------*/
+
+/// Find the next occupied slot of a vector table. No checks will be performed.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
+/// @param slot (int). The slot to start the search.
+/// @return (int) The next occupied slot. The capacity will be returned if no slot is left.
+static inline int vdl_VectorTableNextSlot(VDL_VECTOR_TABLE_P vector_table, int slot);
+
+/// Find the slot following the first empty slot of a vector table. No checks will be performed.
+/// @details Removing an entry only shifts the entries up to the next empty slot, so a pass over
+/// the slots starting from here never sees an entry moved from a slot it has already passed.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table with at least one empty slot.
+/// @return (int) The slot following the first empty slot.
+static inline int vdl_VectorTableSweepOrigin(VDL_VECTOR_TABLE_P vector_table);
+
+/// Iterate over the occupied slots of a vector table.
+/// @details The vector table should not be modified during the iteration.
+/// @param vector_table (VDL_VECTOR_TABLE_P). A vector table.
+/// @param slot (identifier). Name of the slot counter (int).
+#define vdl_VectorTableForEach(vector_table, slot)                \
+    for (int slot = vdl_VectorTableNextSlot(vector_table, 0);     \
+         slot < (vector_table)->Capacity;                         \
+         slot = vdl_VectorTableNextSlot(vector_table, slot + 1))
+
+/*-----------------------------------------------------------------------------
+ |  Mark stack
+ ----------------------------------------------------------------------------*/
+
+#define VDL_MARK_STACK_INIT_CAPACITY 64
+
+/// A global variable for storing the vectors that are marked but not yet scanned.
+/// @details In terms of tri-color marking, unmarked vectors are white, marked vectors in
+/// the stack are grey and the other marked vectors are black.
+/// @param Capacity (int). Capacity.
+/// @param Length (int). Length.
+/// @param Data (VDL_VECTOR_P *). Data.
+static struct
+{
+    int Capacity;
+    int Length;
+    VDL_VECTOR_P *Data;
+} vdl_GlobalVar_MarkStack = {0};
+
+/// A global variable for storing the epoch of the current garbage collection.
+/// @details A vector is reachable if its mark equals the epoch. The epoch is
+/// increased by every collection, so marks never need to be cleared. Zero is reserved
+/// for vectors that have never been marked.
+static unsigned int vdl_GlobalVar_MarkEpoch = 0;
+
+/// Grow the mark stack.
+/// @param capacity (int). Requested capacity.
+#define vdl_ReserveForMarkStack(...) vdl_CallVoidFunction(vdl_ReserveForMarkStack_BT, __VA_ARGS__)
+static inline void vdl_ReserveForMarkStack_BT(int capacity);
+
+/// A global variable for storing whether the current garbage collection is a minor collection.
+/// @details A minor collection only marks vectors of the young generation.
+static int vdl_GlobalVar_MinorCollection = 0;
+
+/// Mark a vector and push it to the mark stack. No checks will be performed.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_PushToMarkStack(...) vdl_CallVoidFunction(vdl_PushToMarkStack_BT, __VA_ARGS__)
+static inline void vdl_PushToMarkStack_BT(VDL_VECTOR_P v);
+
+/// Mark a vector as reachable and push it to the mark stack if it has not been marked.
+/// @details Old vectors will be ignored by a minor collection.
+/// @param v (VDL_VECTOR_P). A vector. NULL will be ignored.
+#define vdl_GarbageCollectorMark(...) vdl_CallVoidFunction(vdl_GarbageCollectorMark_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorMark_BT(VDL_VECTOR_P v);
+
+/// Check whether a vector is marked by the current garbage collection.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (int) A boolean value.
+#define vdl_IsMarked(v) ((v)->Mark == vdl_GlobalVar_MarkEpoch)
+
+/// Start a new garbage collection epoch.
+/// @details Any unfinished incremental collection is abandoned.
+#define vdl_NewMarkEpoch(...) vdl_CallVoidFunction(vdl_NewMarkEpoch_BT, __VA_ARGS__)
+static inline void vdl_NewMarkEpoch_BT(void);
+
+/// Mark the children of a vector, i.e., its vector pointers and its attribute.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_GarbageCollectorMarkChildren(...) vdl_CallVoidFunction(vdl_GarbageCollectorMarkChildren_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorMarkChildren_BT(VDL_VECTOR_P v);
+
+/// Pop vectors from the mark stack and mark their children until the stack is empty.
+/// @details The work is shared by multiple threads if more than one mark thread is configured.
+#define vdl_DrainMarkStack(...) vdl_CallVoidFunction(vdl_DrainMarkStack_BT, __VA_ARGS__)
+static inline void vdl_DrainMarkStack_BT(void);
+
+/*-----------------------------------------------------------------------------
+ |  Root scopes
+ ----------------------------------------------------------------------------*/
+
+#define VDL_ROOT_STACK_INIT_CAPACITY 64
+
+/// A global variable for storing the vectors rooted by the root scopes.
+/// @param Capacity (int). Capacity.
+/// @param Length (int). Length.
+/// @param Data (VDL_VECTOR_P *). Data.
+static struct
+{
+    int Capacity;
+    int Length;
+    VDL_VECTOR_P *Data;
+} vdl_GlobalVar_RootStack = {0};
+
+/// A global variable for storing the length of the root stack when each root scope begins.
+/// @param Capacity (int). Capacity.
+/// @param Length (int). Number of open root scopes.
+/// @param Data (int *). Data.
+static struct
+{
+    int Capacity;
+    int Length;
+    int *Data;
+} vdl_GlobalVar_RootScopes = {0};
+
+/// Begin a root scope.
+/// @details Vectors rooted by `vdl_Root` stay reachable until the scope ends.
+/// Root scopes opened in a `vdl_Try` block are ended automatically if an exception is thrown.
+/// The library operations root their own operands, but a result is unrooted once it is returned.
+#define vdl_RootScopeBegin(...) vdl_CallVoidFunction(vdl_RootScopeBegin_BT, __VA_ARGS__)
+static inline void vdl_RootScopeBegin_BT(void);
+
+/// Root a vector in the innermost root scope.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (VDL_VECTOR_P) The same vector.
+#define vdl_Root(...) vdl_CallFunction(vdl_Root_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_Root_BT(VDL_VECTOR_P v);
+
+/// End the innermost root scope and drop all the vectors rooted by it.
+#define vdl_RootScopeEnd(...) vdl_CallVoidFunction(vdl_RootScopeEnd_BT, __VA_ARGS__)
+static inline void vdl_RootScopeEnd_BT(void);
+
+// The root stack, the root scopes and the critical depth are saved before a try, and restored if an
+// exception is thrown, such that the scopes and the critical sections left by a long jump are ended.
+#define VDL_GARBAGE_COLLECTOR_HOOK_START_TRY                                              \
+    VDL_BACKTRACE_HOOK_START_TRY;                                                         \
+    const int vdl_RootStackLengthBeforeTry  = vdl_GlobalVar_RootStack.Length;            \
+    const int vdl_RootScopesLengthBeforeTry = vdl_GlobalVar_RootScopes.Length;           \
+    const int vdl_CriticalDepthBeforeTry    = vdl_GlobalVar_AutoCollection.CriticalDepth
+
+#define VDL_GARBAGE_COLLECTOR_HOOK_START_CATCH                                            \
+    do {                                                                                  \
+        vdl_GlobalVar_RootStack.Length             = vdl_RootStackLengthBeforeTry;       \
+        vdl_GlobalVar_RootScopes.Length            = vdl_RootScopesLengthBeforeTry;      \
+        vdl_GlobalVar_AutoCollection.CriticalDepth = vdl_CriticalDepthBeforeTry;         \
+    } while (0)
+
+#ifdef VDL_EXCEPTION_HOOK_START_TRY
+    #undef VDL_EXCEPTION_HOOK_START_TRY
+#endif//VDL_EXCEPTION_HOOK_START_TRY
+#define VDL_EXCEPTION_HOOK_START_TRY VDL_GARBAGE_COLLECTOR_HOOK_START_TRY
+
+#ifdef VDL_EXCEPTION_HOOK_START_CATCH
+    #undef VDL_EXCEPTION_HOOK_START_CATCH
+#endif//VDL_EXCEPTION_HOOK_START_CATCH
+#define VDL_EXCEPTION_HOOK_START_CATCH VDL_GARBAGE_COLLECTOR_HOOK_START_CATCH
+
+/*-----------------------------------------------------------------------------
+ |  Parallel marking
+ ----------------------------------------------------------------------------*/
+
+#define VDL_MARK_DEQUE_INIT_CAPACITY 256
+
+/// Minimum number of live vectors for the mark phase to use the thread pool.
+#define VDL_PARALLEL_MARK_MIN_VECTOR_NUM 16384
+
+/// A work-stealing deque of grey vectors.
+/// @details The owner pushes and pops at the bottom, while other threads steal from the top.
+/// @param Lock (pthread_mutex_t). Lock of the deque.
+/// @param Capacity (int). Capacity.
+/// @param Top (int). Index of the first item.
+/// @param Bottom (int). Index after the last item.
+/// @param Data (VDL_VECTOR_P *). Data.
+typedef struct VDL_MARK_DEQUE_T
+{
+    pthread_mutex_t Lock;
+    int Capacity;
+    int Top;
+    int Bottom;
+    VDL_VECTOR_P *Data;
+} VDL_MARK_DEQUE_T;
+
+/// A global variable for storing the state of parallel marking.
+/// @details The workers are run by the thread pool, so the number of threads is set by
+/// `vdl_ThreadPoolSetThreadNum`.
+/// @param ThreadNum (int). Number of workers of the current mark, including the calling thread.
+/// @param Pending (int). Number of grey vectors that are not yet scanned.
+/// @param Error (int). Exception raised by a worker. Zero means no error.
+/// @param Deques (VDL_MARK_DEQUE_T [VDL_THREAD_POOL_MAX_THREAD_NUM]). Deques owned by the workers.
+static struct
+{
+    int ThreadNum;
+    int Pending;
+    int Error;
+    VDL_MARK_DEQUE_T Deques[VDL_THREAD_POOL_MAX_THREAD_NUM];
+} vdl_GlobalVar_ParallelMark = {.ThreadNum = 1};
+
+/// Push a vector to the bottom of a deque. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param deque (VDL_MARK_DEQUE_T *). A deque.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (int) Whether the vector is pushed. Zero means the allocation failed.
+static inline int vdl_MarkDequeUnsafePush(VDL_MARK_DEQUE_T *deque, VDL_VECTOR_P v);
+
+/// Pop a vector from the bottom of a deque. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param deque (VDL_MARK_DEQUE_T *). A deque.
+/// @return (VDL_VECTOR_P) A vector. NULL will be returned if the deque is empty.
+static inline VDL_VECTOR_P vdl_MarkDequeUnsafePop(VDL_MARK_DEQUE_T *deque);
+
+/// Steal a vector from the top of a deque. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param deque (VDL_MARK_DEQUE_T *). A deque.
+/// @return (VDL_VECTOR_P) A vector. NULL will be returned if the deque is empty.
+static inline VDL_VECTOR_P vdl_MarkDequeUnsafeSteal(VDL_MARK_DEQUE_T *deque);
+
+/// Atomically mark a vector and push it to the deque of a worker. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param id (int). Worker id.
+/// @param v (VDL_VECTOR_P). A vector. NULL will be ignored.
+static inline void vdl_ParallelUnsafeMark(int id, VDL_VECTOR_P v);
+
+/// Scan grey vectors as a worker until no grey vector is left in any deque. No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param id (int). Worker id.
+static inline void vdl_ParallelUnsafeMarkWorker(int id);
+
+/// Run the mark workers of a range of ids.
+/// @details It is run by the thread pool as a `VDL_PARALLEL_FUNCTION_T`. The workers of the range
+/// are run one after another by the same thread.
+/// @param begin (VDL_INDEX_T). The first worker id.
+/// @param end (VDL_INDEX_T). The worker id after the last one.
+/// @param context (void *). Not used.
+static inline void vdl_ParallelMarkWorker(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// Distribute the mark stack to the workers and mark all the reachable vectors with the thread pool.
+#define vdl_ParallelDrainMarkStack(...) vdl_CallVoidFunction(vdl_ParallelDrainMarkStack_BT, __VA_ARGS__)
+static inline void vdl_ParallelDrainMarkStack_BT(void);
+
+/*-----------------------------------------------------------------------------
+ |  Telemetry
+ ----------------------------------------------------------------------------*/
+
+/// Number of buckets of the pause time histogram.
+/// @details Bucket 0 counts pauses shorter than 2 microseconds, and bucket k counts
+/// pauses in [2^k, 2^(k+1)) microseconds. The last bucket also counts longer pauses.
+#define VDL_PAUSE_HISTOGRAM_BUCKET_NUM 32
+
+/// A global variable for storing the running counters of the heap and the garbage collector.
+/// @details Counters are only written by the thread running the garbage collector with relaxed
+/// atomic operations, so they can be read from another thread by `vdl_GarbageCollectorStats`.
+/// @param LiveObject (size_t). Number of recorded vectors not yet freed.
+/// @param LiveBytes (size_t [VDL_TYPE_NUM]). Bytes of recorded vectors not yet freed, by vector type.
+/// @param BytesAllocated (size_t). Total bytes recorded since the program started.
+/// @param Collection (size_t). Number of full collections, including completed incremental ones.
+/// @param MinorCollection (size_t). Number of minor collections.
+/// @param PauseHistogram (size_t [VDL_PAUSE_HISTOGRAM_BUCKET_NUM]). Pause time histogram.
+/// @param PauseMax (double). Longest pause in microseconds.
+static struct
+{
+    size_t LiveObject;
+    size_t LiveBytes[VDL_TYPE_NUM];
+    size_t BytesAllocated;
+    size_t Collection;
+    size_t MinorCollection;
+    size_t PauseHistogram[VDL_PAUSE_HISTOGRAM_BUCKET_NUM];
+    double PauseMax;
+} vdl_GlobalVar_GarbageCollectorCounter = {0};
+
+/// Add to a counter.
+/// @param counter (lvalue). A counter of `vdl_GlobalVar_GarbageCollectorCounter`.
+/// @param n (size_t). Number to add.
+#define vdl_CounterAdd(counter, n) __atomic_fetch_add(&(counter), (n), __ATOMIC_RELAXED)
+
+/// Subtract from a counter.
+/// @param counter (lvalue). A counter of `vdl_GlobalVar_GarbageCollectorCounter`.
+/// @param n (size_t). Number to subtract.
+#define vdl_CounterSub(counter, n) __atomic_fetch_sub(&(counter), (n), __ATOMIC_RELAXED)
+
+/// Count a vector as allocated.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_CountAllocation(v)                                                              \
+    do {                                                                                    \
+        const size_t _bytes = vdl_vector_primitive_SizeOfVector(v);                         \
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.LiveObject, 1);                \
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.LiveBytes[(v)->Type], _bytes); \
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.BytesAllocated, _bytes);       \
+    } while (0)
+
+/// Count a vector as freed.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_CountFree(v)                                                                                                  \
+    do {                                                                                                                  \
+        vdl_CounterSub(vdl_GlobalVar_GarbageCollectorCounter.LiveObject, 1);                                              \
+        vdl_CounterSub(vdl_GlobalVar_GarbageCollectorCounter.LiveBytes[(v)->Type], vdl_vector_primitive_SizeOfVector(v)); \
+    } while (0)
+
+/// Count the growth of the data container of a vector.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param bytes (size_t). Number of bytes added to the data container.
+#define vdl_CountGrowth(v, bytes)                                                            \
+    do {                                                                                     \
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.LiveBytes[(v)->Type], (bytes)); \
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.BytesAllocated, (bytes));       \
+    } while (0)
+
+/// Record the pause time of a collection in the histogram. No checks will be performed.
+/// @param pause_time (double). Pause time in microseconds.
+static inline void vdl_CountPause(double pause_time);
+
+/// Snapshot of the heap and garbage collector statistics.
+/// @param LiveObject (size_t). Number of recorded vectors not yet freed.
+/// @param LiveBytes (size_t [VDL_TYPE_NUM]). Bytes of recorded vectors not yet freed, by vector type.
+/// @param TotalLiveBytes (size_t). Bytes of recorded vectors not yet freed.
+/// @param BytesAllocated (size_t). Total bytes recorded since the program started.
+/// @param Collection (size_t). Number of full collections, including completed incremental ones.
+/// @param MinorCollection (size_t). Number of minor collections.
+/// @param PauseCount (size_t). Number of pauses, including every incremental step.
+/// @param PauseP50 (double). Median pause time in microseconds, estimated by the upper bound of a histogram bucket.
+/// @param PauseP99 (double). 99th percentile of the pause time in microseconds, estimated in the same way.
+/// @param PauseMax (double). Longest pause in microseconds.
+typedef struct VDL_GARBAGE_COLLECTOR_STATS_T
+{
+    size_t LiveObject;
+    size_t LiveBytes[VDL_TYPE_NUM];
+    size_t TotalLiveBytes;
+    size_t BytesAllocated;
+    size_t Collection;
+    size_t MinorCollection;
+    size_t PauseCount;
+    double PauseP50;
+    double PauseP99;
+    double PauseMax;
+} VDL_GARBAGE_COLLECTOR_STATS_T;
+
+/// Get the heap and garbage collector statistics.
+/// @details The cost does not depend on the size of the heap. This function does not use the
+/// backtrace nor the exception, so it is safe to be polled from another thread. Each counter is
+/// read atomically, but counters may be updated between two reads.
+/// @return (VDL_GARBAGE_COLLECTOR_STATS_T) Statistics.
+static inline VDL_GARBAGE_COLLECTOR_STATS_T vdl_GarbageCollectorStats(void);
+
 /*-----------------------------------------------------------------------------
  |  Garbage collector
  ----------------------------------------------------------------------------*/
 
-/// A global variable for storing all the allocated vectors.
+/// Phases of the garbage collector.
+/// @details
+/// VDL_GARBAGE_COLLECTOR_PHASE_IDLE: 0, no incremental collection is in progress. \n\n
+/// VDL_GARBAGE_COLLECTOR_PHASE_MARK: 1, reachable vectors are being traced. \n\n
+/// VDL_GARBAGE_COLLECTOR_PHASE_SWEEP: 2, unreachable vectors are being freed.
+typedef enum VDL_GARBAGE_COLLECTOR_PHASE_T
+{
+    VDL_GARBAGE_COLLECTOR_PHASE_IDLE  = 0,
+    VDL_GARBAGE_COLLECTOR_PHASE_MARK  = 1,
+    VDL_GARBAGE_COLLECTOR_PHASE_SWEEP = 2
+} VDL_GARBAGE_COLLECTOR_PHASE_T;
+
+/// A global variable for storing the phase of the incremental garbage collection.
+/// @details Vectors allocated during an incremental collection are marked immediately.
+static VDL_GARBAGE_COLLECTOR_PHASE_T vdl_GlobalVar_GarbageCollectorPhase = VDL_GARBAGE_COLLECTOR_PHASE_IDLE;
+
+/// A global variable for storing the slot where the sweep of the old generation starts.
+static int vdl_GlobalVar_SweepOrigin = 0;
+
+/// A global variable for storing the number of slots of the old generation already swept.
+static int vdl_GlobalVar_SweepSlot = 0;
+
+/// A global variable for storing the vectors of the old generation.
+/// @details Vectors surviving a collection are promoted from the nursery to this table.
 static VDL_VECTOR_TABLE_P vdl_GlobalVar_VectorTable = NULL;
 
+/// A global variable for storing the vectors of the young generation.
+/// @details Newly allocated vectors are recorded in the nursery.
+static VDL_VECTOR_TABLE_P vdl_GlobalVar_Nursery = NULL;
+
+/// A global variable for storing the old vectors that may refer to young vectors.
+static VDL_VECTOR_TABLE_P vdl_GlobalVar_RememberedSet = NULL;
+
 /// A global variable for storing all the directly reachable vectors.
 static VDL_VECTOR_TABLE_P vdl_GlobalVar_DirectlyReachable = NULL;
 
-/// A global variable for storing all the reachable vectors.
-static VDL_VECTOR_TABLE_P vdl_GlobalVar_Reachable = NULL;
+/// Statistics of a garbage collection.
+/// @param ObjectFreed (int). Number of vectors freed.
+/// @param ObjectPromoted (int). Number of vectors promoted to the old generation.
+/// @param BytesFreed (size_t). Number of bytes freed.
+/// @param BytesSurvived (size_t). Number of bytes of the swept vectors that survived.
+/// @param PauseTime (double). Pause time in microseconds.
+/// @param Completed (int). Whether the collection cycle is completed.
+typedef struct VDL_GARBAGE_COLLECTOR_RESULT_T
+{
+    int ObjectFreed;
+    int ObjectPromoted;
+    size_t BytesFreed;
+    size_t BytesSurvived;
+    double PauseTime;
+    int Completed;
+} VDL_GARBAGE_COLLECTOR_RESULT_T;
+
+/// Growth factor that disables the automatic collection.
+#define VDL_AUTO_COLLECTION_OFF (-1)
+
+/// Minimum number of allocated bytes that triggers an automatic collection.
+#define VDL_AUTO_COLLECTION_MIN_TRIGGER ((size_t) 4 * 1024 * 1024)
+
+/// A global variable for storing the state of the automatic collection.
+/// @details Recording a vector runs a full collection when the bytes allocated since the last
+/// full collection exceed the live bytes scaled by the growth factor, similar to GOGC of Go.
+/// The library operations root their operands and temporaries, so a collection can run at any
+/// allocation. Vectors held by the caller across an allocation must be rooted by the caller,
+/// including the result of an argument evaluated before a sibling argument allocates, as in
+/// `f(g(), h())`. Inside a critical section the collection is only requested, and it runs at the
+/// next allocation or `vdl_GarbageCollectorPoll` outside critical sections.
+/// The automatic collection is off by default.
+/// @param GrowthFactor (int). Growth over the live bytes in percentage. Negative value disables the automatic collection.
+/// @param CriticalDepth (int). Number of nested critical sections. No automatic collection happens inside a critical section.
+/// @param Pending (int). Whether a collection has been requested.
+/// @param LiveBytes (size_t). Number of bytes that survived the last collection.
+/// @param AllocatedBytes (size_t). Number of bytes recorded since the last collection.
+/// @param SurvivedBytes (size_t). Number of bytes that survived the ongoing incremental collection.
+static struct
+{
+    int GrowthFactor;
+    int CriticalDepth;
+    int Pending;
+    size_t LiveBytes;
+    size_t AllocatedBytes;
+    size_t SurvivedBytes;
+} vdl_GlobalVar_AutoCollection = {.GrowthFactor = VDL_AUTO_COLLECTION_OFF};
+
+/// Check whether an automatic collection should be requested.
+/// @return (int) A boolean value.
+#define vdl_GarbageCollectorShouldCollect()                                            \
+    (vdl_GlobalVar_AutoCollection.GrowthFactor >= 0 &&                                 \
+     vdl_GlobalVar_AutoCollection.AllocatedBytes >= VDL_AUTO_COLLECTION_MIN_TRIGGER && \
+     vdl_GlobalVar_AutoCollection.AllocatedBytes >=                                   \
+             vdl_GlobalVar_AutoCollection.LiveBytes / 100 * (size_t) vdl_GlobalVar_AutoCollection.GrowthFactor)
+
+/// Set the growth factor of the automatic collection.
+/// @param growth_factor (int). Growth over the live bytes in percentage. Negative value disables the automatic collection.
+#define vdl_GarbageCollectorSetGrowthFactor(...) vdl_CallVoidFunction(vdl_GarbageCollectorSetGrowthFactor_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorSetGrowthFactor_BT(int growth_factor);
+
+/// Run the requested automatic collection.
+/// @details A collection requested inside a critical section runs here or at the next allocation,
+/// whichever comes first. It should be called where every live vector is rooted, e.g. between two top level
+/// operations. Nothing happens inside a critical section or if no collection has been requested.
+#define vdl_GarbageCollectorPoll(...) vdl_CallVoidFunction(vdl_GarbageCollectorPoll_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorPoll_BT(void);
+
+/// Enter a critical section where no automatic collection happens.
+/// @details Critical sections can be nested. The critical sections entered in a `vdl_Try`
+/// block are left when the exception is caught by the matching `vdl_Catch`.
+#define vdl_GarbageCollectorCriticalBegin(...) vdl_CallVoidFunction(vdl_GarbageCollectorCriticalBegin_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorCriticalBegin_BT(void);
+
+/// Leave a critical section.
+#define vdl_GarbageCollectorCriticalEnd(...) vdl_CallVoidFunction(vdl_GarbageCollectorCriticalEnd_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorCriticalEnd_BT(void);
 
 /// Check the garbage collector state.
-#define vdl_CheckGarbageCollector() vdl_Expect(((vdl_GlobalVar_VectorTable == NULL) + (vdl_GlobalVar_DirectlyReachable == NULL) + (vdl_GlobalVar_Reachable == NULL)) % 3 == 0, \
-                                               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,                                                                             \
-                                               "The garbage collector state is inconsistent!")
+#define vdl_CheckGarbageCollector()                                                   \
+    vdl_Expect(((vdl_GlobalVar_VectorTable == NULL) +                                 \
+                (vdl_GlobalVar_Nursery == NULL) +                                     \
+                (vdl_GlobalVar_RememberedSet == NULL) +                               \
+                (vdl_GlobalVar_DirectlyReachable == NULL)) % 4 == 0,                  \
+               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,                    \
+               "The garbage collector state is inconsistent!")
 
 /// Check the garbage collector state.
 #define vdl_GarbageCollectorInit(...) vdl_CallVoidFunction(vdl_GarbageCollectorInit_BT, __VA_ARGS__)
 static inline void vdl_GarbageCollectorInit_BT(void);
 
-/// Record a vector by the garbage collector.
+/// Record a vector in the nursery.
+/// @details An automatic collection may run before the vector is recorded, so every other vector
+/// in use must be rooted. See `vdl_GlobalVar_AutoCollection`.
 /// @param v (VDL_VECTOR_P). A vector.
 #define vdl_GarbageCollectorRecord(...) vdl_CallVoidFunction(vdl_GarbageCollectorRecord_BT, __VA_ARGS__)
 static inline void vdl_GarbageCollectorRecord_BT(VDL_VECTOR_P v);
 
+/// Add an old vector to the remembered set.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_GarbageCollectorRemember(...) vdl_CallVoidFunction(vdl_GarbageCollectorRemember_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorRemember_BT(VDL_VECTOR_P v);
+
+/// Record a write of vector pointers into a vector.
+/// @details An old vector will be remembered, so a minor collection can find the young
+/// vectors it refers to without scanning the old generation. During the mark phase of an
+/// incremental collection, a black vector will be turned grey, so its new children will be traced.
+/// Vector pointer stores are covered by `vdl_GarbageCollectorWriteBarrier`.
+/// Writing the attribute of a vector needs to call this function directly.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_GarbageCollectorRecordWrite(...) vdl_CallVoidFunction(vdl_GarbageCollectorRecordWrite_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorRecordWrite_BT(VDL_VECTOR_P v);
+
+/// Write barrier of vector pointer stores.
+/// @details It needs to be called after vector pointers are stored into a vector.
+/// @param v (VDL_VECTOR_P). The vector being written.
+#define vdl_GarbageCollectorWriteBarrier(v)                                                  \
+    do {                                                                                     \
+        if ((v)->Type == VDL_TYPE_VECTOR_POINTER &&                                          \
+            (((v)->Flag & (VDL_FLAG_OLD | VDL_FLAG_REMEMBERED)) == VDL_FLAG_OLD ||           \
+             vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_MARK))       \
+            vdl_GarbageCollectorRecordWrite(v);                                              \
+    } while (0)
+
 /// Declare a vector to be directly reachable.
 /// @param v (VDL_VECTOR_P). A vector.
 #define vdl_DeclareDirectlyReachable(...) vdl_CallVoidFunction(vdl_DeclareDirectlyReachable_BT, __VA_ARGS__)
@@ -154,15 +906,67 @@ static inline void vdl_DeclareDirectlyReachable_BT(VDL_VECTOR_P v);
 #define vdl_DeclareDirectlyUnreachable(...) vdl_CallVoidFunction(vdl_DeclareDirectlyUnreachable_BT, __VA_ARGS__)
 static inline void vdl_DeclareDirectlyUnreachable_BT(VDL_VECTOR_P v);
 
-/// Update the table of reachable vectors.
+/// Mark the directly reachable vectors and the vectors rooted by the root scopes.
+#define vdl_GarbageCollectorMarkRoots(...) vdl_CallVoidFunction(vdl_GarbageCollectorMarkRoots_BT, __VA_ARGS__)
+static inline void vdl_GarbageCollectorMarkRoots_BT(void);
+
+/// Mark all the vectors reachable from the directly reachable vectors.
+/// @details A reachable vector can be checked by `vdl_IsMarked` until the next collection.
 #define vdl_UpdateReachable(...) vdl_CallVoidFunction(vdl_UpdateReachable_BT, __VA_ARGS__)
 static inline void vdl_UpdateReachable_BT(void);
 
-/// Clean the vector table based on reachable vectors.
-#define vdl_GarbageCollectorCleanUp(...) vdl_CallVoidFunction(vdl_GarbageCollectorCleanUp_BT, __VA_ARGS__)
-static inline void vdl_GarbageCollectorCleanUp_BT(void);
+/// Sweep a number of slots of the old generation.
+/// @details The slots are swept in order from `origin`, wrapping around the end of the table,
+/// so every vector is visited once.
+/// @param origin (int). The first slot of the sweep, given by `vdl_VectorTableSweepOrigin`.
+/// @param position (int). Number of slots already swept.
+/// @param budget (int). Maximum number of vectors to visit.
+/// @param result (VDL_GARBAGE_COLLECTOR_RESULT_T *). Statistics to be updated.
+/// @return (int) Number of slots swept. The capacity will be returned if the sweep is finished.
+#define vdl_SweepOldGeneration(...) vdl_CallFunction(vdl_SweepOldGeneration_BT, int, __VA_ARGS__)
+static inline int vdl_SweepOldGeneration_BT(int origin, int position, int budget, VDL_GARBAGE_COLLECTOR_RESULT_T *result);
+
+/// Sweep the nursery. Unreachable vectors are freed and reachable vectors are promoted.
+/// @details The remembered set is emptied since no young vector is left.
+/// @return (VDL_GARBAGE_COLLECTOR_RESULT_T) Statistics of the collection.
+#define vdl_GarbageCollectorSweepNursery(...) vdl_CallFunction(vdl_GarbageCollectorSweepNursery_BT, VDL_GARBAGE_COLLECTOR_RESULT_T, __VA_ARGS__)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorSweepNursery_BT(void);
+
+/// Empty the remembered set.
+#define vdl_ClearRememberedSet(...) vdl_CallVoidFunction(vdl_ClearRememberedSet_BT, __VA_ARGS__)
+static inline void vdl_ClearRememberedSet_BT(void);
+
+/// Sweep both generations and free all the unreachable vectors.
+/// @return (VDL_GARBAGE_COLLECTOR_RESULT_T) Statistics of the collection.
+#define vdl_GarbageCollectorSweep(...) vdl_CallFunction(vdl_GarbageCollectorSweep_BT, VDL_GARBAGE_COLLECTOR_RESULT_T, __VA_ARGS__)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorSweep_BT(void);
+
+/// Perform a step of the incremental garbage collection.
+/// @details A step traces or sweeps vectors until the budget is used up. An incremental
+/// collection starts by marking the roots and ends by sweeping the nursery; both happen
+/// within a single step. A full or minor clean-up abandons the unfinished incremental collection.
+/// Vectors declared directly reachable during the sweep phase need to be reachable when the
+/// collection started.
+/// @param object_budget (int). Maximum number of vectors to visit. Non-positive value means no limit.
+/// @param time_budget (double). Maximum time in microseconds. Non-positive value means no limit.
+/// @return (VDL_GARBAGE_COLLECTOR_RESULT_T) Statistics of the step.
+#define vdl_GarbageCollectorStep(...) vdl_CallFunction(vdl_GarbageCollectorStep_BT, VDL_GARBAGE_COLLECTOR_RESULT_T, __VA_ARGS__)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorStep_BT(int object_budget, double time_budget);
+
+/// Collect the young generation only.
+/// @details Roots and the remembered set are traced without entering the old generation.
+/// Surviving young vectors are promoted to the old generation.
+/// @return (VDL_GARBAGE_COLLECTOR_RESULT_T) Statistics of the collection.
+#define vdl_GarbageCollectorMinorCleanUp(...) vdl_CallFunction(vdl_GarbageCollectorMinorCleanUp_BT, VDL_GARBAGE_COLLECTOR_RESULT_T, __VA_ARGS__)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorMinorCleanUp_BT(void);
+
+/// Free all the vectors that are not reachable from both generations.
+/// @return (VDL_GARBAGE_COLLECTOR_RESULT_T) Statistics of the collection.
+#define vdl_GarbageCollectorCleanUp(...) vdl_CallFunction(vdl_GarbageCollectorCleanUp_BT, VDL_GARBAGE_COLLECTOR_RESULT_T, __VA_ARGS__)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorCleanUp_BT(void);
 
 /// Kill the garbage collector.
+/// @details The worker threads of the thread pool are stopped as well.
 #define vdl_GarbageCollectorKill(...) vdl_CallVoidFunction(vdl_GarbageCollectorKill_BT, __VA_ARGS__)
 static inline void vdl_GarbageCollectorKill_BT(void);
 
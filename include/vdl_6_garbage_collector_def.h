@@ -5,42 +5,398 @@
 #ifndef VDL_VDL_6_GARBAGE_COLLECTOR_DEF_H
 #define VDL_VDL_6_GARBAGE_COLLECTOR_DEF_H
 
+/*-----------------------------------------------------------------------------
+ |  Allocator
+ ----------------------------------------------------------------------------*/
+
+static inline void *vdl_LibcAlloc(void *const context, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+    return malloc(bytes);
+}
+
+static inline void *vdl_LibcCalloc(void *const context, const size_t count, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+    return calloc(count, bytes);
+}
+
+static inline void *vdl_LibcRealloc(void *const context, void *const object, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+    return realloc(object, bytes);
+}
+
+static inline void vdl_LibcFree(void *const context, void *const object, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+    free(object);
+}
+
+static inline void vdl_SetAllocator_BT(const VDL_ALLOCATOR_T *const allocator)
+{
+    vdl_CheckNullPointer(allocator);
+    vdl_CheckNullPointer(allocator->Alloc);
+    vdl_CheckNullPointer(allocator->Calloc);
+    vdl_CheckNullPointer(allocator->Realloc);
+    vdl_CheckNullPointer(allocator->Free);
+    vdl_Expect(vdl_GlobalVar_VectorTable == NULL &&
+                       vdl_GlobalVar_Nursery == NULL &&
+                       vdl_GlobalVar_RememberedSet == NULL &&
+                       vdl_GlobalVar_DirectlyReachable == NULL &&
+                       vdl_GlobalVar_MarkStack.Data == NULL &&
+                       vdl_GlobalVar_RootStack.Data == NULL &&
+                       vdl_GlobalVar_RootScopes.Data == NULL &&
+                       vdl_GlobalVar_Arena.Current.Chunk == NULL &&
+                       vdl_GlobalVar_MemoryPool.BlockInUse == 0,
+               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,
+               "Can not swap the allocator while the library owns memory allocated by it!");
+
+    vdl_GlobalVar_Allocator = *allocator;
+}
+
 /*-----------------------------------------------------------------------------
  |  Memory bookkeeping
  ----------------------------------------------------------------------------*/
 
+static inline size_t vdl_MemoryMappedLength(const size_t bytes)
+{
+    const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    return (bytes + VDL_MEMORY_BLOCK_PREFIX_SIZE + page_size - 1) / page_size * page_size;
+}
+
+static inline void *vdl_MemoryPoolAlloc(void *const context, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+
+    size_t size_class = 0;
+    while (size_class < VDL_MEMORY_SIZE_CLASS_NUM && VDL_MEMORY_SIZE_CLASS[size_class] < bytes)
+        size_class++;
+
+    // Large blocks bypass the pool
+    if (size_class == VDL_MEMORY_SIZE_CLASS_NUM)
+    {
+        if (bytes > SIZE_MAX - VDL_MEMORY_MAP_THRESHOLD)
+            return NULL;
+
+        size_t *block = NULL;
+#ifdef VDL_MEMORY_MREMAP_ENABLE
+        if (bytes >= VDL_MEMORY_MAP_THRESHOLD)
+        {
+            const size_t length = vdl_MemoryMappedLength(bytes);
+            void *mapping       = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                return NULL;
+            block    = mapping;
+            block[0] = VDL_MEMORY_SIZE_CLASS_MAPPED;
+            block[1] = length;
+            return (char *) block + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+        }
+#endif
+        block = malloc(bytes + VDL_MEMORY_BLOCK_PREFIX_SIZE);
+        if (block == NULL)
+            return NULL;
+        block[0] = VDL_MEMORY_SIZE_CLASS_LARGE;
+        block[1] = bytes;
+        return (char *) block + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+    }
+
+    const size_t block_size = VDL_MEMORY_SIZE_CLASS[size_class] + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+    size_t *block           = NULL;
+
+    // Reuse a free block, or carve a new one from the current slab
+    if (vdl_GlobalVar_MemoryPool.FreeList[size_class] != NULL)
+    {
+        VDL_MEMORY_FREE_BLOCK_T *free_block          = vdl_GlobalVar_MemoryPool.FreeList[size_class];
+        vdl_GlobalVar_MemoryPool.FreeList[size_class] = free_block->Next;
+        block                                         = vdl_MemoryBlockPrefix(free_block);
+    }
+    else
+    {
+        if (vdl_GlobalVar_MemoryPool.Cursor[size_class] == NULL ||
+            (size_t) (vdl_GlobalVar_MemoryPool.End[size_class] - vdl_GlobalVar_MemoryPool.Cursor[size_class]) < block_size)
+        {
+            void **slab = malloc(VDL_MEMORY_SLAB_SIZE);
+            if (slab == NULL)
+                return NULL;
+            slab[0]                                     = vdl_GlobalVar_MemoryPool.Slab;
+            vdl_GlobalVar_MemoryPool.Slab               = slab;
+            vdl_GlobalVar_MemoryPool.Cursor[size_class] = (char *) slab + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+            vdl_GlobalVar_MemoryPool.End[size_class]    = (char *) slab + VDL_MEMORY_SLAB_SIZE;
+        }
+        block = (size_t *) vdl_GlobalVar_MemoryPool.Cursor[size_class];
+        vdl_GlobalVar_MemoryPool.Cursor[size_class] += block_size;
+    }
+
+    block[0] = size_class;
+    vdl_GlobalVar_MemoryPool.BlockInUse++;
+    return (char *) block + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+}
+
+static inline void *vdl_MemoryPoolCalloc(void *const context, const size_t count, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    size_t total_bytes;
+    if (__builtin_mul_overflow(count, bytes, &total_bytes))
+        return NULL;
+
+    // Fresh mappings are already zero-filled
+    void *object = vdl_MemoryPoolAlloc(context, total_bytes, subsystem);
+    if (object != NULL && vdl_MemoryBlockPrefix(object)[0] != VDL_MEMORY_SIZE_CLASS_MAPPED)
+        memset(object, 0, total_bytes);
+    return object;
+}
+
+static inline void *vdl_MemoryPoolRealloc(void *const context, void *const object, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    if (object == NULL)
+        return vdl_MemoryPoolAlloc(context, bytes, subsystem);
+    if (bytes > SIZE_MAX - VDL_MEMORY_MAP_THRESHOLD)
+        return NULL;
+
+    size_t *block           = vdl_MemoryBlockPrefix(object);
+    const size_t size_class = block[0];
+    size_t old_bytes        = 0;
+
+    if (size_class < VDL_MEMORY_SIZE_CLASS_NUM)
+    {
+        // The block still fits its size class
+        if (bytes <= VDL_MEMORY_SIZE_CLASS[size_class])
+            return object;
+        old_bytes = VDL_MEMORY_SIZE_CLASS[size_class];
+    }
+#ifdef VDL_MEMORY_MREMAP_ENABLE
+    else if (size_class == VDL_MEMORY_SIZE_CLASS_MAPPED)
+    {
+        // Move the pages instead of copying the content
+        const size_t length = vdl_MemoryMappedLength(bytes);
+        void *mapping       = mremap(block, block[1], length, MREMAP_MAYMOVE);
+        if (mapping == MAP_FAILED)
+            return NULL;
+        block    = mapping;
+        block[1] = length;
+        return (char *) block + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+    }
+    else if (bytes >= VDL_MEMORY_MAP_THRESHOLD)
+    {
+        // A malloc block that grows past the threshold moves to a mapping
+        old_bytes = block[1];
+    }
+#endif
+    else
+    {
+        // realloc may extend a large block in place
+        block = realloc(block, bytes + VDL_MEMORY_BLOCK_PREFIX_SIZE);
+        if (block == NULL)
+            return NULL;
+        block[1] = bytes;
+        return (char *) block + VDL_MEMORY_BLOCK_PREFIX_SIZE;
+    }
+
+    void *new_object = vdl_MemoryPoolAlloc(context, bytes, subsystem);
+    if (new_object == NULL)
+        return NULL;
+    memcpy(new_object, object, old_bytes < bytes ? old_bytes : bytes);
+    vdl_MemoryPoolFree(context, object, subsystem);
+    return new_object;
+}
+
+static inline void vdl_MemoryPoolFree(void *const context, void *const object, const VDL_SUBSYSTEM_T subsystem)
+{
+    (void) context;
+    (void) subsystem;
+
+    if (object == NULL)
+        return;
+
+    size_t *block           = vdl_MemoryBlockPrefix(object);
+    const size_t size_class = block[0];
+    if (size_class == VDL_MEMORY_SIZE_CLASS_LARGE)
+    {
+        free(block);
+        return;
+    }
+#ifdef VDL_MEMORY_MREMAP_ENABLE
+    if (size_class == VDL_MEMORY_SIZE_CLASS_MAPPED)
+    {
+        munmap(block, block[1]);
+        return;
+    }
+#endif
+
+    VDL_MEMORY_FREE_BLOCK_T *free_block           = object;
+    free_block->Next                              = vdl_GlobalVar_MemoryPool.FreeList[size_class];
+    vdl_GlobalVar_MemoryPool.FreeList[size_class] = free_block;
+    vdl_GlobalVar_MemoryPool.BlockInUse--;
+}
+
+static inline void vdl_MemoryPoolRelease_BT(void)
+{
+    if (vdl_GlobalVar_MemoryPool.BlockInUse > 0)
+        return;
+
+    void **slab = vdl_GlobalVar_MemoryPool.Slab;
+    while (slab != NULL)
+    {
+        void **previous = slab[0];
+        free(slab);
+        slab = previous;
+    }
+    memset(&vdl_GlobalVar_MemoryPool, 0, sizeof(vdl_GlobalVar_MemoryPool));
+}
+
 /*-----------------------------------------------------------------------------
- |  Malloc and calloc
+ |  Malloc, calloc and free
  ----------------------------------------------------------------------------*/
 
-static inline void *vdl_Malloc_BT(const size_t bytes, const int register_object)
+static inline void *vdl_Malloc_BT(const size_t bytes, const int register_object, const VDL_SUBSYSTEM_T subsystem)
 {
-    void *object = malloc(bytes);
+    void *object = vdl_GlobalVar_Allocator.Alloc(vdl_GlobalVar_Allocator.Context, bytes, subsystem);
     vdl_CheckFailedAllocation(object);
     if (register_object)
-        vdl_ExceptionRegisterCleanUp(object, free);
+        vdl_ExceptionRegisterCleanUp(object, vdl_FreeCleanUp);
     return object;
 }
 
-static inline void *vdl_Calloc_BT(const size_t count, const size_t bytes, const int register_object)
+static inline void *vdl_Calloc_BT(const size_t count, const size_t bytes, const int register_object, const VDL_SUBSYSTEM_T subsystem)
 {
-    void *object = calloc(count, bytes);
+    void *object = vdl_GlobalVar_Allocator.Calloc(vdl_GlobalVar_Allocator.Context, count, bytes, subsystem);
     vdl_CheckFailedAllocation(object);
     if (register_object)
-        vdl_ExceptionRegisterCleanUp(object, free);
+        vdl_ExceptionRegisterCleanUp(object, vdl_FreeCleanUp);
     return object;
 }
 
+static inline void *vdl_Realloc_BT(void *const object, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    void *new_object = vdl_GlobalVar_Allocator.Realloc(vdl_GlobalVar_Allocator.Context, object, bytes, subsystem);
+    vdl_CheckFailedAllocation(new_object);
+    return new_object;
+}
+
+static inline void vdl_Free(void *const object, const VDL_SUBSYSTEM_T subsystem)
+{
+    vdl_GlobalVar_Allocator.Free(vdl_GlobalVar_Allocator.Context, object, subsystem);
+}
+
+static inline void vdl_FreeCleanUp(void *const object)
+{
+    vdl_Free(object, VDL_SUBSYSTEM_CLEANUP);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Aligned malloc, calloc and free
+ ----------------------------------------------------------------------------*/
+
+static inline void *vdl_AlignedMalloc_BT(const size_t bytes, const size_t alignment, const int register_object, const VDL_SUBSYSTEM_T subsystem)
+{
+    vdl_Expect(bytes <= SIZE_MAX - alignment - sizeof(size_t),
+               VDL_EXCEPTION_FAILED_ALLOCATION,
+               "Can not allocate [%zu] bytes aligned to [%zu] bytes!",
+               bytes,
+               alignment);
+
+    char *block  = vdl_Malloc(bytes + alignment - 1 + sizeof(size_t), 0, subsystem);
+    char *object = (char *) vdl_AlignUp((uintptr_t) (block + sizeof(size_t)), alignment);
+
+    ((size_t *) object)[-1] = (size_t) (object - block);
+    if (register_object)
+        vdl_ExceptionRegisterCleanUp(object, vdl_AlignedFreeCleanUp);
+    return object;
+}
+
+static inline void *vdl_AlignedCalloc_BT(const size_t bytes, const size_t alignment, const int register_object, const VDL_SUBSYSTEM_T subsystem)
+{
+    vdl_Expect(bytes <= SIZE_MAX - alignment - sizeof(size_t),
+               VDL_EXCEPTION_FAILED_ALLOCATION,
+               "Can not allocate [%zu] bytes aligned to [%zu] bytes!",
+               bytes,
+               alignment);
+
+    char *block  = vdl_Calloc(1, bytes + alignment - 1 + sizeof(size_t), 0, subsystem);
+    char *object = (char *) vdl_AlignUp((uintptr_t) (block + sizeof(size_t)), alignment);
+
+    ((size_t *) object)[-1] = (size_t) (object - block);
+    if (register_object)
+        vdl_ExceptionRegisterCleanUp(object, vdl_AlignedFreeCleanUp);
+    return object;
+}
+
+static inline void *vdl_AlignedRealloc_BT(void *const object, const size_t bytes, const size_t alignment, const VDL_SUBSYSTEM_T subsystem)
+{
+    if (object == NULL)
+        return vdl_AlignedMalloc(bytes, alignment, 0, subsystem);
+
+    vdl_Expect(bytes <= SIZE_MAX - alignment - sizeof(size_t),
+               VDL_EXCEPTION_FAILED_ALLOCATION,
+               "Can not allocate [%zu] bytes aligned to [%zu] bytes!",
+               bytes,
+               alignment);
+
+    const size_t offset = ((size_t *) object)[-1];
+    char *block         = vdl_Realloc((char *) object - offset, bytes + alignment - 1 + sizeof(size_t), subsystem);
+    char *new_object    = (char *) vdl_AlignUp((uintptr_t) (block + sizeof(size_t)), alignment);
+
+    // The block may have moved to an address with a different distance to the boundary
+    if ((size_t) (new_object - block) != offset)
+        memmove(new_object, block + offset, bytes);
+
+    ((size_t *) new_object)[-1] = (size_t) (new_object - block);
+    return new_object;
+}
+
+static inline void vdl_AlignedFree(void *const object, const VDL_SUBSYSTEM_T subsystem)
+{
+    if (object == NULL)
+        return;
+
+    vdl_Free((char *) object - ((size_t *) object)[-1], subsystem);
+}
+
+static inline void vdl_AlignedFreeCleanUp(void *const object)
+{
+    vdl_AlignedFree(object, VDL_SUBSYSTEM_CLEANUP);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Free vector
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_FreeVector_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullPointer(v);
+    vdl_Expect(v->Mode == VDL_MODE_HEAP || v->Mode == VDL_MODE_MMAP || v->Mode == VDL_MODE_VIEW,
+               VDL_EXCEPTION_UNEXPECTED_MODE,
+               "Unexpected vector mode [%s] provided! Vector mode [%s], [%s] or [%s] Expected!",
+               VDL_MODE_STRING[v->Mode],
+               VDL_MODE_STRING[VDL_MODE_HEAP],
+               VDL_MODE_STRING[VDL_MODE_MMAP],
+               VDL_MODE_STRING[VDL_MODE_VIEW]);
+
+    vdl_CountFree(v);
+    if (v->Buffer != NULL)
+        vdl_ReleaseSharedBuffer(v->Buffer);
+    else if (v->Mode == VDL_MODE_MMAP)
+        munmap(vdl_vector_primitive_FileMapping(v)->Address, vdl_vector_primitive_FileMapping(v)->Length);
+    else if (!(v->Flag & VDL_FLAG_INLINE))
+        vdl_AlignedFree(v->Data, VDL_SUBSYSTEM_VECTOR_DATA);
+    vdl_Free(v, vdl_HeaderSubsystemOf(v));
+}
+
 /*-----------------------------------------------------------------------------
  |  Vector table operations
  ----------------------------------------------------------------------------*/
 
 static inline VDL_VECTOR_TABLE_P vdl_NewVectorTable_BT(void)
 {
-    VDL_VECTOR_TABLE_T *vector_table = vdl_Malloc(sizeof(VDL_VECTOR_TABLE_T), 1);
+    VDL_VECTOR_TABLE_T *vector_table = vdl_Malloc(sizeof(VDL_VECTOR_TABLE_T), 1, VDL_SUBSYSTEM_VECTOR_TABLE);
     vector_table->Length             = 0;
-    vector_table->Capacity           = 0;
-    vector_table->Data               = vdl_Malloc(VDL_VECTOR_TABLE_INIT_CAPACITY * sizeof(VDL_VECTOR_P), 1);
+    vector_table->Capacity           = VDL_VECTOR_TABLE_INIT_CAPACITY;
+    vector_table->Data               = vdl_Calloc(VDL_VECTOR_TABLE_INIT_CAPACITY, sizeof(VDL_VECTOR_P), 1, VDL_SUBSYSTEM_VECTOR_TABLE);
 
     vdl_ExceptionDeregisterCleanUp(vector_table);
     vdl_ExceptionDeregisterCleanUp(vector_table->Data);
@@ -48,58 +404,74 @@ static inline VDL_VECTOR_TABLE_P vdl_NewVectorTable_BT(void)
     return vector_table;
 }
 
-static inline void vdl_ShrinkVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table)
+static inline void vdl_RehashVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table, const int capacity)
 {
     vdl_CheckNullVectorAndNullContainer(vector_table);
+    vdl_Expect(capacity > 0 && capacity <= VDL_VECTOR_TABLE_MAX_CAPACITY && (capacity & (capacity - 1)) == 0,
+               VDL_EXCEPTION_EXCEED_VECTOR_TABLE_LIMIT,
+               "Request vector table capacity [%d] is not a power of two in (0, %d]!",
+               capacity,
+               VDL_VECTOR_TABLE_MAX_CAPACITY);
+    vdl_Expect(vector_table->Length < capacity,
+               VDL_EXCEPTION_EXCEED_VECTOR_TABLE_LIMIT,
+               "Request vector table capacity [%d] can not hold [%d] vectors!",
+               capacity,
+               vector_table->Length);
 
-    // Decide the target size
-    size_t size_times_five = (size_t) vector_table->Length * 5;
-    if (size_times_five > VDL_VECTOR_MAX_CAPACITY)
-        size_times_five = VDL_VECTOR_MAX_CAPACITY;
-    size_t size_plus_5MB = (size_t) vector_table->Length + 700000;
-    if (size_plus_5MB > VDL_VECTOR_MAX_CAPACITY)
-        size_plus_5MB = VDL_VECTOR_MAX_CAPACITY;
-    size_t smaller_cap = size_times_five > size_plus_5MB ? size_plus_5MB : size_times_five;
-    if (smaller_cap < VDL_VECTOR_TABLE_INIT_CAPACITY)
-        smaller_cap = VDL_VECTOR_TABLE_INIT_CAPACITY;
-
-    if ((size_t) vector_table->Capacity <= smaller_cap)
-        return;
+    VDL_VECTOR_P *const buffer = vdl_Calloc((size_t) capacity, sizeof(VDL_VECTOR_P), 1, VDL_SUBSYSTEM_VECTOR_TABLE);
 
-    size_t target_size = smaller_cap * sizeof(VDL_VECTOR_P);
+    // Reinsert every vector into the new slots
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
+    const size_t mask                      = (size_t) capacity - 1;
+    vdl_for_i(vector_table->Capacity)
+    {
+        if (vectors[i] == NULL)
+            continue;
+        size_t slot = vdl_HashAddress(vectors[i]) & mask;
+        while (buffer[slot] != NULL)
+            slot = (slot + 1) & mask;
+        buffer[slot] = vectors[i];
+    }
 
-    // Reallocate memory for the data container
-    void *buffer = vdl_Malloc(target_size, 1);
-    memcpy(buffer, vector_table->Data, target_size);
-    vdl_Free(vector_table->Data);
+    vdl_Free(vector_table->Data, VDL_SUBSYSTEM_VECTOR_TABLE);
     vector_table->Data     = buffer;
-    vector_table->Capacity = (int) smaller_cap;
+    vector_table->Capacity = capacity;
 
     vdl_ExceptionDeregisterCleanUp(buffer);
 }
 
-static inline void vdl_ClearVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table, const int free_content)
+static inline void vdl_ShrinkVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table)
 {
     vdl_CheckNullVectorAndNullContainer(vector_table);
 
-    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
+    // Decide the smallest number of slots that keeps the load factor under the limit
+    int target_capacity = VDL_VECTOR_TABLE_INIT_CAPACITY;
+    while (target_capacity < VDL_VECTOR_TABLE_MAX_CAPACITY && vdl_VectorTableMaxLoad(target_capacity) < vector_table->Length)
+        target_capacity *= 2;
 
-    // Perform the check before deallocation to avoid partial free
-    if (free_content)
-    {
-        vdl_for_i(vector_table->Length) vdl_CheckNullPointer(vectors[i]);
-    }
+    // Only shrink when the table is mostly empty to avoid rehashing back and forth
+    if (vector_table->Capacity <= target_capacity * 4)
+        return;
+
+    vdl_RehashVectorTable(vector_table, target_capacity * 2);
+}
+
+static inline void vdl_ClearVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table, const int free_content)
+{
+    vdl_CheckNullVectorAndNullContainer(vector_table);
+
+    VDL_VECTOR_POINTER_ARRAY vectors = vector_table->Data;
 
     // Free the vectors
     if (free_content)
     {
-        vdl_for_i(vector_table->Length)
-        {
-            vdl_Free(vectors[i]->Data);
-            vdl_Free(vectors[i]);
-        }
+        vdl_VectorTableForEach(vector_table, slot) vdl_FreeVector(vectors[slot]);
     }
 
+    // Empty all the slots
+    memset(vectors, 0, (size_t) vector_table->Capacity * sizeof(VDL_VECTOR_P));
+    vector_table->Length = 0;
+
     // Deallocate unused space
     vdl_ShrinkVectorTable(vector_table);
 }
@@ -110,61 +482,36 @@ static inline void vdl_DeleteVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_tab
 
     VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
 
-    // Perform the check before deallocation to avoid partial free
-    if (free_content)
-    {
-        vdl_for_i(vector_table->Length) vdl_CheckNullPointer(vectors[i]);
-    }
-
     // Free the vectors
     if (free_content)
     {
-        vdl_for_i(vector_table->Length)
-        {
-            vdl_Free(vectors[i]->Data);
-            vdl_Free(vectors[i]);
-        }
+        vdl_VectorTableForEach(vector_table, slot) vdl_FreeVector(vectors[slot]);
     }
 
     // Free the vector table
-    vdl_Free(vector_table->Data);
-    vdl_Free(vector_table);
+    vdl_Free(vector_table->Data, VDL_SUBSYSTEM_VECTOR_TABLE);
+    vdl_Free(vector_table, VDL_SUBSYSTEM_VECTOR_TABLE);
 }
 
 static inline void vdl_ReserveForVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table, const int capacity)
 {
     vdl_CheckNullVectorAndNullContainer(vector_table);
-    vdl_Expect(capacity <= VDL_VECTOR_TABLE_MAX_CAPACITY,
+    vdl_Expect(capacity <= vdl_VectorTableMaxLoad(VDL_VECTOR_TABLE_MAX_CAPACITY),
                VDL_EXCEPTION_EXCEED_VECTOR_TABLE_LIMIT,
                "Request vector table capacity [%d] larger than the limit [%d]!",
                capacity,
-               VDL_VECTOR_TABLE_MAX_CAPACITY);
+               vdl_VectorTableMaxLoad(VDL_VECTOR_TABLE_MAX_CAPACITY));
 
     // Do nothing if there is enough space
-    if (vector_table->Capacity >= capacity)
+    if (vdl_VectorTableMaxLoad(vector_table->Capacity) >= capacity)
         return;
 
-    // Decide the new capacity
-    size_t new_capacity = (size_t) vector_table->Capacity;
-    while (new_capacity < (size_t) capacity)
-    {
-        static const size_t MEM_500KB = 500 * 1024;
-        if (new_capacity * sizeof(VDL_VECTOR_P) < MEM_500KB)
-            new_capacity = new_capacity * 2 + 8;
-        else
-            new_capacity += MEM_500KB / sizeof(VDL_VECTOR_P);
-    }
-    if (new_capacity > VDL_VECTOR_TABLE_MAX_CAPACITY)
-        new_capacity = VDL_VECTOR_TABLE_MAX_CAPACITY;
-
-    size_t target_size = new_capacity * sizeof(VDL_VECTOR_P);
+    // Double the number of slots until the load factor is under the limit
+    int new_capacity = vector_table->Capacity;
+    while (vdl_VectorTableMaxLoad(new_capacity) < capacity)
+        new_capacity *= 2;
 
-    // Attempt to reallocate memory
-    void *buffer           = vdl_Malloc(target_size, 1);
-    vector_table->Data     = buffer;
-    vector_table->Capacity = (int) new_capacity;
-
-    vdl_ExceptionDeregisterCleanUp(buffer);
+    vdl_RehashVectorTable(vector_table, new_capacity);
 }
 
 static inline size_t vdl_SizeOfVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_table)
@@ -173,10 +520,9 @@ static inline size_t vdl_SizeOfVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_t
 
     size_t memory_usage                    = 0;
     VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
-    vdl_for_i(vector_table->Length)
+    vdl_VectorTableForEach(vector_table, slot)
     {
-        vdl_CheckNullPointer(vectors[i]);
-        memory_usage += vdl_vector_primitive_SizeOfVector(vectors[i]);
+        memory_usage += vdl_vector_primitive_SizeOfVector(vectors[slot]);
     }
     return memory_usage;
 }
@@ -191,9 +537,11 @@ static inline void vdl_PrintVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_tabl
            vdl_SizeOfVectorTable(vector_table));
 
     VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
-    vdl_for_i(vector_table->Length)
+    int object_count                       = 0;
+    vdl_VectorTableForEach(vector_table, slot)
     {
-        printf("\tObject %d <%p>\n", i, (const void *) vectors[i]);
+        printf("\tObject %d <%p>\n", object_count, (const void *) vectors[slot]);
+        object_count++;
     }
     puts("");
 }
@@ -205,21 +553,17 @@ static inline int vdl_FindInVectorTable_BT(VDL_VECTOR_TABLE_T *const vector_tabl
     if (v == NULL)
         return -1;
 
-    int head    = 0;
-    int tail    = vector_table->Length - 1;
-    int current = 0;
-    while (head <= tail)
+    // Probe until the vector or an empty slot is found
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
+    const int mask                         = vector_table->Capacity - 1;
+    int slot                               = vdl_VectorTableHomeSlot(vector_table, v);
+    while (vectors[slot] != NULL)
     {
-        current = head / 2 + tail / 2 + (tail % 2 && head % 2);
-        if (vector_table->Data[current] < v)
-            head = current + 1;
-        else
-            tail = current - 1;
+        if (vectors[slot] == v)
+            return slot;
+        slot = (slot + 1) & mask;
     }
 
-    if (vector_table->Data[current] == v)
-        return current;
-
     return -1;
 }
 
@@ -235,30 +579,13 @@ static inline void vdl_VectorTableRecord_BT(VDL_VECTOR_TABLE_T *const vector_tab
     // Reserve enough space
     vdl_ReserveForVectorTable(vector_table, vdl_AddIntOverflow(vector_table->Length, 1));
 
-    // Binary search for the place to insert the vector
-    if (vector_table->Length > 0)
-    {
-        int head    = 0;
-        int tail    = vector_table->Length - 1;
-        int current = 0;
-        while (head <= tail)
-        {
-            current = head / 2 + tail / 2 + (tail % 2 && head % 2);
-            if (vector_table->Data[current] < v)
-                head = current + 1;
-            else
-                tail = current - 1;
-        }
-        void *dst       = vector_table->Data + current + 1;
-        const void *src = vector_table->Data + current;
-        size_t bytes    = (size_t) (vector_table->Length - current) * sizeof(VDL_VECTOR_P);
-        memmove(dst, src, bytes);
-        vdl_vector_primitive_UnsafeSetVectorPointer(vector_table, current, v);
-    }
-    else
-    {
-        vdl_vector_primitive_UnsafeSetVectorPointer(vector_table, 0, v);
-    }
+    // Store the vector in the first empty slot of its probe sequence
+    VDL_VECTOR_POINTER_ARRAY vectors = vector_table->Data;
+    const int mask                   = vector_table->Capacity - 1;
+    int slot                         = vdl_VectorTableHomeSlot(vector_table, v);
+    while (vectors[slot] != NULL)
+        slot = (slot + 1) & mask;
+    vectors[slot] = v;
 
     vector_table->Length++;
 }
@@ -269,43 +596,502 @@ static inline void vdl_VectorTableUntrack_BT(VDL_VECTOR_TABLE_T *const vector_ta
     vdl_CheckNullPointer(v);
 
     // Check if the vector is already recorded
-    const int index = vdl_FindInVectorTable(vector_table, v);
-    if (index == -1)
+    const int slot = vdl_FindInVectorTable(vector_table, v);
+    if (slot == -1)
         return;
 
     // Delete the vector
     if (free_content == 1)
-    {
-        vdl_Free(v->Data);
-        vdl_Free(v);
-    }
+        vdl_FreeVector(v);
 
     // Pop the vector from the table
-    if (vector_table->Length - index - 1 > 0)
+    vdl_VectorTableUnsafeRemoveSlot(vector_table, slot);
+}
+
+static inline void vdl_VectorTableUnsafeRemoveSlot(VDL_VECTOR_TABLE_T *const vector_table, const int slot)
+{
+    VDL_VECTOR_POINTER_ARRAY vectors = vector_table->Data;
+    const int mask                   = vector_table->Capacity - 1;
+
+    // Shift the following entries of the probe sequence backward to fill the hole
+    int hole = slot;
+    int next = (slot + 1) & mask;
+    while (vectors[next] != NULL)
     {
-        void *dst       = vector_table->Data + index;
-        const void *scr = vector_table->Data + index + 1;
-        size_t bytes    = (size_t) (vector_table->Length - index - 1) * sizeof(VDL_VECTOR_P);
-        memmove(dst, scr, bytes);
+        // An entry can be moved to the hole only if the hole is not before its home slot
+        const int home = vdl_VectorTableHomeSlot(vector_table, vectors[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            vectors[hole] = vectors[next];
+            hole          = next;
+        }
+        next = (next + 1) & mask;
     }
+    vectors[hole] = NULL;
+
     vector_table->Length--;
 }
 
+/*-----------------------------------------------------------------------------
+ |  Vector table iteration
+ ----------------------------------------------------------------------------*/
+
+static inline int vdl_VectorTableNextSlot(VDL_VECTOR_TABLE_T *const vector_table, int slot)
+{
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
+    while (slot < vector_table->Capacity && vectors[slot] == NULL)
+        slot++;
+    return slot;
+}
+
+static inline int vdl_VectorTableSweepOrigin(VDL_VECTOR_TABLE_T *const vector_table)
+{
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vector_table->Data;
+    int slot                               = 0;
+    while (vectors[slot] != NULL)
+        slot++;
+    return (slot + 1) & (vector_table->Capacity - 1);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Mark stack
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_ReserveForMarkStack_BT(const int capacity)
+{
+    if (vdl_GlobalVar_MarkStack.Capacity >= capacity)
+        return;
+
+    // Decide the new capacity
+    int new_capacity = vdl_GlobalVar_MarkStack.Capacity > 0 ? vdl_GlobalVar_MarkStack.Capacity : VDL_MARK_STACK_INIT_CAPACITY;
+    while (new_capacity < capacity)
+        new_capacity = vdl_MulIntOverflow(new_capacity, 2);
+
+    VDL_VECTOR_P *buffer = vdl_Malloc((size_t) new_capacity * sizeof(VDL_VECTOR_P), 1, VDL_SUBSYSTEM_STACK);
+    if (vdl_GlobalVar_MarkStack.Data != NULL)
+    {
+        memcpy(buffer, vdl_GlobalVar_MarkStack.Data, (size_t) vdl_GlobalVar_MarkStack.Length * sizeof(VDL_VECTOR_P));
+        vdl_Free(vdl_GlobalVar_MarkStack.Data, VDL_SUBSYSTEM_STACK);
+    }
+    vdl_GlobalVar_MarkStack.Data     = buffer;
+    vdl_GlobalVar_MarkStack.Capacity = new_capacity;
+
+    vdl_ExceptionDeregisterCleanUp(buffer);
+}
+
+static inline void vdl_PushToMarkStack_BT(VDL_VECTOR_T *const v)
+{
+    if (vdl_GlobalVar_MarkStack.Length == vdl_GlobalVar_MarkStack.Capacity)
+        vdl_ReserveForMarkStack(vdl_AddIntOverflow(vdl_GlobalVar_MarkStack.Length, 1));
+
+    v->Mark                                                      = vdl_GlobalVar_MarkEpoch;
+    vdl_GlobalVar_MarkStack.Data[vdl_GlobalVar_MarkStack.Length] = v;
+    vdl_GlobalVar_MarkStack.Length++;
+}
+
+static inline void vdl_GarbageCollectorMark_BT(VDL_VECTOR_T *const v)
+{
+    if (v == NULL || vdl_IsMarked(v))
+        return;
+    if (vdl_GlobalVar_MinorCollection && (v->Flag & VDL_FLAG_OLD))
+        return;
+
+    vdl_PushToMarkStack_BT(v);
+}
+
+static inline void vdl_NewMarkEpoch_BT(void)
+{
+    vdl_CheckGarbageCollector();
+
+    vdl_GlobalVar_GarbageCollectorPhase = VDL_GARBAGE_COLLECTOR_PHASE_IDLE;
+    vdl_GlobalVar_MarkStack.Length      = 0;
+    vdl_GlobalVar_MarkEpoch++;
+
+    // Marks left by the previous cycle of epochs could be mistaken for the new epoch, so reset them
+    if (vdl_GlobalVar_MarkEpoch == 0)
+    {
+        VDL_VECTOR_CONST_POINTER_ARRAY old_vectors = vdl_GlobalVar_VectorTable->Data;
+        vdl_VectorTableForEach(vdl_GlobalVar_VectorTable, slot) old_vectors[slot]->Mark = 0;
+        VDL_VECTOR_CONST_POINTER_ARRAY young_vectors = vdl_GlobalVar_Nursery->Data;
+        vdl_VectorTableForEach(vdl_GlobalVar_Nursery, slot) young_vectors[slot]->Mark = 0;
+        vdl_GlobalVar_MarkEpoch = 1;
+    }
+}
+
+static inline void vdl_GarbageCollectorMarkChildren_BT(VDL_VECTOR_T *const v)
+{
+    // Mark vector data dependencies
+    if (v->Type == VDL_TYPE_VECTOR_POINTER)
+    {
+        vdl_CheckNullPointer(v->Data);
+        VDL_VECTOR_CONST_POINTER_ARRAY children = v->Data;
+        vdl_for_i(v->Length) vdl_GarbageCollectorMark_BT(children[i]);
+    }
+
+    // Mark vector attribute dependencies
+    vdl_GarbageCollectorMark_BT(v->Attribute);
+}
+
+static inline void vdl_DrainMarkStack_BT(void)
+{
+    // Small heaps are not worth waking the thread pool
+    if (vdl_ThreadPoolThreadNum() > 1 &&
+        __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.LiveObject, __ATOMIC_RELAXED) >= VDL_PARALLEL_MARK_MIN_VECTOR_NUM)
+    {
+        vdl_ParallelDrainMarkStack();
+        return;
+    }
+
+    while (vdl_GlobalVar_MarkStack.Length > 0)
+    {
+        vdl_GlobalVar_MarkStack.Length--;
+        VDL_VECTOR_P head = vdl_GlobalVar_MarkStack.Data[vdl_GlobalVar_MarkStack.Length];
+        vdl_GarbageCollectorMarkChildren_BT(head);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ |  Root scopes
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_RootScopeBegin_BT(void)
+{
+    if (vdl_GlobalVar_RootScopes.Length == vdl_GlobalVar_RootScopes.Capacity)
+    {
+        const int new_capacity = vdl_GlobalVar_RootScopes.Capacity == 0 ? VDL_ROOT_STACK_INIT_CAPACITY : vdl_MulIntOverflow(vdl_GlobalVar_RootScopes.Capacity, 2);
+        int *buffer            = vdl_Malloc(sizeof(int) * (size_t) new_capacity, 1, VDL_SUBSYSTEM_STACK);
+        if (vdl_GlobalVar_RootScopes.Data != NULL)
+        {
+            memcpy(buffer, vdl_GlobalVar_RootScopes.Data, sizeof(int) * (size_t) vdl_GlobalVar_RootScopes.Length);
+            vdl_Free(vdl_GlobalVar_RootScopes.Data, VDL_SUBSYSTEM_STACK);
+        }
+        vdl_GlobalVar_RootScopes.Data     = buffer;
+        vdl_GlobalVar_RootScopes.Capacity = new_capacity;
+
+        vdl_ExceptionDeregisterCleanUp(buffer);
+    }
+
+    vdl_GlobalVar_RootScopes.Data[vdl_GlobalVar_RootScopes.Length] = vdl_GlobalVar_RootStack.Length;
+    vdl_GlobalVar_RootScopes.Length++;
+}
+
+static inline VDL_VECTOR_P vdl_Root_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullPointer(v);
+    vdl_Expect(vdl_GlobalVar_RootScopes.Length > 0,
+               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,
+               "No root scope to root the vector!");
+
+    if (vdl_GlobalVar_RootStack.Length == vdl_GlobalVar_RootStack.Capacity)
+    {
+        const int new_capacity = vdl_GlobalVar_RootStack.Capacity == 0 ? VDL_ROOT_STACK_INIT_CAPACITY : vdl_MulIntOverflow(vdl_GlobalVar_RootStack.Capacity, 2);
+        VDL_VECTOR_P *buffer   = vdl_Malloc(sizeof(VDL_VECTOR_P) * (size_t) new_capacity, 1, VDL_SUBSYSTEM_STACK);
+        if (vdl_GlobalVar_RootStack.Data != NULL)
+        {
+            memcpy(buffer, vdl_GlobalVar_RootStack.Data, sizeof(VDL_VECTOR_P) * (size_t) vdl_GlobalVar_RootStack.Length);
+            vdl_Free(vdl_GlobalVar_RootStack.Data, VDL_SUBSYSTEM_STACK);
+        }
+        vdl_GlobalVar_RootStack.Data     = buffer;
+        vdl_GlobalVar_RootStack.Capacity = new_capacity;
+
+        vdl_ExceptionDeregisterCleanUp(buffer);
+    }
+
+    vdl_GlobalVar_RootStack.Data[vdl_GlobalVar_RootStack.Length] = v;
+    vdl_GlobalVar_RootStack.Length++;
+
+    // A new root needs to be traced by the ongoing incremental collection
+    if (vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_MARK)
+        vdl_GarbageCollectorMark(v);
+
+    return v;
+}
+
+static inline void vdl_RootScopeEnd_BT(void)
+{
+    vdl_Expect(vdl_GlobalVar_RootScopes.Length > 0,
+               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,
+               "No root scope to end!");
+
+    vdl_GlobalVar_RootScopes.Length--;
+    vdl_GlobalVar_RootStack.Length = vdl_GlobalVar_RootScopes.Data[vdl_GlobalVar_RootScopes.Length];
+}
+
+/*-----------------------------------------------------------------------------
+ |  Parallel marking
+ ----------------------------------------------------------------------------*/
+
+static inline int vdl_MarkDequeUnsafePush(VDL_MARK_DEQUE_T *const deque, VDL_VECTOR_T *const v)
+{
+    pthread_mutex_lock(&deque->Lock);
+
+    if (deque->Bottom == deque->Capacity)
+    {
+        // Move the items to the front, and grow the buffer if it is at least half full
+        const int length = deque->Bottom - deque->Top;
+        if (length > 0)
+            memmove(deque->Data, deque->Data + deque->Top, sizeof(VDL_VECTOR_P) * (size_t) length);
+        deque->Top    = 0;
+        deque->Bottom = length;
+
+        if (length >= deque->Capacity / 2)
+        {
+            const int new_capacity = deque->Capacity == 0 ? VDL_MARK_DEQUE_INIT_CAPACITY : deque->Capacity * 2;
+            VDL_VECTOR_P *buffer   = realloc(deque->Data, sizeof(VDL_VECTOR_P) * (size_t) new_capacity);
+            if (buffer == NULL)
+            {
+                pthread_mutex_unlock(&deque->Lock);
+                return 0;
+            }
+            deque->Data     = buffer;
+            deque->Capacity = new_capacity;
+        }
+    }
+
+    deque->Data[deque->Bottom] = v;
+    deque->Bottom++;
+
+    pthread_mutex_unlock(&deque->Lock);
+    return 1;
+}
+
+static inline VDL_VECTOR_P vdl_MarkDequeUnsafePop(VDL_MARK_DEQUE_T *const deque)
+{
+    VDL_VECTOR_P v = NULL;
+
+    pthread_mutex_lock(&deque->Lock);
+    if (deque->Bottom > deque->Top)
+    {
+        deque->Bottom--;
+        v = deque->Data[deque->Bottom];
+    }
+    pthread_mutex_unlock(&deque->Lock);
+
+    return v;
+}
+
+static inline VDL_VECTOR_P vdl_MarkDequeUnsafeSteal(VDL_MARK_DEQUE_T *const deque)
+{
+    VDL_VECTOR_P v = NULL;
+
+    pthread_mutex_lock(&deque->Lock);
+    if (deque->Bottom > deque->Top)
+    {
+        v = deque->Data[deque->Top];
+        deque->Top++;
+    }
+    pthread_mutex_unlock(&deque->Lock);
+
+    return v;
+}
+
+static inline void vdl_ParallelUnsafeMark(const int id, VDL_VECTOR_T *const v)
+{
+    if (v == NULL)
+        return;
+    if (vdl_GlobalVar_MinorCollection && (v->Flag & VDL_FLAG_OLD))
+        return;
+
+    // Only the thread that changes the mark pushes the vector, so every vector is scanned once
+    const unsigned int epoch = vdl_GlobalVar_MarkEpoch;
+    if (__atomic_load_n(&v->Mark, __ATOMIC_RELAXED) == epoch ||
+        __atomic_exchange_n(&v->Mark, epoch, __ATOMIC_ACQ_REL) == epoch)
+        return;
+
+    __atomic_add_fetch(&vdl_GlobalVar_ParallelMark.Pending, 1, __ATOMIC_ACQ_REL);
+    if (!vdl_MarkDequeUnsafePush(&vdl_GlobalVar_ParallelMark.Deques[id], v))
+    {
+        __atomic_store_n(&vdl_GlobalVar_ParallelMark.Error, VDL_EXCEPTION_FAILED_ALLOCATION, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&vdl_GlobalVar_ParallelMark.Pending, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+static inline void vdl_ParallelMarkWorker(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    (void) context;
+    for (int id = (int) begin; id < (int) end; id++)
+        vdl_ParallelUnsafeMarkWorker(id);
+}
+
+static inline void vdl_ParallelUnsafeMarkWorker(const int id)
+{
+    const int thread_num = vdl_GlobalVar_ParallelMark.ThreadNum;
+
+    // The pending count drops to zero only after the last grey vector is scanned
+    while (__atomic_load_n(&vdl_GlobalVar_ParallelMark.Pending, __ATOMIC_ACQUIRE) > 0 &&
+           __atomic_load_n(&vdl_GlobalVar_ParallelMark.Error, __ATOMIC_RELAXED) == 0)
+    {
+        VDL_VECTOR_P head = vdl_MarkDequeUnsafePop(&vdl_GlobalVar_ParallelMark.Deques[id]);
+
+        // Steal from other workers if the own deque is empty
+        for (int k = 1; head == NULL && k < thread_num; k++)
+            head = vdl_MarkDequeUnsafeSteal(&vdl_GlobalVar_ParallelMark.Deques[(id + k) % thread_num]);
+
+        if (head == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        // Mark vector data dependencies
+        if (head->Type == VDL_TYPE_VECTOR_POINTER)
+        {
+            if (head->Data == NULL)
+            {
+                __atomic_store_n(&vdl_GlobalVar_ParallelMark.Error, VDL_EXCEPTION_NULL_POINTER, __ATOMIC_RELAXED);
+            }
+            else
+            {
+                VDL_VECTOR_CONST_POINTER_ARRAY children = head->Data;
+                vdl_for_i(head->Length) vdl_ParallelUnsafeMark(id, children[i]);
+            }
+        }
+
+        // Mark vector attribute dependencies
+        vdl_ParallelUnsafeMark(id, head->Attribute);
+
+        __atomic_sub_fetch(&vdl_GlobalVar_ParallelMark.Pending, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+static inline void vdl_ParallelDrainMarkStack_BT(void)
+{
+    const int thread_num                 = vdl_ThreadPoolThreadNum();
+    vdl_GlobalVar_ParallelMark.ThreadNum = thread_num;
+
+    vdl_GlobalVar_ParallelMark.Pending = vdl_GlobalVar_MarkStack.Length;
+    vdl_GlobalVar_ParallelMark.Error   = 0;
+
+    // Deal the grey vectors to the workers
+    for (int id = 0; id < thread_num; id++)
+    {
+        pthread_mutex_init(&vdl_GlobalVar_ParallelMark.Deques[id].Lock, NULL);
+        vdl_GlobalVar_ParallelMark.Deques[id].Top    = 0;
+        vdl_GlobalVar_ParallelMark.Deques[id].Bottom = 0;
+    }
+    vdl_for_i(vdl_GlobalVar_MarkStack.Length)
+    {
+        if (!vdl_MarkDequeUnsafePush(&vdl_GlobalVar_ParallelMark.Deques[i % thread_num], vdl_GlobalVar_MarkStack.Data[i]))
+            vdl_GlobalVar_ParallelMark.Error = VDL_EXCEPTION_FAILED_ALLOCATION;
+    }
+    vdl_GlobalVar_MarkStack.Length = 0;
+
+    // Every worker is a task of the thread pool. Grey vectors dealt to a worker
+    // that is not run by its own thread will be stolen by the others
+    vdl_ParallelRun(thread_num, vdl_ParallelMarkWorker, NULL);
+
+    for (int id = 0; id < thread_num; id++)
+        pthread_mutex_destroy(&vdl_GlobalVar_ParallelMark.Deques[id].Lock);
+
+    vdl_Expect(vdl_GlobalVar_ParallelMark.Error == 0,
+               vdl_GlobalVar_ParallelMark.Error,
+               "Parallel marking failed!");
+}
+
+/*-----------------------------------------------------------------------------
+ |  Telemetry
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_CountPause(const double pause_time)
+{
+    int bucket         = 0;
+    double upper_bound = 2.0;
+    while (bucket < VDL_PAUSE_HISTOGRAM_BUCKET_NUM - 1 && pause_time >= upper_bound)
+    {
+        bucket++;
+        upper_bound *= 2.0;
+    }
+    vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.PauseHistogram[bucket], 1);
+
+    double pause_max;
+    __atomic_load(&vdl_GlobalVar_GarbageCollectorCounter.PauseMax, &pause_max, __ATOMIC_RELAXED);
+    if (pause_time > pause_max)
+        __atomic_store(&vdl_GlobalVar_GarbageCollectorCounter.PauseMax, &pause_time, __ATOMIC_RELAXED);
+}
+
+static inline VDL_GARBAGE_COLLECTOR_STATS_T vdl_GarbageCollectorStats(void)
+{
+    VDL_GARBAGE_COLLECTOR_STATS_T stats = {0};
+
+    stats.LiveObject = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.LiveObject, __ATOMIC_RELAXED);
+    for (int type = 0; type < VDL_TYPE_NUM; type++)
+    {
+        stats.LiveBytes[type] = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.LiveBytes[type], __ATOMIC_RELAXED);
+        stats.TotalLiveBytes += stats.LiveBytes[type];
+    }
+    stats.BytesAllocated  = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.BytesAllocated, __ATOMIC_RELAXED);
+    stats.Collection      = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.Collection, __ATOMIC_RELAXED);
+    stats.MinorCollection = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.MinorCollection, __ATOMIC_RELAXED);
+    __atomic_load(&vdl_GlobalVar_GarbageCollectorCounter.PauseMax, &stats.PauseMax, __ATOMIC_RELAXED);
+
+    size_t histogram[VDL_PAUSE_HISTOGRAM_BUCKET_NUM];
+    for (int bucket = 0; bucket < VDL_PAUSE_HISTOGRAM_BUCKET_NUM; bucket++)
+    {
+        histogram[bucket] = __atomic_load_n(&vdl_GlobalVar_GarbageCollectorCounter.PauseHistogram[bucket], __ATOMIC_RELAXED);
+        stats.PauseCount += histogram[bucket];
+    }
+
+    // Find the buckets holding the percentiles, and report their upper bounds capped by the maximum
+    size_t cumulative  = 0;
+    double upper_bound = 2.0;
+    for (int bucket = 0; bucket < VDL_PAUSE_HISTOGRAM_BUCKET_NUM && stats.PauseCount > 0; bucket++)
+    {
+        const size_t previous = cumulative;
+        cumulative += histogram[bucket];
+        if (previous * 100 < stats.PauseCount * 50 && cumulative * 100 >= stats.PauseCount * 50)
+            stats.PauseP50 = upper_bound < stats.PauseMax ? upper_bound : stats.PauseMax;
+        if (previous * 100 < stats.PauseCount * 99 && cumulative * 100 >= stats.PauseCount * 99)
+            stats.PauseP99 = upper_bound < stats.PauseMax ? upper_bound : stats.PauseMax;
+        upper_bound *= 2.0;
+    }
+
+    return stats;
+}
+
 /*-----------------------------------------------------------------------------
  |  Garbage collector
  ----------------------------------------------------------------------------*/
 
 
+static inline void vdl_GarbageCollectorSetGrowthFactor_BT(const int growth_factor)
+{
+    vdl_GlobalVar_AutoCollection.GrowthFactor = growth_factor < 0 ? VDL_AUTO_COLLECTION_OFF : growth_factor;
+}
+
+static inline void vdl_GarbageCollectorPoll_BT(void)
+{
+    if (!vdl_GlobalVar_AutoCollection.Pending || vdl_GlobalVar_AutoCollection.CriticalDepth > 0)
+        return;
+
+    vdl_GarbageCollectorCleanUp();
+}
+
+static inline void vdl_GarbageCollectorCriticalBegin_BT(void)
+{
+    vdl_GlobalVar_AutoCollection.CriticalDepth++;
+}
+
+static inline void vdl_GarbageCollectorCriticalEnd_BT(void)
+{
+    vdl_Expect(vdl_GlobalVar_AutoCollection.CriticalDepth > 0,
+               VDL_EXCEPTION_INCONSISTENT_GARBAGE_COLLECTOR_STATE,
+               "No critical section to leave!");
+
+    vdl_GlobalVar_AutoCollection.CriticalDepth--;
+}
+
 static inline void vdl_GarbageCollectorInit_BT(void)
 {
     vdl_CheckGarbageCollector();
 
     if (vdl_GlobalVar_VectorTable == NULL)
         vdl_GlobalVar_VectorTable = vdl_NewVectorTable();
+    if (vdl_GlobalVar_Nursery == NULL)
+        vdl_GlobalVar_Nursery = vdl_NewVectorTable();
+    if (vdl_GlobalVar_RememberedSet == NULL)
+        vdl_GlobalVar_RememberedSet = vdl_NewVectorTable();
     if (vdl_GlobalVar_DirectlyReachable == NULL)
         vdl_GlobalVar_DirectlyReachable = vdl_NewVectorTable();
-    if (vdl_GlobalVar_Reachable == NULL)
-        vdl_GlobalVar_Reachable = vdl_NewVectorTable();
 }
 
 static inline void vdl_GarbageCollectorRecord_BT(VDL_VECTOR_T *const v)
@@ -314,7 +1100,45 @@ static inline void vdl_GarbageCollectorRecord_BT(VDL_VECTOR_T *const v)
     if (vdl_GlobalVar_VectorTable == NULL)
         vdl_GarbageCollectorInit();
 
-    vdl_VectorTableRecord(vdl_GlobalVar_VectorTable, v);
+    // Collect before the vector is in the nursery, so the sweep never sees it
+    if ((vdl_GlobalVar_AutoCollection.Pending || vdl_GarbageCollectorShouldCollect()) &&
+        vdl_GlobalVar_AutoCollection.CriticalDepth == 0)
+        vdl_GarbageCollectorCleanUp();
+
+    vdl_VectorTableRecord(vdl_GlobalVar_Nursery, v);
+    vdl_GlobalVar_AutoCollection.AllocatedBytes += vdl_vector_primitive_SizeOfVector(v);
+    vdl_CountAllocation(v);
+
+    // Otherwise the collection runs at the next allocation or safepoint outside critical sections
+    if (vdl_GarbageCollectorShouldCollect())
+        vdl_GlobalVar_AutoCollection.Pending = 1;
+
+    // Allocate black, so the vector survives the ongoing incremental collection
+    if (vdl_GlobalVar_GarbageCollectorPhase != VDL_GARBAGE_COLLECTOR_PHASE_IDLE)
+        v->Mark = vdl_GlobalVar_MarkEpoch;
+}
+
+static inline void vdl_GarbageCollectorRemember_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckGarbageCollector();
+    vdl_CheckNullPointer(v);
+
+    if ((v->Flag & (VDL_FLAG_OLD | VDL_FLAG_REMEMBERED)) != VDL_FLAG_OLD)
+        return;
+
+    vdl_VectorTableRecord(vdl_GlobalVar_RememberedSet, v);
+    v->Flag |= VDL_FLAG_REMEMBERED;
+}
+
+static inline void vdl_GarbageCollectorRecordWrite_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullPointer(v);
+
+    vdl_GarbageCollectorRemember(v);
+
+    // Turn a black vector grey again, so its new children will be traced
+    if (vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_MARK && vdl_IsMarked(v))
+        vdl_PushToMarkStack(v);
 }
 
 static inline void vdl_DeclareDirectlyReachable_BT(VDL_VECTOR_T *const v)
@@ -322,6 +1146,9 @@ static inline void vdl_DeclareDirectlyReachable_BT(VDL_VECTOR_T *const v)
     vdl_CheckGarbageCollector();
 
     vdl_VectorTableRecord(vdl_GlobalVar_DirectlyReachable, v);
+
+    if (vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_MARK)
+        vdl_GarbageCollectorMark(v);
 }
 
 static inline void vdl_DeclareDirectlyUnreachable_BT(VDL_VECTOR_T *const v)
@@ -331,75 +1158,265 @@ static inline void vdl_DeclareDirectlyUnreachable_BT(VDL_VECTOR_T *const v)
     vdl_VectorTableUntrack(vdl_GlobalVar_DirectlyReachable, v, 0);
 }
 
+static inline void vdl_GarbageCollectorMarkRoots_BT(void)
+{
+    VDL_VECTOR_CONST_POINTER_ARRAY roots = vdl_GlobalVar_DirectlyReachable->Data;
+    vdl_VectorTableForEach(vdl_GlobalVar_DirectlyReachable, slot) vdl_GarbageCollectorMark(roots[slot]);
+
+    vdl_for_i(vdl_GlobalVar_RootStack.Length) vdl_GarbageCollectorMark(vdl_GlobalVar_RootStack.Data[i]);
+}
+
 static inline void vdl_UpdateReachable_BT(void)
 {
     vdl_CheckGarbageCollector();
 
-    vdl_ClearVectorTable_BT(vdl_GlobalVar_Reachable, 0);
+    vdl_NewMarkEpoch();
+    vdl_GlobalVar_MinorCollection = 0;
 
-    if (vdl_GlobalVar_DirectlyReachable->Length == 0)
-        return;
+    // Mark all the directly reachable objects.
+    vdl_GarbageCollectorMarkRoots();
+
+    // Use DFS to mark all reachable objects.
+    vdl_DrainMarkStack();
+}
+
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorSweepNursery_BT(void)
+{
+    vdl_CheckGarbageCollector();
 
-    // Ensure no null pointers in directly reachable vector table.
-    vdl_for_i(vdl_GlobalVar_DirectlyReachable->Length)
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = {0};
+
+    // Every young vector either dies or gets promoted, so the nursery is emptied at once afterwards
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vdl_GlobalVar_Nursery->Data;
+    vdl_VectorTableForEach(vdl_GlobalVar_Nursery, slot)
     {
-        vdl_CheckNullPointer(vdl_GlobalVar_DirectlyReachable->Data[i]);
+        VDL_VECTOR_P v = vectors[slot];
+        if (vdl_IsMarked(v))
+        {
+            result.ObjectPromoted++;
+            result.BytesSurvived += vdl_vector_primitive_SizeOfVector(v);
+            vdl_VectorTableRecord(vdl_GlobalVar_VectorTable, v);
+            v->Flag |= VDL_FLAG_OLD;
+        }
+        else
+        {
+            result.ObjectFreed++;
+            result.BytesFreed += vdl_vector_primitive_SizeOfVector(v);
+            vdl_FreeVector_BT(v);
+        }
     }
+    vdl_ClearVectorTable(vdl_GlobalVar_Nursery, 0);
+    vdl_ClearRememberedSet();
 
-    // Copy all the directly reachable objects to reachable table.
-    vdl_ReserveForVectorTable(vdl_GlobalVar_Reachable, vdl_GlobalVar_DirectlyReachable->Length);
-    memcpy(vdl_GlobalVar_Reachable->Data,
-           vdl_GlobalVar_DirectlyReachable->Data,
-           (size_t) vdl_GlobalVar_DirectlyReachable->Length * sizeof(VDL_VECTOR_P));
-    vdl_GlobalVar_Reachable->Length = vdl_GlobalVar_DirectlyReachable->Length;
+    return result;
+}
+
+static inline void vdl_ClearRememberedSet_BT(void)
+{
+    vdl_CheckGarbageCollector();
 
-    // Use BFS to find all reachable objects.
-    int head_index = 0;
-    int tail_index = vdl_GlobalVar_DirectlyReachable->Length - 1;
-    while (head_index <= tail_index)
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vdl_GlobalVar_RememberedSet->Data;
+    vdl_VectorTableForEach(vdl_GlobalVar_RememberedSet, slot) vectors[slot]->Flag &= ~VDL_FLAG_REMEMBERED;
+    vdl_ClearVectorTable(vdl_GlobalVar_RememberedSet, 0);
+}
+
+static inline int vdl_SweepOldGeneration_BT(const int origin, int position, const int budget, VDL_GARBAGE_COLLECTOR_RESULT_T *const result)
+{
+    vdl_CheckGarbageCollector();
+    vdl_CheckNullPointer(result);
+
+    // Free the unmarked vectors and remove them from the table in one pass.
+    // The current slot is visited again after a removal since the removal shifts entries backward.
+    // The slot before the origin is empty and stays empty, so no entry is shifted across the origin
+    VDL_VECTOR_CONST_POINTER_ARRAY vectors = vdl_GlobalVar_VectorTable->Data;
+    const int mask                         = vdl_GlobalVar_VectorTable->Capacity - 1;
+    int visited                            = 0;
+    while (position < vdl_GlobalVar_VectorTable->Capacity && visited < budget)
     {
-        VDL_VECTOR_P head = vdl_GlobalVar_Reachable->Data[head_index];
+        const int slot = (origin + position) & mask;
+        VDL_VECTOR_P v = vectors[slot];
+        if (v == NULL)
+        {
+            position++;
+            continue;
+        }
 
-        // Check vector data dependencies
-        if (head->Type == VDL_TYPE_VECTOR_POINTER)
+        visited++;
+        if (!vdl_IsMarked(v))
         {
-            vdl_CheckNullPointer(head->Data);
-            VDL_VECTOR_POINTER_ARRAY vectors = head->Data;
-            vdl_for_i(head->Length)
-            {
-                // Null pointers should not be recorded by the reachable table.
-                if (vectors[i] != NULL)
-                    vdl_VectorTableRecord(vdl_GlobalVar_Reachable, vectors[i]);
-            }
+            result->ObjectFreed++;
+            result->BytesFreed += vdl_vector_primitive_SizeOfVector(v);
+            vdl_VectorTableUnsafeRemoveSlot(vdl_GlobalVar_VectorTable, slot);
+            if (v->Flag & VDL_FLAG_REMEMBERED)
+                vdl_VectorTableUntrack(vdl_GlobalVar_RememberedSet, v, 0);
+            vdl_FreeVector_BT(v);
+        }
+        else
+        {
+            result->BytesSurvived += vdl_vector_primitive_SizeOfVector(v);
+            position++;
         }
+    }
 
-        // Check vector attribute dependencies
-        if (head->Attribute != NULL)
-            vdl_VectorTableRecord(vdl_GlobalVar_Reachable, head->Attribute);
+    return position;
+}
 
-        // Update the tail index and the head index
-        tail_index = vdl_GlobalVar_Reachable->Length - 1;
-        head_index++;
-    }
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorSweep_BT(void)
+{
+    vdl_CheckGarbageCollector();
+
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = {0};
+
+    vdl_SweepOldGeneration(vdl_VectorTableSweepOrigin(vdl_GlobalVar_VectorTable), 0, INT_MAX, &result);
+    vdl_ShrinkVectorTable(vdl_GlobalVar_VectorTable);
+
+    // The young generation is swept after the old one, so promoted vectors are not visited twice
+    VDL_GARBAGE_COLLECTOR_RESULT_T young_result = vdl_GarbageCollectorSweepNursery();
+    result.ObjectFreed += young_result.ObjectFreed;
+    result.ObjectPromoted += young_result.ObjectPromoted;
+    result.BytesFreed += young_result.BytesFreed;
+    result.BytesSurvived += young_result.BytesSurvived;
+
+    return result;
 }
 
-static inline void vdl_GarbageCollectorCleanUp_BT(void)
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorStep_BT(const int object_budget, const double time_budget)
 {
     vdl_CheckGarbageCollector();
+    if (vdl_GlobalVar_VectorTable == NULL)
+        vdl_GarbageCollectorInit();
 
-    vdl_UpdateReachable();
+    const double start_time               = vdl_TimeInMicroseconds();
+    int remaining                         = object_budget > 0 ? object_budget : INT_MAX;
+    int iteration                         = 0;
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = {0};
+
+    // Start a new collection by marking the roots grey
+    if (vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_IDLE)
+    {
+        vdl_NewMarkEpoch();
+        vdl_GlobalVar_MinorCollection = 0;
+
+        vdl_GarbageCollectorMarkRoots();
 
-    int head_index                   = 0;
-    VDL_VECTOR_POINTER_ARRAY vectors = vdl_GlobalVar_VectorTable->Data;
-    vdl_for_i(vdl_GlobalVar_VectorTable->Length)
+        vdl_GlobalVar_GarbageCollectorPhase        = VDL_GARBAGE_COLLECTOR_PHASE_MARK;
+        vdl_GlobalVar_AutoCollection.SurvivedBytes = 0;
+    }
+
+    // The clock is read once every few iterations to keep the overhead low
+    while (remaining > 0 && !result.Completed)
     {
-        if (vdl_FindInVectorTable(vdl_GlobalVar_Reachable, vectors[i]) != -1)
+        if (time_budget > 0.0 && iteration % 64 == 63 && vdl_TimeInMicroseconds() - start_time >= time_budget)
+            break;
+        iteration++;
+
+        if (vdl_GlobalVar_GarbageCollectorPhase == VDL_GARBAGE_COLLECTOR_PHASE_MARK)
+        {
+            if (vdl_GlobalVar_MarkStack.Length > 0)
+            {
+                vdl_GlobalVar_MarkStack.Length--;
+                vdl_GarbageCollectorMarkChildren(vdl_GlobalVar_MarkStack.Data[vdl_GlobalVar_MarkStack.Length]);
+                remaining--;
+            }
+            else
+            {
+                vdl_GlobalVar_GarbageCollectorPhase = VDL_GARBAGE_COLLECTOR_PHASE_SWEEP;
+                vdl_GlobalVar_SweepOrigin           = vdl_VectorTableSweepOrigin(vdl_GlobalVar_VectorTable);
+                vdl_GlobalVar_SweepSlot             = 0;
+            }
+        }
+        else
         {
-            vectors[head_index] = vectors[i];
-            head_index++;
+            const int budget        = remaining < 64 ? remaining : 64;
+            vdl_GlobalVar_SweepSlot = vdl_SweepOldGeneration(vdl_GlobalVar_SweepOrigin, vdl_GlobalVar_SweepSlot, budget, &result);
+            remaining -= budget;
+
+            // Finish the collection
+            if (vdl_GlobalVar_SweepSlot >= vdl_GlobalVar_VectorTable->Capacity)
+            {
+                vdl_ShrinkVectorTable(vdl_GlobalVar_VectorTable);
+
+                VDL_GARBAGE_COLLECTOR_RESULT_T young_result = vdl_GarbageCollectorSweepNursery();
+                result.ObjectFreed += young_result.ObjectFreed;
+                result.ObjectPromoted += young_result.ObjectPromoted;
+                result.BytesFreed += young_result.BytesFreed;
+                result.BytesSurvived += young_result.BytesSurvived;
+
+                vdl_GlobalVar_GarbageCollectorPhase = VDL_GARBAGE_COLLECTOR_PHASE_IDLE;
+                result.Completed                    = 1;
+            }
         }
     }
-    vdl_GlobalVar_VectorTable->Length = head_index;
+
+    // Restart the allocation count of the automatic collection when the cycle is completed
+    vdl_GlobalVar_AutoCollection.SurvivedBytes += result.BytesSurvived;
+    if (result.Completed)
+    {
+        vdl_GlobalVar_AutoCollection.LiveBytes      = vdl_GlobalVar_AutoCollection.SurvivedBytes;
+        vdl_GlobalVar_AutoCollection.AllocatedBytes = 0;
+        vdl_GlobalVar_AutoCollection.Pending        = 0;
+        vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.Collection, 1);
+    }
+
+    result.PauseTime = vdl_TimeInMicroseconds() - start_time;
+    vdl_CountPause(result.PauseTime);
+    return result;
+}
+
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorMinorCleanUp_BT(void)
+{
+    vdl_CheckGarbageCollector();
+
+    const double start_time = vdl_TimeInMicroseconds();
+
+    vdl_NewMarkEpoch();
+    vdl_GlobalVar_MinorCollection = 1;
+
+    // Mark the young vectors that are directly reachable.
+    vdl_GarbageCollectorMarkRoots();
+
+    // Mark the young vectors referred by the old generation.
+    VDL_VECTOR_CONST_POINTER_ARRAY remembered = vdl_GlobalVar_RememberedSet->Data;
+    vdl_VectorTableForEach(vdl_GlobalVar_RememberedSet, slot) vdl_GarbageCollectorMarkChildren(remembered[slot]);
+
+    vdl_DrainMarkStack();
+    vdl_GlobalVar_MinorCollection = 0;
+
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorSweepNursery();
+
+    // Promoted bytes become live, and freed bytes no longer count towards the next automatic collection
+    const size_t young_bytes = result.BytesFreed + result.BytesSurvived;
+    vdl_GlobalVar_AutoCollection.LiveBytes += result.BytesSurvived;
+    if (vdl_GlobalVar_AutoCollection.AllocatedBytes > young_bytes)
+        vdl_GlobalVar_AutoCollection.AllocatedBytes -= young_bytes;
+    else
+        vdl_GlobalVar_AutoCollection.AllocatedBytes = 0;
+    vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.MinorCollection, 1);
+
+    result.PauseTime = vdl_TimeInMicroseconds() - start_time;
+    result.Completed = 1;
+    vdl_CountPause(result.PauseTime);
+    return result;
+}
+
+static inline VDL_GARBAGE_COLLECTOR_RESULT_T vdl_GarbageCollectorCleanUp_BT(void)
+{
+    vdl_CheckGarbageCollector();
+
+    const double start_time = vdl_TimeInMicroseconds();
+
+    vdl_UpdateReachable();
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorSweep();
+
+    vdl_GlobalVar_AutoCollection.LiveBytes      = result.BytesSurvived;
+    vdl_GlobalVar_AutoCollection.AllocatedBytes = 0;
+    vdl_GlobalVar_AutoCollection.Pending        = 0;
+    vdl_CounterAdd(vdl_GlobalVar_GarbageCollectorCounter.Collection, 1);
+
+    result.PauseTime = vdl_TimeInMicroseconds() - start_time;
+    result.Completed = 1;
+    vdl_CountPause(result.PauseTime);
+    return result;
 }
 
 static inline void vdl_GarbageCollectorKill_BT(void)
@@ -409,11 +1426,44 @@ static inline void vdl_GarbageCollectorKill_BT(void)
     vdl_DeleteVectorTable(vdl_GlobalVar_VectorTable, 1);
     vdl_GlobalVar_VectorTable = NULL;
 
-    vdl_DeleteVectorTable(vdl_GlobalVar_Reachable, 0);
-    vdl_GlobalVar_Reachable = NULL;
+    vdl_DeleteVectorTable(vdl_GlobalVar_Nursery, 1);
+    vdl_GlobalVar_Nursery = NULL;
+
+    vdl_DeleteVectorTable(vdl_GlobalVar_RememberedSet, 0);
+    vdl_GlobalVar_RememberedSet = NULL;
 
     vdl_DeleteVectorTable(vdl_GlobalVar_DirectlyReachable, 0);
     vdl_GlobalVar_DirectlyReachable = NULL;
+
+    vdl_GlobalVar_GarbageCollectorPhase         = VDL_GARBAGE_COLLECTOR_PHASE_IDLE;
+    vdl_GlobalVar_AutoCollection.LiveBytes      = 0;
+    vdl_GlobalVar_AutoCollection.AllocatedBytes = 0;
+    vdl_GlobalVar_AutoCollection.Pending        = 0;
+
+    for (int id = 0; id < VDL_THREAD_POOL_MAX_THREAD_NUM; id++)
+    {
+        free(vdl_GlobalVar_ParallelMark.Deques[id].Data);
+        vdl_GlobalVar_ParallelMark.Deques[id].Data     = NULL;
+        vdl_GlobalVar_ParallelMark.Deques[id].Capacity = 0;
+    }
+
+    vdl_Free(vdl_GlobalVar_RootStack.Data, VDL_SUBSYSTEM_STACK);
+    vdl_GlobalVar_RootStack.Data     = NULL;
+    vdl_GlobalVar_RootStack.Capacity = 0;
+    vdl_GlobalVar_RootStack.Length   = 0;
+
+    vdl_Free(vdl_GlobalVar_RootScopes.Data, VDL_SUBSYSTEM_STACK);
+    vdl_GlobalVar_RootScopes.Data     = NULL;
+    vdl_GlobalVar_RootScopes.Capacity = 0;
+    vdl_GlobalVar_RootScopes.Length   = 0;
+
+    vdl_Free(vdl_GlobalVar_MarkStack.Data, VDL_SUBSYSTEM_STACK);
+    vdl_GlobalVar_MarkStack.Data     = NULL;
+    vdl_GlobalVar_MarkStack.Capacity = 0;
+    vdl_GlobalVar_MarkStack.Length   = 0;
+
+    vdl_MemoryPoolRelease();
+    vdl_ThreadPoolShutdown();
 }
 
 #endif//VDL_VDL_6_GARBAGE_COLLECTOR_DEF_H
@@ -10,10 +10,10 @@
  |  Vector memory checks
  ----------------------------------------------------------------------------*/
 
-#define vdl_CheckRequestedCapacity(capacity) vdl_Expect((capacity) > 0 && (capacity) < VDL_VECTOR_MAX_CAPACITY, \
-                                                        VDL_EXCEPTION_EXCEED_VECTOR_CAPACITY_LIMIT,             \
-                                                        "The requested capacity [%d] is not in (0, %d]!",       \
-                                                        capacity, VDL_VECTOR_MAX_CAPACITY)
+#define vdl_CheckRequestedCapacity(capacity) vdl_Expect((capacity) > 0 && (capacity) < VDL_VECTOR_MAX_CAPACITY,                               \
+                                                        VDL_EXCEPTION_EXCEED_VECTOR_CAPACITY_LIMIT,                                           \
+                                                        "The requested capacity [" VDL_INDEX_FORMAT "] is not in (0, " VDL_INDEX_FORMAT "]!", \
+                                                        (VDL_INDEX_T) (capacity), (VDL_INDEX_T) VDL_VECTOR_MAX_CAPACITY)
 
 /*-----------------------------------------------------------------------------
  |  Allocate vector on stack
@@ -27,7 +27,10 @@
         .Class     = VDL_CLASS_VECTOR,              \
         .Capacity  = vdl_CountArg(__VA_ARGS__),     \
         .Length    = vdl_CountArg(__VA_ARGS__),     \
+        .Mark      = 0,                             \
+        .Flag      = 0,                             \
         .Attribute = NULL,                          \
+        .Buffer    = NULL,                          \
         .Data      = (T[vdl_CountArg(__VA_ARGS__)]) \
         {                                           \
             __VA_ARGS__                             \
@@ -37,6 +40,7 @@
 #define vdl_LocalCharVector(...) vdl_T_LocalVector(char, VDL_TYPE_CHAR, __VA_ARGS__)
 #define vdl_LocalIntVector(...) vdl_T_LocalVector(int, VDL_TYPE_INT, __VA_ARGS__)
 #define vdl_LocalDoubleVector(...) vdl_T_LocalVector(double, VDL_TYPE_DOUBLE, __VA_ARGS__)
+#define vdl_LocalIndexVector(...) vdl_T_LocalVector(VDL_INDEX_T, VDL_TYPE_INDEX, __VA_ARGS__)
 
 /// Allocate a local vector on stack.
 /// @details A vector allocated on stack will be deallocated at the end of its lifetime,
@@ -65,12 +69,48 @@
  |  Construct empty vector on heap
  ----------------------------------------------------------------------------*/
 
+/// Byte used to poison the data of vectors constructed without initialization.
+/// @details Only used when `VDL_POISON_UNINITIALIZED` is defined.
+#define VDL_UNINITIALIZED_POISON_BYTE 0xA5
+
+/// New a vector on heap and record it by the garbage collector.
+/// @details The vector will not be allocated from the arena even if an arena is active.
+/// @param type (VDL_TYPE_T). Vector type.
+/// @param capacity (VDL_INDEX_T). Capacity.
+/// @param zero_data (int). Whether to fill the data container with 0.
+/// @param attribute (int). Whether the vector is an attribute. The vector struct of an attribute
+/// is allocated as `VDL_SUBSYSTEM_ATTRIBUTE`.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewOnHeap(...) vdl_CallFunction(vdl_vector_primitive_NewOnHeap_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewOnHeap_BT(VDL_TYPE_T type, VDL_INDEX_T capacity, int zero_data, int attribute);
+
+/// New an empty vector on heap and record it by the garbage collector.
+/// @details Unlike `vdl_vector_primitive_NewEmpty`, the vector will not be allocated
+/// from the arena even if an arena is active.
+/// @param type (VDL_TYPE_T). Vector type.
+/// @param capacity (VDL_INDEX_T). Capacity.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewEmptyOnHeap(...) vdl_CallFunction(vdl_vector_primitive_NewEmptyOnHeap_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewEmptyOnHeap_BT(VDL_TYPE_T type, VDL_INDEX_T capacity);
+
 /// New an empty dynamically allocated vector.
+/// @details The vector will be allocated from the arena if an arena is active.
 /// @param type (VDL_TYPE_T). Vector type.
-/// @param capacity (int). Capacity.
+/// @param capacity (VDL_INDEX_T). Capacity.
 /// @return (VDL_VECTOR_P) A vector.
 #define vdl_vector_primitive_NewEmpty(...) vdl_CallFunction(vdl_vector_primitive_NewEmpty_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewEmpty_BT(VDL_TYPE_T type, int capacity);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewEmpty_BT(VDL_TYPE_T type, VDL_INDEX_T capacity);
+
+/// New an empty dynamically allocated vector without initializing the data container.
+/// @details This is intended for constructors that overwrite the data right away, as it
+/// skips the zeroing pass of `vdl_vector_primitive_NewEmpty`. Elements that are not written
+/// have indeterminate values, and will be filled with `VDL_UNINITIALIZED_POISON_BYTE`
+/// if `VDL_POISON_UNINITIALIZED` is defined. Vectors allocated from an arena are always zeroed.
+/// @param type (VDL_TYPE_T). Vector type.
+/// @param capacity (VDL_INDEX_T). Capacity.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewUninit(...) vdl_CallFunction(vdl_vector_primitive_NewUninit_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewUninit_BT(VDL_TYPE_T type, VDL_INDEX_T capacity);
 
 /// New an empty dynamically allocated vector.
 /// @param type (VDL_TYPE_P). Vector type.
@@ -85,31 +125,38 @@ static inline VDL_VECTOR_P vdl_vector_NewEmpty_BT(VDL_VECTOR_P type, VDL_VECTOR_
 
 /// New and initialize a dynamically allocated vector by a scalar.
 /// @param item (char). The item.
-/// @param length (int). Length of the vector.
+/// @param length (VDL_INDEX_T). Length of the vector.
 /// @return (VDL_VECTOR_P) A vector.
 #define vdl_vector_primitive_NewByChar(...) vdl_CallFunction(vdl_vector_primitive_NewByChar_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByChar_BT(char item, int length);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByChar_BT(char item, VDL_INDEX_T length);
 
 /// New and initialize a dynamically allocated vector by a scalar.
 /// @param item (int). The item.
-/// @param length (int). Length of the vector.
-/// @return (VDL_VECTOR_P) A vector of length one.
+/// @param length (VDL_INDEX_T). Length of the vector.
+/// @return (VDL_VECTOR_P) A vector.
 #define vdl_vector_primitive_NewByInt(...) vdl_CallFunction(vdl_vector_primitive_NewByInt_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByInt_BT(int item, int length);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByInt_BT(int item, VDL_INDEX_T length);
 
 /// New and initialize a dynamically allocated vector by a scalar.
 /// @param item (double). The item.
-/// @param length (int). Length of the vector.
+/// @param length (VDL_INDEX_T). Length of the vector.
 /// @return (VDL_VECTOR_P) A vector.
 #define vdl_vector_primitive_NewByDouble(...) vdl_CallFunction(vdl_vector_primitive_NewByDouble_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByDouble_BT(double item, int length);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByDouble_BT(double item, VDL_INDEX_T length);
 
 /// New and initialize a dynamically allocated vector by a scalar.
 /// @param item (VDL_VECTOR_P). The item.
-/// @param length (int). Length of the vector.
+/// @param length (VDL_INDEX_T). Length of the vector.
 /// @return (VDL_VECTOR_P) A vector.
 #define vdl_vector_primitive_NewByVectorPointer(...) vdl_CallFunction(vdl_vector_primitive_NewByVectorPointer_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByVectorPointer_BT(VDL_VECTOR_P item, int length);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByVectorPointer_BT(VDL_VECTOR_P item, VDL_INDEX_T length);
+
+/// New and initialize a dynamically allocated vector by a scalar.
+/// @param item (VDL_INDEX_T). The item.
+/// @param length (VDL_INDEX_T). Length of the vector.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewByIndex(...) vdl_CallFunction(vdl_vector_primitive_NewByIndex_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByIndex_BT(VDL_INDEX_T item, VDL_INDEX_T length);
 
 /*-----------------------------------------------------------------------------
  |  Construct vector on heap with an array
@@ -117,15 +164,15 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByVectorPointer_BT(VDL_VECTOR
 
 /// New and initialize a dynamically allocated vector.
 /// @param type (VDL_TYPE_T). Vector type.
-/// @param capacity (int). Capacity.
+/// @param capacity (VDL_INDEX_T). Capacity.
 /// @param item_pointer (const void *). Pointer to items.
-/// @param number (int). Number of items.
+/// @param number (VDL_INDEX_T). Number of items.
 #define vdl_vector_primitive_NewByArray(...) vdl_CallFunction(vdl_vector_primitive_NewByArray_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(VDL_TYPE_T type, int capacity, const void *item_pointer, int number);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(VDL_TYPE_T type, VDL_INDEX_T capacity, const void *item_pointer, VDL_INDEX_T number);
 
 /// New and initialize a dynamically allocated vector.
 /// @param string (const char *). Pointer to a string.
-/// @param length (int). Length of the string.
+/// @param length (VDL_INDEX_T). Length of the string.
 #define vdl_vector_primitive_NewByCharArray(string, length) vdl_vector_primitive_NewByArray(VDL_TYPE_CHAR, length, string, length);
 
 /// New and initialize a dynamically allocated vector.
@@ -138,10 +185,11 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(VDL_TYPE_T type, i
 
 /// New and initialize a dynamically allocated vector by variadic arguments.
 /// @param type (VDL_TYPE_T). Vector type.
-/// @param length (int). Length of the vector.
-/// @param ... (char/int/double/VDL_VECTOR_P). A series of items of the same type.
+/// @param length (VDL_INDEX_T). Length of the vector.
+/// @param ... (char/int/double/VDL_VECTOR_P/VDL_INDEX_T). A series of items of the same type.
+/// Items of an index vector need to be of type VDL_INDEX_T.
 #define vdl_vector_primitive_NewByVariadic(...) vdl_CallFunction(vdl_vector_primitive_NewByVariadic_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(VDL_TYPE_T type, int length, ...);
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(VDL_TYPE_T type, VDL_INDEX_T length, ...);
 
 /// New and initialize a vector on heap and record it by the garbage collector.
 /// @details Allocate a vector on heap is more expensive than allocate it on stack
@@ -167,10 +215,12 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(VDL_TYPE_T type
 
 /// Reserve space for a vector.
 /// @details The function may allocate more memory than requested.
+/// A vector sharing its data buffer always gets a private data container, since the
+/// caller is about to modify it.
 /// @param v (VDL_VECTOR_P). A vector.
-/// @param capacity (int). Requested capacity.
+/// @param capacity (VDL_INDEX_T). Requested capacity.
 #define vdl_vector_primitive_Reserve(...) vdl_CallVoidFunction(vdl_vector_primitive_Reserve_BT, __VA_ARGS__)
-static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_P v, int capacity);
+static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_P v, VDL_INDEX_T capacity);
 
 /// Reserve space for a vector.
 /// @details The function may allocate more memory than requested.
@@ -179,4 +229,276 @@ static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_P v, int capacity)
 #define vdl_vector_Reserve(...) vdl_CallVoidFunction(vdl_vector_Reserve_BT, __VA_ARGS__)
 static inline void vdl_vector_Reserve_BT(VDL_VECTOR_P v, VDL_VECTOR_P capacity);
 
+/*-----------------------------------------------------------------------------
+ |  Arena
+ ----------------------------------------------------------------------------*/
+
+/// Size of an arena chunk.
+/// @details Larger requests get a dedicated chunk of the requested size.
+#define VDL_ARENA_CHUNK_SIZE ((size_t) 1024 * 1024)
+
+/// Maximum depth of nested arenas.
+#define VDL_ARENA_MAX_DEPTH 64
+
+/// Alignment of memory allocated from an arena.
+#define VDL_ARENA_ALIGNMENT VDL_DATA_ALIGNMENT
+
+/// An arena chunk.
+/// @param Previous (struct VDL_ARENA_CHUNK_T *). The chunk allocated before this one.
+typedef struct VDL_ARENA_CHUNK_T
+{
+    struct VDL_ARENA_CHUNK_T *Previous;
+} VDL_ARENA_CHUNK_T;
+
+/// Allocation position of the arena.
+/// @param Chunk (VDL_ARENA_CHUNK_T *). The latest chunk.
+/// @param Cursor (char *). Next unused byte of the latest chunk.
+/// @param End (char *). End of the latest chunk.
+typedef struct VDL_ARENA_POSITION_T
+{
+    VDL_ARENA_CHUNK_T *Chunk;
+    char *Cursor;
+    char *End;
+} VDL_ARENA_POSITION_T;
+
+/// A global variable for storing the arena.
+/// @param Depth (int). Number of active arenas.
+/// @param Current (VDL_ARENA_POSITION_T). Current allocation position.
+/// @param Saved (VDL_ARENA_POSITION_T[VDL_ARENA_MAX_DEPTH]). Allocation positions when the active arenas began.
+static struct
+{
+    int Depth;
+    VDL_ARENA_POSITION_T Current;
+    VDL_ARENA_POSITION_T Saved[VDL_ARENA_MAX_DEPTH];
+} vdl_GlobalVar_Arena = {0};
+
+/// Begin an arena.
+/// @details Until the matching `vdl_ArenaEnd`, vectors created by `vdl_vector_primitive_NewEmpty`
+/// and their data containers are bump allocated from large chunks. They are not recorded by
+/// the garbage collector, and will all be freed by `vdl_ArenaEnd`. \n\n
+/// Arenas can be nested. A vector can only grow while its own arena is the latest one, since
+/// the memory of an outer arena is not available until the inner arenas end. \n\n
+/// Arena vectors do not keep heap vectors alive, and they must not be referenced by
+/// heap vectors or roots after the arena ends. Use `vdl_ArenaEscape` to keep a result.
+#define vdl_ArenaBegin(...) vdl_CallVoidFunction(vdl_ArenaBegin_BT, __VA_ARGS__)
+static inline void vdl_ArenaBegin_BT(void);
+
+/// End the latest arena and free all the memory allocated from it.
+/// @details The cost is proportional to the number of chunks. The arenas begun in a `vdl_Try`
+/// block are ended when the exception is caught by the matching `vdl_Catch`.
+#define vdl_ArenaEnd(...) vdl_CallVoidFunction(vdl_ArenaEnd_BT, __VA_ARGS__)
+static inline void vdl_ArenaEnd_BT(void);
+
+/// End the arenas until the given number of arenas are active. No checks will be performed.
+/// @param depth (int). Number of arenas to keep.
+static inline void vdl_ArenaUnsafeUnwind(int depth);
+
+// The arena depth is saved before a try, and the arenas begun inside the try are ended if an
+// exception is thrown, such that later allocations are not taken from an abandoned arena.
+#define VDL_ARENA_HOOK_START_TRY const int vdl_ArenaDepthBeforeTry = vdl_GlobalVar_Arena.Depth
+
+#define VDL_ARENA_HOOK_START_CATCH vdl_ArenaUnsafeUnwind(vdl_ArenaDepthBeforeTry)
+
+#ifdef VDL_EXCEPTION_HOOK_START_TRY
+    #undef VDL_EXCEPTION_HOOK_START_TRY
+#endif//VDL_EXCEPTION_HOOK_START_TRY
+#define VDL_EXCEPTION_HOOK_START_TRY                \
+    VDL_GARBAGE_COLLECTOR_HOOK_START_TRY;           \
+    VDL_ARENA_HOOK_START_TRY
+
+#ifdef VDL_EXCEPTION_HOOK_START_CATCH
+    #undef VDL_EXCEPTION_HOOK_START_CATCH
+#endif//VDL_EXCEPTION_HOOK_START_CATCH
+#define VDL_EXCEPTION_HOOK_START_CATCH              \
+    do {                                            \
+        VDL_GARBAGE_COLLECTOR_HOOK_START_CATCH;     \
+        VDL_ARENA_HOOK_START_CATCH;                 \
+    } while (0)
+
+/// Allocate zero-initialized memory from the latest arena.
+/// @param bytes (size_t). Number of bytes.
+/// @return (void *) The memory.
+#define vdl_ArenaAlloc(...) vdl_CallFunction(vdl_ArenaAlloc_BT, void *, __VA_ARGS__)
+static inline void *vdl_ArenaAlloc_BT(size_t bytes);
+
+/// Get the depth of the arena that owns an arena vector.
+/// @param v (VDL_VECTOR_P). An arena vector.
+/// @return (int) The depth.
+#define vdl_ArenaDepthOf(v) ((int) ((v)->Flag >> VDL_FLAG_ARENA_DEPTH_SHIFT))
+
+/// New an empty vector in the latest arena.
+/// @param type (VDL_TYPE_T). Vector type.
+/// @param capacity (VDL_INDEX_T). Capacity.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_ArenaNewEmpty(...) vdl_CallFunction(vdl_ArenaNewEmpty_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ArenaNewEmpty_BT(VDL_TYPE_T type, VDL_INDEX_T capacity);
+
+/// Initial capacity of the escape map.
+#define VDL_ARENA_ESCAPE_MAP_INIT_CAPACITY 16
+
+/// Arena vectors and their heap copies.
+/// @details The pairs are stored in an open-addressing hash map with linear probing, keyed by the
+/// arena vectors like a vector table. Heap copies whose references still point to arena vectors
+/// wait in a work stack, so no recursion is needed to follow long chains of references.
+/// @param Capacity (int). Number of slots. Always a power of two.
+/// @param Length (int). Number of pairs.
+/// @param Data (VDL_VECTOR_P *). Slots. An arena vector at an even position is followed by its heap copy.
+/// @param PendingCapacity (int). Capacity of the work stack.
+/// @param PendingLength (int). Number of heap copies in the work stack.
+/// @param Pending (VDL_VECTOR_P *). The work stack.
+typedef struct VDL_ARENA_ESCAPE_MAP_T
+{
+    int Capacity;
+    int Length;
+    VDL_VECTOR_P *Data;
+    int PendingCapacity;
+    int PendingLength;
+    VDL_VECTOR_P *Pending;
+} VDL_ARENA_ESCAPE_MAP_T;
+
+/// Double the number of slots of an escape map.
+/// @param map (VDL_ARENA_ESCAPE_MAP_T *). An escape map.
+#define vdl_ArenaEscapeMapGrow(...) vdl_CallVoidFunction(vdl_ArenaEscapeMapGrow_BT, __VA_ARGS__)
+static inline void vdl_ArenaEscapeMapGrow_BT(VDL_ARENA_ESCAPE_MAP_T *map);
+
+/// Get the heap copy of an arena vector.
+/// @details The vector is copied onto the heap if it has not been copied yet. The references of
+/// a new copy still point to arena vectors, and the copy is pushed to the work stack.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param map (VDL_ARENA_ESCAPE_MAP_T *). Vectors copied so far.
+/// @return (VDL_VECTOR_P) The heap copy, or the vector itself if it is not an arena vector.
+#define vdl_ArenaEscapeForward(...) vdl_CallFunction(vdl_ArenaEscapeForward_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ArenaEscapeForward_BT(VDL_VECTOR_P v, VDL_ARENA_ESCAPE_MAP_T *map);
+
+/// Promote an arena vector to the heap managed by the garbage collector.
+/// @details Arena vectors referred by the vector, directly or through attributes, are promoted
+/// as well. Shared and cyclic references are preserved. Other vectors are returned as is.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (VDL_VECTOR_P) A heap vector.
+#define vdl_ArenaEscape(...) vdl_CallFunction(vdl_ArenaEscape_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ArenaEscape_BT(VDL_VECTOR_P v);
+
+/*-----------------------------------------------------------------------------
+ |  File mapping
+ ----------------------------------------------------------------------------*/
+
+/// A file mapping.
+/// @details It is stored right after the struct of a `VDL_MODE_MMAP` vector.
+/// @param Address (void *). Start of the mapping, aligned to a page.
+/// @param Length (size_t). Length of the mapping in bytes.
+typedef struct VDL_FILE_MAPPING_T
+{
+    void *Address;
+    size_t Length;
+} VDL_FILE_MAPPING_T;
+
+/// Get the file mapping of a `VDL_MODE_MMAP` vector. No checks will be performed.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (VDL_FILE_MAPPING_T *) The file mapping.
+#define vdl_vector_primitive_FileMapping(v) ((VDL_FILE_MAPPING_T *) ((v) + 1))
+
+/// Access pattern hints of a file mapped vector.
+/// @details
+/// VDL_ADVICE_NORMAL: 0, no special treatment. \n\n
+/// VDL_ADVICE_SEQUENTIAL: 1, items will be accessed in order, so pages can be read ahead aggressively. \n\n
+/// VDL_ADVICE_RANDOM: 2, items will be accessed in random order, so read ahead is not useful. \n\n
+/// VDL_ADVICE_WILL_NEED: 3, items will be accessed soon, so pages can be read in advance.
+typedef enum VDL_ADVICE_T
+{
+    VDL_ADVICE_NORMAL     = 0,
+    VDL_ADVICE_SEQUENTIAL = 1,
+    VDL_ADVICE_RANDOM     = 2,
+    VDL_ADVICE_WILL_NEED  = 3
+} VDL_ADVICE_T;
+
+/// `madvise` flags of the access pattern hints.
+static const int VDL_ADVICE_FLAG[4] = {
+        [VDL_ADVICE_NORMAL]     = MADV_NORMAL,
+        [VDL_ADVICE_SEQUENTIAL] = MADV_SEQUENTIAL,
+        [VDL_ADVICE_RANDOM]     = MADV_RANDOM,
+        [VDL_ADVICE_WILL_NEED]  = MADV_WILLNEED};
+
+/// New a vector whose data container is mapped from a region of a binary file, and record it by the garbage collector.
+/// @details The file is not read into the heap. Pages are loaded by the operating system when
+/// they are accessed, and the mapping is unmapped when the vector is freed. \n\n
+/// A read-only vector can be read by all the read-only accessors, but it can not be modified.
+/// A copy-on-write vector can also be modified, and the modifications are private to the
+/// process and never written back to the file. File mapped vectors can not grow. \n\n
+/// Items are stored in the native representation of the type. Vector pointers can not be
+/// mapped. The offset must be a multiple of the item size, and the data container is only
+/// aligned as much as the offset.
+/// @param type (VDL_TYPE_T). Vector type.
+/// @param path (const char *). Path of the file.
+/// @param offset (size_t). Offset of the region in bytes.
+/// @param length (VDL_INDEX_T). Number of items. 0 maps all the complete items after the offset.
+/// @param copy_on_write (int). Whether the vector can be modified.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewByFile(...) vdl_CallFunction(vdl_vector_primitive_NewByFile_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByFile_BT(VDL_TYPE_T type, const char *path, size_t offset, VDL_INDEX_T length, int copy_on_write);
+
+/// Give a hint on how a file mapped vector will be accessed.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param advice (VDL_ADVICE_T). The access pattern.
+#define vdl_vector_primitive_Advise(...) vdl_CallVoidFunction(vdl_vector_primitive_Advise_BT, __VA_ARGS__)
+static inline void vdl_vector_primitive_Advise_BT(VDL_VECTOR_P v, VDL_ADVICE_T advice);
+
+/*-----------------------------------------------------------------------------
+ |  Shared data buffers
+ ----------------------------------------------------------------------------*/
+
+/// Whether the data container of a vector can be shared.
+/// @details Only heap vectors with a separate data container, file mapped vectors and views
+/// can share their data containers. Other data containers are cheap to copy or can not
+/// outlive their vectors.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (int) 1 if shareable, 0 otherwise.
+#define vdl_vector_primitive_IsShareable(v) (((v)->Mode == VDL_MODE_HEAP && !((v)->Flag & VDL_FLAG_INLINE)) || \
+                                             (v)->Mode == VDL_MODE_MMAP ||                                     \
+                                             (v)->Mode == VDL_MODE_VIEW)
+
+/// Get the shared data buffer of a vector. The data container starts being shared if it is not shared yet.
+/// @details The reference count is not changed.
+/// @param v (VDL_VECTOR_P). A shareable vector.
+/// @return (VDL_SHARED_BUFFER_T *) The shared data buffer.
+#define vdl_vector_primitive_ShareBuffer(...) vdl_CallFunction(vdl_vector_primitive_ShareBuffer_BT, VDL_SHARED_BUFFER_T *, __VA_ARGS__)
+static inline VDL_SHARED_BUFFER_T *vdl_vector_primitive_ShareBuffer_BT(VDL_VECTOR_P v);
+
+/// New a vector on heap sharing the data container of another vector, and record it by the garbage collector.
+/// @details The new vector covers `length` items from index `start`. It is a heap vector if it
+/// covers all the items of a heap vector, otherwise it is a view. All attributes will be dropped.
+/// No checks on the range will be performed. A new vector not inheriting the read-only flag is
+/// writable, and detaches from a read-only buffer before its first write.
+/// @param v (VDL_VECTOR_P). A shareable vector.
+/// @param start (VDL_INDEX_T). Index of the first item.
+/// @param length (VDL_INDEX_T). Number of items.
+/// @param inherit_read_only (int). Whether the new vector is read-only if `v` is read-only.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_vector_primitive_NewShared(...) vdl_CallFunction(vdl_vector_primitive_NewShared_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewShared_BT(VDL_VECTOR_P v, VDL_INDEX_T start, VDL_INDEX_T length, int inherit_read_only);
+
+/// Drop a reference to a shared data buffer. The buffer is released with the last reference.
+/// @param buffer (VDL_SHARED_BUFFER_T *). A shared data buffer.
+#define vdl_ReleaseSharedBuffer(...) vdl_CallVoidFunction(vdl_ReleaseSharedBuffer_BT, __VA_ARGS__)
+static inline void vdl_ReleaseSharedBuffer_BT(VDL_SHARED_BUFFER_T *buffer);
+
+/// Stop sharing the data buffer of a vector.
+/// @details The vector gets a private copy of its data container, and a view becomes a heap vector.
+/// If no other vector references the buffer, a vector owning the whole buffer takes it back
+/// without copying.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_vector_primitive_Detach(...) vdl_CallVoidFunction(vdl_vector_primitive_Detach_BT, __VA_ARGS__)
+static inline void vdl_vector_primitive_Detach_BT(VDL_VECTOR_P v);
+
+/// Prepare a vector for modifying its data container.
+/// @details A read-only vector is rejected. A vector sharing its data buffer with other vectors,
+/// or sharing a read-only buffer, is detached first, so the modification is not visible through
+/// the other vectors.
+/// @param v (VDL_VECTOR_P). A vector.
+#define vdl_vector_primitive_PrepareWrite(v)                                             \
+    do {                                                                                 \
+        vdl_CheckWritable(v);                                                            \
+        if ((v)->Buffer != NULL && ((v)->Buffer->RefCount > 1 || (v)->Buffer->ReadOnly)) \
+            vdl_vector_primitive_Detach(v);                                              \
+    } while (0)
+
 #endif//VDL_VDL_7_VECTOR_MEMORY_H
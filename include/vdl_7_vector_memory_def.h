@@ -9,51 +9,95 @@
  |  Construct empty vector on heap
  ----------------------------------------------------------------------------*/
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewEmpty_BT(const VDL_TYPE_T type, const int capacity)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewEmpty_BT(const VDL_TYPE_T type, const VDL_INDEX_T capacity)
 {
-    vdl_CheckIntNA(capacity);
+    if (vdl_GlobalVar_Arena.Depth > 0)
+        return vdl_ArenaNewEmpty(type, capacity);
+
+    return vdl_vector_primitive_NewEmptyOnHeap(type, capacity);
+}
+
+static inline VDL_VECTOR_P vdl_vector_primitive_NewUninit_BT(const VDL_TYPE_T type, const VDL_INDEX_T capacity)
+{
+    if (vdl_GlobalVar_Arena.Depth > 0)
+        return vdl_ArenaNewEmpty(type, capacity);
+
+    return vdl_vector_primitive_NewOnHeap(type, capacity, 0, 0);
+}
+
+static inline VDL_VECTOR_P vdl_vector_primitive_NewEmptyOnHeap_BT(const VDL_TYPE_T type, const VDL_INDEX_T capacity)
+{
+    return vdl_vector_primitive_NewOnHeap(type, capacity, 1, 0);
+}
+
+static inline VDL_VECTOR_P vdl_vector_primitive_NewOnHeap_BT(const VDL_TYPE_T type,
+                                                             const VDL_INDEX_T capacity,
+                                                             const int zero_data,
+                                                             const int attribute)
+{
+    vdl_CheckIndexNA(capacity);
     vdl_CheckRequestedCapacity(capacity);
 
+    // Small data containers are stored right after the vector struct.
+    const size_t data_size = (size_t) capacity * VDL_TYPE_SIZE[type];
+    const int inline_data  = data_size <= VDL_VECTOR_INLINE_DATA_SIZE;
+
     // Create a vector and copy in the content.
-    VDL_VECTOR_P v       = vdl_Malloc(sizeof(VDL_VECTOR_T), 1);
-    VDL_VECTOR_P local_v = &(VDL_VECTOR_T){.Capacity  = capacity,
-                                           .Mode      = VDL_MODE_HEAP,
-                                           .Type      = type,
-                                           .Class     = VDL_CLASS_VECTOR,
-                                           .Length    = 0,
-                                           .Attribute = NULL,
-                                           .Data      = NULL};
+    const size_t v_size                    = inline_data ? sizeof(VDL_VECTOR_T) + VDL_DATA_ALIGNMENT - 1 + data_size : sizeof(VDL_VECTOR_T);
+    const VDL_SUBSYSTEM_T header_subsystem = attribute ? VDL_SUBSYSTEM_ATTRIBUTE : VDL_SUBSYSTEM_VECTOR_HEADER;
+    VDL_VECTOR_P v                         = zero_data && inline_data ? vdl_Calloc(1, v_size, 1, header_subsystem) : vdl_Malloc(v_size, 1, header_subsystem);
+    VDL_VECTOR_P local_v                   = &(VDL_VECTOR_T){.Capacity  = capacity,
+                                                             .Mode      = VDL_MODE_HEAP,
+                                                             .Type      = type,
+                                                             .Class     = VDL_CLASS_VECTOR,
+                                                             .Length    = 0,
+                                                             .Mark      = 0,
+                                                             .Flag      = (inline_data ? VDL_FLAG_INLINE : 0) | (attribute ? VDL_FLAG_ATTRIBUTE : 0),
+                                                             .Attribute = NULL,
+                                                             .Data      = NULL,
+                                                             .Buffer    = NULL};
     memcpy(v, local_v, sizeof(VDL_VECTOR_T));
 
     // Allocate memory for the data container.
-    v->Data = vdl_Calloc((size_t) capacity, VDL_TYPE_SIZE[type], 1);
+    if (inline_data)
+        v->Data = (void *) vdl_AlignUp((uintptr_t) (v + 1), VDL_DATA_ALIGNMENT);
+    else if (zero_data)
+        v->Data = vdl_AlignedCalloc(data_size, VDL_DATA_ALIGNMENT, 1, VDL_SUBSYSTEM_VECTOR_DATA);
+    else
+        v->Data = vdl_AlignedMalloc(data_size, VDL_DATA_ALIGNMENT, 1, VDL_SUBSYSTEM_VECTOR_DATA);
+
+#ifdef VDL_POISON_UNINITIALIZED
+    if (!zero_data)
+        memset(v->Data, VDL_UNINITIALIZED_POISON_BYTE, data_size);
+#endif
 
     // Record the vector in the vector table.
     vdl_GarbageCollectorRecord(v);
 
     vdl_ExceptionDeregisterCleanUp(v);
-    vdl_ExceptionDeregisterCleanUp(v->Data);
+    if (!inline_data)
+        vdl_ExceptionDeregisterCleanUp(v->Data);
     return v;
 }
 
 static inline VDL_VECTOR_P vdl_vector_NewEmpty_BT(VDL_VECTOR_T *const type, VDL_VECTOR_T *const capacity)
 {
     vdl_CheckIntVector(type);
-    vdl_CheckIntVector(capacity);
+    vdl_CheckIndexVector(capacity);
     vdl_CheckLength(type->Length, 1);
     vdl_CheckLength(capacity->Length, 1);
 
     int requested_type = vdl_vector_primitive_UnsafeIntAt(type, 0);
     vdl_CheckUnknownType(requested_type);
 
-    return vdl_vector_primitive_NewEmpty((VDL_TYPE_T) requested_type, vdl_vector_primitive_UnsafeIntAt(capacity, 0));
+    return vdl_vector_primitive_NewEmpty((VDL_TYPE_T) requested_type, vdl_vector_primitive_UnsafeIndexOf(capacity, 0));
 }
 
 /*-----------------------------------------------------------------------------
  |  Construct vector on heap with a single element
  ----------------------------------------------------------------------------*/
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByChar_BT(const char item, const int length)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByChar_BT(const char item, const VDL_INDEX_T length)
 {
     VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_CHAR, length);
     VDL_CHAR_ARRAY data_array       = v->Data;
@@ -62,41 +106,66 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByChar_BT(const char item, co
     return v;
 }
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByInt_BT(const int item, const int length)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByInt_BT(const int item, const VDL_INDEX_T length)
 {
-    VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, length);
     VDL_INT_ARRAY data_array        = v->Data;
     vdl_for_i(length) data_array[i] = item;
     v->Length                       = length;
     return v;
 }
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByDouble_BT(const double item, const int length)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByDouble_BT(const double item, const VDL_INDEX_T length)
 {
-    VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 1);
+    VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, length);
     VDL_DOUBLE_ARRAY data_array     = v->Data;
     vdl_for_i(length) data_array[i] = item;
     v->Length                       = length;
     return v;
 }
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByVectorPointer_BT(VDL_VECTOR_T *const item, const int length)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByVectorPointer_BT(VDL_VECTOR_T *const item, const VDL_INDEX_T length)
 {
-    VDL_VECTOR_P v                      = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+    // The item is only referred by the argument until it is stored
+    vdl_GarbageCollectorCriticalBegin();
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, length);
+    vdl_GarbageCollectorCriticalEnd();
+
     VDL_VECTOR_POINTER_ARRAY data_array = v->Data;
     vdl_for_i(length) data_array[i]     = item;
     v->Length                           = length;
     return v;
 }
 
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByIndex_BT(const VDL_INDEX_T item, const VDL_INDEX_T length)
+{
+    VDL_VECTOR_P v                  = vdl_vector_primitive_NewEmpty(VDL_TYPE_INDEX, length);
+    VDL_INDEX_ARRAY data_array      = v->Data;
+    vdl_for_i(length) data_array[i] = item;
+    v->Length                       = length;
+    return v;
+}
+
 /*-----------------------------------------------------------------------------
  |  Construct vector on heap with an array
  ----------------------------------------------------------------------------*/
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(const VDL_TYPE_T type, const int capacity, const void *const item_pointer, const int number)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(const VDL_TYPE_T type, const VDL_INDEX_T capacity, const void *const item_pointer, const VDL_INDEX_T number)
 {
-    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(type, capacity);
-    vdl_vector_primitive_SetByArrayAndMemmove(v, 0, item_pointer, number);
+    vdl_CheckIndexNA(number);
+    vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
+    vdl_Expect(number <= capacity,
+               VDL_EXCEPTION_INCOMPATIBLE_LENGTH,
+               "The number of items [" VDL_INDEX_FORMAT "] exceeds the capacity [" VDL_INDEX_FORMAT "]!",
+               number,
+               capacity);
+
+    // Vectors pointed by the items are only referred by the array until they are stored
+    vdl_GarbageCollectorCriticalBegin();
+    VDL_VECTOR_P v = vdl_vector_primitive_NewUninit(type, capacity);
+    vdl_GarbageCollectorCriticalEnd();
+    vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(v, 0, item_pointer, number);
+    v->Length = number;
     return v;
 }
 
@@ -105,9 +174,12 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByArray_BT(const VDL_TYPE_T t
  ----------------------------------------------------------------------------*/
 
 
-static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(const VDL_TYPE_T type, const int length, ...)
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(const VDL_TYPE_T type, const VDL_INDEX_T length, ...)
 {
+    // Vectors passed as items are only referred by the arguments until they are stored
+    vdl_GarbageCollectorCriticalBegin();
     VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(type, length);
+    vdl_GarbageCollectorCriticalEnd();
     v->Length      = length;
 
     va_list ap;
@@ -135,6 +207,11 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(const VDL_TYPE_
             vdl_for_i(length) vdl_vector_primitive_UnsafeSetVectorPointer(v, i, va_arg(ap, VDL_VECTOR_P));
             break;
         }
+        case VDL_TYPE_INDEX:
+        {
+            vdl_for_i(length) vdl_vector_primitive_UnsafeSetIndex(v, i, va_arg(ap, VDL_INDEX_T));
+            break;
+        }
     }
 
     va_end(ap);
@@ -145,13 +222,23 @@ static inline VDL_VECTOR_P vdl_vector_primitive_NewByVariadic_BT(const VDL_TYPE_
  |  Reserve space for heap allocated vector
  ----------------------------------------------------------------------------*/
 
-static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_T *const v, const int capacity)
+static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T capacity)
 {
     vdl_CheckNullVectorAndNullContainer(v);
-    vdl_CheckMode(v->Mode, VDL_MODE_HEAP);
-    vdl_CheckIntNA(capacity);
+    vdl_Expect(v->Mode == VDL_MODE_HEAP || v->Mode == VDL_MODE_ARENA || v->Mode == VDL_MODE_VIEW,
+               VDL_EXCEPTION_UNEXPECTED_MODE,
+               "Unexpected vector mode [%s] provided! Vector mode [%s], [%s] or [%s] Expected!",
+               VDL_MODE_STRING[v->Mode],
+               VDL_MODE_STRING[VDL_MODE_HEAP],
+               VDL_MODE_STRING[VDL_MODE_ARENA],
+               VDL_MODE_STRING[VDL_MODE_VIEW]);
+    vdl_CheckIndexNA(capacity);
     vdl_CheckRequestedCapacity(capacity);
 
+    // A shared data container can not be resized or modified in place
+    if (v->Buffer != NULL)
+        vdl_vector_primitive_Detach(v);
+
     if (v->Capacity >= capacity)
         return;
 
@@ -170,19 +257,479 @@ static inline void vdl_vector_primitive_Reserve_BT(VDL_VECTOR_T *const v, const
     if (target_capacity > VDL_VECTOR_MAX_CAPACITY)
         target_capacity = VDL_VECTOR_MAX_CAPACITY;
 
-    void *buffer = vdl_Calloc(target_capacity, VDL_TYPE_SIZE[v->Type], 1);
-    v->Data      = buffer;
-    v->Capacity  = (int) target_capacity;
+    // Arena memory is freed as a whole, so the old data container is simply abandoned.
+    // The new one must come from the arena owning the vector, or it would dangle after an inner arena ends
+    if (v->Mode == VDL_MODE_ARENA)
+    {
+        vdl_Expect(vdl_ArenaDepthOf(v) == vdl_GlobalVar_Arena.Depth,
+                   VDL_EXCEPTION_INVALID_ARENA_STATE,
+                   "Can not grow a vector of arena [%d] while arena [%d] is the latest!",
+                   vdl_ArenaDepthOf(v),
+                   vdl_GlobalVar_Arena.Depth);
+
+        void *buffer = vdl_ArenaAlloc(target_capacity * VDL_TYPE_SIZE[v->Type]);
+        memcpy(buffer, v->Data, vdl_vector_primitive_SizeOfData(v));
+        v->Flag &= ~VDL_FLAG_INLINE;
+        v->Data     = buffer;
+        v->Capacity = (VDL_INDEX_T) target_capacity;
+        return;
+    }
 
-    vdl_ExceptionDeregisterCleanUp(buffer);
+    const size_t old_size = vdl_vector_primitive_SizeOfData(v);
+    const size_t new_size = target_capacity * VDL_TYPE_SIZE[v->Type];
+    void *buffer          = NULL;
+
+    if (v->Flag & VDL_FLAG_INLINE)
+    {
+        // Spill the inline data container. It lives in the block of the vector struct,
+        // so it is copied out but never freed on its own
+        buffer = vdl_AlignedMalloc(new_size, VDL_DATA_ALIGNMENT, 0, VDL_SUBSYSTEM_VECTOR_DATA);
+        memcpy(buffer, v->Data, old_size);
+        v->Flag &= ~VDL_FLAG_INLINE;
+    }
+    else
+    {
+        // Let the allocator extend the data container in place when it can
+        buffer = vdl_AlignedRealloc(v->Data, new_size, VDL_DATA_ALIGNMENT, VDL_SUBSYSTEM_VECTOR_DATA);
+    }
+
+    // The existing data is preserved, so only the new tail needs to be zeroed
+    memset((char *) buffer + old_size, 0, new_size - old_size);
+
+    vdl_CountGrowth(v, new_size - old_size);
+    v->Data     = buffer;
+    v->Capacity = (VDL_INDEX_T) target_capacity;
 }
 
 static inline void vdl_vector_Reserve_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const capacity)
 {
-    vdl_CheckNullPointer(capacity);
+    vdl_CheckIndexVector(capacity);
     vdl_CheckLength(capacity->Length, 1);
 
-    vdl_vector_primitive_Reserve(v, vdl_vector_primitive_GetInt(capacity, 0));
+    vdl_vector_primitive_Reserve(v, vdl_vector_primitive_UnsafeIndexOf(capacity, 0));
+}
+
+/*-----------------------------------------------------------------------------
+ |  Arena
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_ArenaBegin_BT(void)
+{
+    vdl_Expect(vdl_GlobalVar_Arena.Depth < VDL_ARENA_MAX_DEPTH,
+               VDL_EXCEPTION_INVALID_ARENA_STATE,
+               "Can not nest more than %d arenas!",
+               VDL_ARENA_MAX_DEPTH);
+
+    vdl_GlobalVar_Arena.Saved[vdl_GlobalVar_Arena.Depth] = vdl_GlobalVar_Arena.Current;
+    vdl_GlobalVar_Arena.Depth++;
+}
+
+static inline void vdl_ArenaEnd_BT(void)
+{
+    vdl_Expect(vdl_GlobalVar_Arena.Depth > 0,
+               VDL_EXCEPTION_INVALID_ARENA_STATE,
+               "No arena to end!");
+
+    vdl_ArenaUnsafeUnwind(vdl_GlobalVar_Arena.Depth - 1);
+}
+
+static inline void vdl_ArenaUnsafeUnwind(const int depth)
+{
+    if (depth < 0 || vdl_GlobalVar_Arena.Depth <= depth)
+        return;
+
+    vdl_GlobalVar_Arena.Depth        = depth;
+    const VDL_ARENA_POSITION_T saved = vdl_GlobalVar_Arena.Saved[depth];
+
+    // Free the chunks allocated after the outermost ended arena began
+    VDL_ARENA_CHUNK_T *chunk = vdl_GlobalVar_Arena.Current.Chunk;
+    while (chunk != saved.Chunk)
+    {
+        VDL_ARENA_CHUNK_T *previous = chunk->Previous;
+        vdl_Free(chunk, VDL_SUBSYSTEM_ARENA);
+        chunk = previous;
+    }
+
+    vdl_GlobalVar_Arena.Current = saved;
+}
+
+static inline void *vdl_ArenaAlloc_BT(const size_t bytes)
+{
+    vdl_Expect(vdl_GlobalVar_Arena.Depth > 0,
+               VDL_EXCEPTION_INVALID_ARENA_STATE,
+               "No active arena to allocate from!");
+    vdl_Expect(bytes <= SIZE_MAX - VDL_ARENA_CHUNK_SIZE,
+               VDL_EXCEPTION_FAILED_ALLOCATION,
+               "Can not allocate [%zu] bytes from the arena!",
+               bytes);
+
+    const size_t aligned_bytes = vdl_AlignUp(bytes, VDL_ARENA_ALIGNMENT);
+    VDL_ARENA_POSITION_T *const current = &vdl_GlobalVar_Arena.Current;
+
+    // Start a new chunk if the latest one does not have enough space
+    if (current->Chunk == NULL || (size_t) (current->End - current->Cursor) < aligned_bytes)
+    {
+        const size_t chunk_size  = aligned_bytes > VDL_ARENA_CHUNK_SIZE ? aligned_bytes : VDL_ARENA_CHUNK_SIZE;
+        VDL_ARENA_CHUNK_T *chunk = vdl_Malloc(sizeof(VDL_ARENA_CHUNK_T) + VDL_ARENA_ALIGNMENT - 1 + chunk_size, 0, VDL_SUBSYSTEM_ARENA);
+        chunk->Previous          = current->Chunk;
+        current->Chunk           = chunk;
+        current->Cursor          = (char *) vdl_AlignUp((uintptr_t) (chunk + 1), VDL_ARENA_ALIGNMENT);
+        current->End             = current->Cursor + chunk_size;
+    }
+
+    void *object = current->Cursor;
+    current->Cursor += aligned_bytes;
+    memset(object, 0, bytes);
+    return object;
+}
+
+static inline VDL_VECTOR_P vdl_ArenaNewEmpty_BT(const VDL_TYPE_T type, const VDL_INDEX_T capacity)
+{
+    vdl_CheckIndexNA(capacity);
+    vdl_CheckRequestedCapacity(capacity);
+
+    // The data container is stored right after the vector struct, at the next aligned address.
+    const size_t v_size  = vdl_AlignUp(sizeof(VDL_VECTOR_T), VDL_ARENA_ALIGNMENT);
+    VDL_VECTOR_P v       = vdl_ArenaAlloc(v_size + (size_t) capacity * VDL_TYPE_SIZE[type]);
+    VDL_VECTOR_P local_v = &(VDL_VECTOR_T){.Capacity  = capacity,
+                                           .Mode      = VDL_MODE_ARENA,
+                                           .Type      = type,
+                                           .Class     = VDL_CLASS_VECTOR,
+                                           .Length    = 0,
+                                           .Mark      = 0,
+                                           .Flag      = VDL_FLAG_INLINE | (VDL_FLAG_T) vdl_GlobalVar_Arena.Depth << VDL_FLAG_ARENA_DEPTH_SHIFT,
+                                           .Attribute = NULL,
+                                           .Data      = NULL,
+                                           .Buffer    = NULL};
+    memcpy(v, local_v, sizeof(VDL_VECTOR_T));
+    v->Data = (char *) v + v_size;
+
+    return v;
+}
+
+static inline void vdl_ArenaEscapeMapGrow_BT(VDL_ARENA_ESCAPE_MAP_T *const map)
+{
+    const int capacity  = vdl_MulIntOverflow(map->Capacity, 2);
+    const int mask      = capacity - 1;
+    VDL_VECTOR_P *slots = vdl_Calloc((size_t) capacity * 2, sizeof(VDL_VECTOR_P), 0, VDL_SUBSYSTEM_ARENA);
+
+    // Reinsert the pairs into the new slots
+    for (int i = 0; i < map->Capacity; i++)
+    {
+        if (map->Data[2 * i] == NULL)
+            continue;
+        int slot = (int) (vdl_HashAddress(map->Data[2 * i]) & (size_t) mask);
+        while (slots[2 * slot] != NULL)
+            slot = (slot + 1) & mask;
+        slots[2 * slot]     = map->Data[2 * i];
+        slots[2 * slot + 1] = map->Data[2 * i + 1];
+    }
+
+    vdl_ExceptionDeregisterCleanUp(map->Data);
+    vdl_Free(map->Data, VDL_SUBSYSTEM_ARENA);
+    vdl_ExceptionRegisterCleanUp(slots, vdl_FreeCleanUp);
+    map->Data     = slots;
+    map->Capacity = capacity;
+}
+
+static inline VDL_VECTOR_P vdl_ArenaEscapeForward_BT(VDL_VECTOR_T *const v, VDL_ARENA_ESCAPE_MAP_T *const map)
+{
+    if (v == NULL || v->Mode != VDL_MODE_ARENA)
+        return v;
+
+    // Reuse the copy if the vector has been promoted
+    const int mask = map->Capacity - 1;
+    int slot       = (int) (vdl_HashAddress(v) & (size_t) mask);
+    while (map->Data[2 * slot] != NULL)
+    {
+        if (map->Data[2 * slot] == v)
+            return map->Data[2 * slot + 1];
+        slot = (slot + 1) & mask;
+    }
+
+    // The references are copied as they are, and forwarded when the copy is popped from the work stack
+    VDL_VECTOR_P result = vdl_vector_primitive_NewOnHeap(v->Type, v->Capacity, 0, 0);
+    memcpy(result->Data, v->Data, (size_t) v->Length * VDL_TYPE_SIZE[v->Type]);
+    result->Length    = v->Length;
+    result->Attribute = v->Attribute;
+
+    // Record the pair before following the references, so cycles end here
+    map->Data[2 * slot]     = v;
+    map->Data[2 * slot + 1] = result;
+    map->Length++;
+    if (map->Length > vdl_VectorTableMaxLoad(map->Capacity))
+        vdl_ArenaEscapeMapGrow(map);
+
+    if (map->PendingLength == map->PendingCapacity)
+    {
+        const int new_capacity = vdl_MulIntOverflow(map->PendingCapacity, 2);
+        VDL_VECTOR_P *pending  = vdl_Malloc(sizeof(VDL_VECTOR_P) * (size_t) new_capacity, 0, VDL_SUBSYSTEM_ARENA);
+        memcpy(pending, map->Pending, sizeof(VDL_VECTOR_P) * (size_t) map->PendingLength);
+        vdl_ExceptionDeregisterCleanUp(map->Pending);
+        vdl_Free(map->Pending, VDL_SUBSYSTEM_ARENA);
+        vdl_ExceptionRegisterCleanUp(pending, vdl_FreeCleanUp);
+        map->Pending         = pending;
+        map->PendingCapacity = new_capacity;
+    }
+    map->Pending[map->PendingLength] = result;
+    map->PendingLength++;
+
+    return result;
+}
+
+static inline VDL_VECTOR_P vdl_ArenaEscape_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullPointer(v);
+
+    if (v->Mode != VDL_MODE_ARENA)
+        return v;
+
+    // Copies are not reachable until the whole graph is promoted
+    vdl_GarbageCollectorCriticalBegin();
+
+    VDL_ARENA_ESCAPE_MAP_T map = {.Capacity        = VDL_ARENA_ESCAPE_MAP_INIT_CAPACITY,
+                                  .Length          = 0,
+                                  .Data            = vdl_Calloc((size_t) VDL_ARENA_ESCAPE_MAP_INIT_CAPACITY * 2, sizeof(VDL_VECTOR_P), 1, VDL_SUBSYSTEM_ARENA),
+                                  .PendingCapacity = VDL_ARENA_ESCAPE_MAP_INIT_CAPACITY,
+                                  .PendingLength   = 0,
+                                  .Pending         = vdl_Malloc(sizeof(VDL_VECTOR_P) * (size_t) VDL_ARENA_ESCAPE_MAP_INIT_CAPACITY, 1, VDL_SUBSYSTEM_ARENA)};
+
+    VDL_VECTOR_P result = vdl_ArenaEscapeForward(v, &map);
+
+    // Forward the references of the copies until none of them refers to an arena vector
+    while (map.PendingLength > 0)
+    {
+        map.PendingLength--;
+        VDL_VECTOR_P copy = map.Pending[map.PendingLength];
+        if (copy->Type == VDL_TYPE_VECTOR_POINTER)
+        {
+            VDL_VECTOR_POINTER_ARRAY children = copy->Data;
+            vdl_for_i(copy->Length) children[i] = vdl_ArenaEscapeForward(children[i], &map);
+        }
+        copy->Attribute = vdl_ArenaEscapeForward(copy->Attribute, &map);
+        vdl_GarbageCollectorRecordWrite(copy);
+    }
+
+    vdl_ExceptionDeregisterCleanUp(map.Data);
+    vdl_Free(map.Data, VDL_SUBSYSTEM_ARENA);
+    vdl_ExceptionDeregisterCleanUp(map.Pending);
+    vdl_Free(map.Pending, VDL_SUBSYSTEM_ARENA);
+    vdl_GarbageCollectorCriticalEnd();
+
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+ |  File mapping
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_VECTOR_P vdl_vector_primitive_NewByFile_BT(const VDL_TYPE_T type,
+                                                             const char *const path,
+                                                             const size_t offset,
+                                                             const VDL_INDEX_T length,
+                                                             const int copy_on_write)
+{
+    vdl_CheckNullPointer(path);
+    vdl_Expect((int) type >= 0 && (int) type < VDL_TYPE_NUM && type != VDL_TYPE_VECTOR_POINTER,
+               VDL_EXCEPTION_UNEXPECTED_TYPE,
+               "Vector type [%d] can not be mapped from a file!",
+               (int) type);
+    vdl_CheckIndexNA(length);
+    vdl_Expect(length >= 0,
+               VDL_EXCEPTION_NON_POSITIVE_LENGTH,
+               "Negative vector length [" VDL_INDEX_FORMAT "] provided!",
+               length);
+    vdl_Expect(offset % VDL_TYPE_SIZE[type] == 0,
+               VDL_EXCEPTION_FAILED_FILE_MAPPING,
+               "Offset [%zu] is not a multiple of the item size [%zu]!",
+               offset,
+               VDL_TYPE_SIZE[type]);
+
+    // The struct is allocated first, so a failed mapping only needs to free it
+    VDL_VECTOR_P v = vdl_Malloc(sizeof(VDL_VECTOR_T) + sizeof(VDL_FILE_MAPPING_T), 1, VDL_SUBSYSTEM_VECTOR_HEADER);
+
+    const int fd = open(path, O_RDONLY);
+    vdl_Expect(fd >= 0,
+               VDL_EXCEPTION_FAILED_FILE_MAPPING,
+               "Can not open file [%s]!",
+               path);
+
+    struct stat file_status;
+    const int stat_failed  = fstat(fd, &file_status) != 0;
+    const size_t file_size = stat_failed ? 0 : (size_t) file_status.st_size;
+    const size_t available = file_size > offset ? (file_size - offset) / VDL_TYPE_SIZE[type] : 0;
+    const size_t number    = length == 0 ? available : (size_t) length;
+
+    // The offset of a mapping must be a multiple of the page size
+    const size_t page_offset = offset % (size_t) sysconf(_SC_PAGESIZE);
+    const size_t map_length  = page_offset + number * VDL_TYPE_SIZE[type];
+    void *address            = MAP_FAILED;
+    if (number > 0 && number <= available && number < (size_t) VDL_VECTOR_MAX_CAPACITY)
+        address = mmap(NULL,
+                       map_length,
+                       copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_PRIVATE,
+                       fd,
+                       (off_t) (offset - page_offset));
+    close(fd);
+
+    vdl_Expect(address != MAP_FAILED,
+               VDL_EXCEPTION_FAILED_FILE_MAPPING,
+               "Can not map [%zu] items from offset [%zu] of file [%s] with [%zu] bytes!",
+               number,
+               offset,
+               path,
+               file_size);
+
+    VDL_VECTOR_P local_v = &(VDL_VECTOR_T){.Capacity  = (VDL_INDEX_T) number,
+                                           .Mode      = VDL_MODE_MMAP,
+                                           .Type      = type,
+                                           .Class     = VDL_CLASS_VECTOR,
+                                           .Length    = (VDL_INDEX_T) number,
+                                           .Mark      = 0,
+                                           .Flag      = copy_on_write ? 0 : VDL_FLAG_READ_ONLY,
+                                           .Attribute = NULL,
+                                           .Data      = (char *) address + page_offset,
+                                           .Buffer    = NULL};
+    memcpy(v, local_v, sizeof(VDL_VECTOR_T));
+    vdl_vector_primitive_FileMapping(v)->Address = address;
+    vdl_vector_primitive_FileMapping(v)->Length  = map_length;
+
+    // From now on the mapping is released together with the vector
+    vdl_GarbageCollectorRecord(v);
+
+    vdl_ExceptionDeregisterCleanUp(v);
+    return v;
+}
+
+static inline void vdl_vector_primitive_Advise_BT(VDL_VECTOR_T *const v, const VDL_ADVICE_T advice)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckMode(v->Mode, VDL_MODE_MMAP);
+    vdl_Expect(advice >= VDL_ADVICE_NORMAL && advice <= VDL_ADVICE_WILL_NEED,
+               VDL_EXCEPTION_FAILED_FILE_MAPPING,
+               "Unknown access pattern [%d] provided!",
+               (int) advice);
+
+    const VDL_FILE_MAPPING_T *const mapping = vdl_vector_primitive_FileMapping(v);
+    vdl_Expect(madvise(mapping->Address, mapping->Length, VDL_ADVICE_FLAG[advice]) == 0,
+               VDL_EXCEPTION_FAILED_FILE_MAPPING,
+               "Can not apply access pattern [%d] to the file mapping!",
+               (int) advice);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Shared data buffers
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_SHARED_BUFFER_T *vdl_vector_primitive_ShareBuffer_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_Expect(vdl_vector_primitive_IsShareable(v),
+               VDL_EXCEPTION_UNEXPECTED_MODE,
+               "The data container of a vector in mode [%s] can not be shared!",
+               VDL_MODE_STRING[v->Mode]);
+
+    if (v->Buffer != NULL)
+        return v->Buffer;
+
+    VDL_SHARED_BUFFER_T *buffer = vdl_Malloc(sizeof(VDL_SHARED_BUFFER_T), 0, VDL_SUBSYSTEM_VECTOR_DATA);
+    buffer->RefCount            = 1;
+    if (v->Mode == VDL_MODE_MMAP)
+    {
+        buffer->Address = vdl_vector_primitive_FileMapping(v)->Address;
+        buffer->Length  = vdl_vector_primitive_FileMapping(v)->Length;
+    }
+    else
+    {
+        buffer->Address = v->Data;
+        buffer->Length  = 0;
+    }
+    buffer->ReadOnly = (v->Flag & VDL_FLAG_READ_ONLY) != 0;
+
+    v->Buffer = buffer;
+    return buffer;
+}
+
+static inline VDL_VECTOR_P vdl_vector_primitive_NewShared_BT(VDL_VECTOR_T *const v,
+                                                             const VDL_INDEX_T start,
+                                                             const VDL_INDEX_T length,
+                                                             const int inherit_read_only)
+{
+    VDL_SHARED_BUFFER_T *const buffer = vdl_vector_primitive_ShareBuffer(v);
+
+    // Only a vector covering the whole heap data container can be a heap vector
+    const int whole_buffer = v->Mode == VDL_MODE_HEAP && start == 0 && length == v->Length;
+
+    VDL_VECTOR_P result  = vdl_Malloc(sizeof(VDL_VECTOR_T), 1, VDL_SUBSYSTEM_VECTOR_HEADER);
+    VDL_VECTOR_P local_v = &(VDL_VECTOR_T){.Capacity  = whole_buffer ? v->Capacity : length,
+                                           .Mode      = whole_buffer ? VDL_MODE_HEAP : VDL_MODE_VIEW,
+                                           .Type      = v->Type,
+                                           .Class     = VDL_CLASS_VECTOR,
+                                           .Length    = length,
+                                           .Mark      = 0,
+                                           .Flag      = inherit_read_only ? v->Flag & VDL_FLAG_READ_ONLY : 0,
+                                           .Attribute = NULL,
+                                           .Data      = vdl_vector_primitive_UnsafeAddressOf(v, start),
+                                           .Buffer    = buffer};
+    memcpy(result, local_v, sizeof(VDL_VECTOR_T));
+
+    // The buffer is referenced before anything can free the vector
+    buffer->RefCount++;
+    vdl_GarbageCollectorRecord(result);
+    if (result->Type == VDL_TYPE_VECTOR_POINTER)
+        vdl_GarbageCollectorWriteBarrier(result);
+
+    vdl_ExceptionDeregisterCleanUp(result);
+    return result;
+}
+
+static inline void vdl_ReleaseSharedBuffer_BT(VDL_SHARED_BUFFER_T *const buffer)
+{
+    vdl_CheckNullPointer(buffer);
+
+    buffer->RefCount--;
+    if (buffer->RefCount > 0)
+        return;
+
+    if (buffer->Length > 0)
+        munmap(buffer->Address, buffer->Length);
+    else
+        vdl_AlignedFree(buffer->Address, VDL_SUBSYSTEM_VECTOR_DATA);
+    vdl_Free(buffer, VDL_SUBSYSTEM_VECTOR_DATA);
+}
+
+static inline void vdl_vector_primitive_Detach_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+
+    VDL_SHARED_BUFFER_T *const buffer = v->Buffer;
+    if (buffer == NULL)
+        return;
+
+    // The last reference of the buffer can be taken back by the vector owning all of it
+    if (buffer->RefCount == 1 &&
+        (v->Mode == VDL_MODE_MMAP || (v->Mode == VDL_MODE_HEAP && v->Data == buffer->Address)))
+    {
+        vdl_Free(buffer, VDL_SUBSYSTEM_VECTOR_DATA);
+        v->Buffer = NULL;
+        return;
+    }
+
+    const size_t data_size = vdl_vector_primitive_SizeOfData(v);
+    void *const data       = vdl_AlignedMalloc(data_size, VDL_DATA_ALIGNMENT, 0, VDL_SUBSYSTEM_VECTOR_DATA);
+    memcpy(data, v->Data, data_size);
+
+    vdl_ReleaseSharedBuffer(buffer);
+    v->Buffer = NULL;
+    v->Data   = data;
+
+    // The storage mode is only changed here, since the vector owns a heap data container from now on
+    if (v->Mode != VDL_MODE_HEAP)
+    {
+        const VDL_MODE_T mode = VDL_MODE_HEAP;
+        memcpy((void *) &v->Mode, &mode, sizeof(VDL_MODE_T));
+    }
 }
 
 #endif//VDL_VDL_7_VECTOR_MEMORY_DEF_H
@@ -7,11 +7,57 @@
 
 // TODO: check which function can accept empty vector
 
+/*-----------------------------------------------------------------------------
+ |  Parallel vector operations
+ ----------------------------------------------------------------------------*/
+
+// Vector operations on long vectors are run in chunks by `vdl_ParallelFor`. Everything that
+// can throw is checked before the loop, and the chunks only read and write vector data.
+
+/// Vectors of an operation run in chunks.
+/// @param Target (VDL_VECTOR_P). The vector written by the operation.
+/// @param Sources (VDL_VECTOR_P [2]). Vectors read by the operation. Unused ones are NULL.
+/// @param Index (VDL_VECTOR_P). A vector of indices, or NULL.
+/// @param Invalid (VDL_INDEX_T). Position of the first invalid index found in `Index`.
+typedef struct VDL_VECTOR_TASK_T
+{
+    VDL_VECTOR_P Target;
+    VDL_VECTOR_P Sources[2];
+    VDL_VECTOR_P Index;
+    VDL_INDEX_T Invalid;
+} VDL_VECTOR_TASK_T;
+
+/// Find the first index of a chunk that is missing or out of the bound of the first source.
+/// No checks will be performed.
+/// @details It is safe to call this function from a worker thread. The smallest position
+/// found by all the chunks is kept in `Invalid`.
+/// @param begin (VDL_INDEX_T). Position of the first index of the chunk.
+/// @param end (VDL_INDEX_T). Position after the last index of the chunk.
+/// @param context (void *). A task (VDL_VECTOR_TASK_T *).
+static inline void vdl_IndexUnsafeCheckChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// Check whether all the indices are not missing and within the bound of a vector.
+/// @details Indices of long vectors are checked in parallel. The first invalid index is
+/// reported.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param i (VDL_VECTOR_P). A vector of indices.
+#define vdl_CheckIndexVectorInBound(...) vdl_CallVoidFunction(vdl_CheckIndexVectorInBound_BT, __VA_ARGS__)
+static inline void vdl_CheckIndexVectorInBound_BT(VDL_VECTOR_P v, VDL_VECTOR_P i);
+
 /*-----------------------------------------------------------------------------
  |  Set the vector data safely
  ----------------------------------------------------------------------------*/
 
+/// Set a chunk of the target by the first source. No checks will be performed.
+/// @details It is safe to call this function from a worker thread. A source of length 1
+/// is broadcast.
+/// @param begin (VDL_INDEX_T). Index of the first item of the chunk.
+/// @param end (VDL_INDEX_T). Index after the last item of the chunk.
+/// @param context (void *). A task (VDL_VECTOR_TASK_T *).
+static inline void vdl_vector_SetUnsafeRunChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
 /// Set a vector by another vector.
+/// @details Long vectors are set in parallel.
 /// @param v1 (VDL_VECTOR_P). A vector.
 /// @param value (VDL_VECTOR_P). Another vector.
 #define vdl_vector_Set(...) vdl_CallVoidFunction(vdl_vector_Set_BT, __VA_ARGS__)
@@ -21,7 +67,17 @@ static inline void vdl_vector_Set_BT(VDL_VECTOR_P v, VDL_VECTOR_P value);
  |  Set the vector data safely by index
  ----------------------------------------------------------------------------*/
 
+/// Set the target at a chunk of the indices by the first source. No checks will be performed.
+/// @details It is safe to call this function from a worker thread. A source of length 1
+/// is broadcast.
+/// @param begin (VDL_INDEX_T). Position of the first index of the chunk.
+/// @param end (VDL_INDEX_T). Position after the last index of the chunk.
+/// @param context (void *). A task (VDL_VECTOR_TASK_T *).
+static inline void vdl_vector_SetByIndexUnsafeRunChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
 /// Set a vector by another vector and indices.
+/// @details Long index vectors are checked in parallel. The items are written in order by
+/// the calling thread, so the last one wins if an index is repeated.
 /// @param v1 (VDL_VECTOR_P). A vector.
 /// @param i (VDL_VECTOR_P). A vector of indices.
 #define vdl_vector_SetByIndex(...) vdl_CallVoidFunction(vdl_vector_SetByIndex_BT, __VA_ARGS__)
@@ -31,13 +87,41 @@ static inline void vdl_vector_SetByIndex_BT(VDL_VECTOR_P v, VDL_VECTOR_P i, VDL_
  |  Subset the vector
  ----------------------------------------------------------------------------*/
 
+/// Gather the items of the first source at a chunk of the indices into the target.
+/// No checks will be performed.
+/// @details It is safe to call this function from a worker thread.
+/// @param begin (VDL_INDEX_T). Position of the first index of the chunk.
+/// @param end (VDL_INDEX_T). Position after the last index of the chunk.
+/// @param context (void *). A task (VDL_VECTOR_TASK_T *).
+static inline void vdl_SubsetUnsafeRunChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
 /// Subset the vector by indices. All attributes will be dropped.
+/// @details Long index vectors are checked and gathered in parallel.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param i (VDL_VECTOR_P). A vector of indices.
 /// @return (VDL_VECTOR_P) A shallow copy of the subset of the vector.
 #define vdl_Subset(...) vdl_CallFunction(vdl_Subset_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_Subset_BT(VDL_VECTOR_P v, VDL_VECTOR_P i);
 
+/*-----------------------------------------------------------------------------
+ |  Slice the vector
+ ----------------------------------------------------------------------------*/
+
+/// Slice the vector. All attributes will be dropped.
+/// @details Every `step` item from `start` up to but not including `end` is taken.
+/// A negative step walks backwards from `start` down to but not including `end`. \n\n
+/// A contiguous slice (`step` is 1) of a heap, file mapped or view vector is a view,
+/// which shares the data container with the vector without copying. Modifying either
+/// of them gives the modified vector a private copy first. A view of a read-only vector
+/// is read-only as well. Other slices are copied.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param start (VDL_INDEX_T). Index of the first item.
+/// @param end (VDL_INDEX_T). Index where the slice stops (exclusive).
+/// @param step (VDL_INDEX_T). Step between items. Can not be 0.
+/// @return (VDL_VECTOR_P) A shallow copy or a view of the slice of the vector.
+#define vdl_Slice(...) vdl_CallFunction(vdl_Slice_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_Slice_BT(VDL_VECTOR_P v, VDL_INDEX_T start, VDL_INDEX_T end, VDL_INDEX_T step);
+
 
 /*-----------------------------------------------------------------------------
  |  Append an item (in-place operator)
@@ -67,6 +151,12 @@ static inline void vdl_vector_primitive_AppendDouble_BT(VDL_VECTOR_T *v, double
 #define vdl_vector_primitive_AppendVectorPointer(...) vdl_CallVoidFunction(vdl_vector_primitive_AppendVectorPointer_BT, __VA_ARGS__)
 static inline void vdl_vector_primitive_AppendVectorPointer_BT(VDL_VECTOR_T *v, VDL_VECTOR_T *item);
 
+/// Append an index to a vector.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param item (VDL_INDEX_T). An item.
+#define vdl_vector_primitive_AppendIndex(...) vdl_CallVoidFunction(vdl_vector_primitive_AppendIndex_BT, __VA_ARGS__)
+static inline void vdl_vector_primitive_AppendIndex_BT(VDL_VECTOR_T *v, VDL_INDEX_T item);
+
 /// Append a vector to a vector.
 /// @param v (VDL_VECTOR_P). A vector.
 /// @param item (VDL_VECTOR_P). An item.
@@ -82,11 +172,12 @@ static inline void vdl_Extend_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const v2)
     vdl_CheckNullPointer(v1);
     vdl_CheckNullPointer(v2);
     vdl_CheckType(v1->Type, v2->Type);
+    vdl_CheckWritable(v1);
 
     if (v2->Length == 0)
         return;
 
-    vdl_vector_primitive_Reserve(v1, vdl_AddIntOverflow(v1->Length, v2->Length));
+    vdl_vector_primitive_Reserve(v1, vdl_AddIndexOverflow(v1->Length, v2->Length));
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v1, v1->Length, v2->Data, v2->Length);
     v1->Length += v2->Length;
 }
@@ -102,7 +193,7 @@ static inline int vdl_IsEmptyScalar_BT(VDL_VECTOR_T *const v)
     return v->Length == 0;
 }
 
-#define vdl_IsEmpty(v) vdl_vector_primitive_NewByInt(vdl_IsEmptyScalar(v))
+#define vdl_IsEmpty(v) vdl_vector_primitive_NewByInt(vdl_IsEmptyScalar(v), 1)
 
 /*-----------------------------------------------------------------------------
  |  Any True
@@ -133,7 +224,7 @@ static inline VDL_VECTOR_P vdl_Any_BT(VDL_VECTOR_T *const v)
     VDL_INT_ARRAY data_array    = v->Data;
     int result                  = 0;
     vdl_for_i(v->Length) result = result || data_array[i];
-    return vdl_vector_primitive_NewByInt(result);
+    return vdl_vector_primitive_NewByInt(result, 1);
 }
 
 /*-----------------------------------------------------------------------------
@@ -165,7 +256,7 @@ static inline VDL_VECTOR_P vdl_All_BT(VDL_VECTOR_T *const v)
     VDL_INT_ARRAY data_array    = v->Data;
     int result                  = 1;
     vdl_for_i(v->Length) result = result && data_array[i];
-    return vdl_vector_primitive_NewByInt(result);
+    return vdl_vector_primitive_NewByInt(result, 1);
 }
 
 /*-----------------------------------------------------------------------------
@@ -176,7 +267,7 @@ static inline VDL_VECTOR_P vdl_All_BT(VDL_VECTOR_T *const v)
 static inline VDL_VECTOR_P vdl_Length_BT(VDL_VECTOR_T *const v)
 {
     vdl_CheckNullPointer(v);
-    return vdl_vector_primitive_NewByInt(v->Length);
+    return vdl_vector_primitive_NewByIndex(v->Length, 1);
 }
 
 /*-----------------------------------------------------------------------------
@@ -187,7 +278,7 @@ static inline VDL_VECTOR_P vdl_Length_BT(VDL_VECTOR_T *const v)
 static inline VDL_VECTOR_P vdl_TypeOf_BT(VDL_VECTOR_T *const v)
 {
     vdl_CheckNullPointer(v);
-    return vdl_vector_primitive_NewByInt((int) v->Type);
+    return vdl_vector_primitive_NewByInt((int) v->Type, 1);
 }
 
 
@@ -198,7 +289,7 @@ static inline VDL_VECTOR_P vdl_TypeOf_BT(VDL_VECTOR_T *const v)
 static inline VDL_VECTOR_P vdl_ModeOf_BT(VDL_VECTOR_T *const v)
 {
     vdl_CheckNullPointer(v);
-    return vdl_vector_primitive_NewByInt((int) v->Mode);
+    return vdl_vector_primitive_NewByInt((int) v->Mode, 1);
 }
 
 /*-----------------------------------------------------------------------------
@@ -207,11 +298,10 @@ static inline VDL_VECTOR_P vdl_ModeOf_BT(VDL_VECTOR_T *const v)
 
 static inline VDL_VECTOR_P vdl_OneVector_BT(VDL_VECTOR_T *const length)
 {
-    vdl_CheckNullVectorAndNullContainer(length);
-    vdl_CheckType(length->Type, VDL_TYPE_INT);
+    vdl_CheckIndexVector(length);
     vdl_CheckLength(length->Length, 1);
 
-    const int target_length            = vdl_vector_primitive_UnsafeIntAt(length, 0);
+    const VDL_INDEX_T target_length    = vdl_vector_primitive_UnsafeIndexOf(length, 0);
     VDL_VECTOR_P v                     = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, target_length);
     v->Length                          = target_length;
     VDL_INT_ARRAY data_array           = v->Data;
@@ -226,11 +316,10 @@ static inline VDL_VECTOR_P vdl_OneVector_BT(VDL_VECTOR_T *const length)
 #define vdl_ZeroVector(...) vdl_CallFunction(vdl_ZeroVector_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_ZeroVector_BT(VDL_VECTOR_T *const length)
 {
-    vdl_CheckNullVectorAndNullContainer(length);
-    vdl_CheckType(length->Type, VDL_TYPE_INT);
+    vdl_CheckIndexVector(length);
     vdl_CheckLength(length->Length, 1);
 
-    const int target_length            = vdl_vector_primitive_UnsafeIntAt(length, 0);
+    const VDL_INDEX_T target_length    = vdl_vector_primitive_UnsafeIndexOf(length, 0);
     VDL_VECTOR_P v                     = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, target_length);
     v->Length                          = target_length;
     VDL_INT_ARRAY data_array           = v->Data;
@@ -238,10 +327,87 @@ static inline VDL_VECTOR_P vdl_ZeroVector_BT(VDL_VECTOR_T *const length)
     return v;
 }
 
+/*-----------------------------------------------------------------------------
+ |  SIMD kernels
+ ----------------------------------------------------------------------------*/
+
+/// Compare two arrays item by item with the SIMD kernels, and store 1 for equal items and 0 otherwise.
+/// @details Only a prefix whose length is a multiple of the SIMD width is compared. The caller
+/// finishes the rest with a scalar loop. Doubles are compared by `==`, so NaN is not equal to
+/// anything. No checks will be performed.
+/// @param type (VDL_TYPE_T). Type of the items.
+/// @param a (const void *). An array of `length` items.
+/// @param b (const void *). An array of `length` items, or a single item if `broadcast` is 1.
+/// @param broadcast (int). Whether to compare every item of `a` with the single item of `b`.
+/// @param result (int *). An array of `length` ints.
+/// @param length (VDL_INDEX_T). Number of items.
+/// @return (VDL_INDEX_T) Number of items compared.
+static inline VDL_INDEX_T vdl_SimdEqual(VDL_TYPE_T type, const void *a, const void *b, int broadcast, int *result, VDL_INDEX_T length);
+
+/// Count the non-zero items of an int array with the SIMD kernels.
+/// @details Only a prefix whose length is a multiple of the SIMD width is counted. The caller
+/// finishes the rest with a scalar loop. No checks will be performed.
+/// @param a (const int *). An array of `length` ints.
+/// @param length (VDL_INDEX_T). Number of items.
+/// @param count (VDL_INDEX_T *). Output. Number of non-zero items in the prefix.
+/// @return (VDL_INDEX_T) Number of items counted.
+static inline VDL_INDEX_T vdl_SimdCountNonZero(const int *a, VDL_INDEX_T length, VDL_INDEX_T *count);
+
+/// Store the indices of the non-zero items of an int array with the SIMD kernels.
+/// @details Only a prefix whose length is a multiple of the SIMD width is scanned. The caller
+/// finishes the rest with a scalar loop. No checks will be performed.
+/// @param a (const int *). An array of `length` ints.
+/// @param offset (VDL_INDEX_T). Index of the first item of `a`, which is added to every stored index.
+/// @param length (VDL_INDEX_T). Number of items.
+/// @param result (VDL_INDEX_T *). An array large enough to hold the indices of the non-zero items.
+/// @param count (VDL_INDEX_T *). Output. Number of indices stored.
+/// @return (VDL_INDEX_T) Number of items scanned.
+static inline VDL_INDEX_T vdl_SimdWhich(const int *a, VDL_INDEX_T offset, VDL_INDEX_T length, VDL_INDEX_T *result, VDL_INDEX_T *count);
+
+/// Find the first item of an array that is equal to an item with the SIMD kernels.
+/// @details Only a prefix whose length is a multiple of the SIMD width is searched, and the
+/// search stops at the first match. The caller searches the rest with a scalar loop. Doubles
+/// are compared by `==`, so NaN is not equal to anything. Chars are not supported. No checks
+/// will be performed.
+/// @param type (VDL_TYPE_T). Type of the items.
+/// @param a (const void *). An array of `length` items.
+/// @param item (const void *). An item.
+/// @param length (VDL_INDEX_T). Number of items.
+/// @param searched (VDL_INDEX_T *). Output. Length of the prefix searched if no match is found.
+/// @return (VDL_INDEX_T) Index of the first match, or -1 if no match is found in the prefix.
+static inline VDL_INDEX_T vdl_SimdFind(VDL_TYPE_T type, const void *a, const void *item, VDL_INDEX_T length, VDL_INDEX_T *searched);
+
 /*-----------------------------------------------------------------------------
  |  Strict equal
  ----------------------------------------------------------------------------*/
 
+/// Compare two arrays item by item, and store 1 for equal items and 0 otherwise.
+/// @details The SIMD kernels compare a prefix, and the scalar loops finish the rest.
+/// No checks will be performed.
+/// @param type (VDL_TYPE_T). Type of the items.
+/// @param a (const void *). An array of `length` items.
+/// @param b (const void *). An array of `length` items, or a single item if `broadcast` is 1.
+/// @param broadcast (int). Whether to compare every item of `a` with the single item of `b`.
+/// @param result (int *). An array of `length` ints.
+/// @param length (VDL_INDEX_T). Number of items.
+static inline void vdl_StrictEqualUnsafeCompareArray(VDL_TYPE_T type, const void *a, const void *b, int broadcast, int *result, VDL_INDEX_T length);
+
+/// Compare a chunk of the first source with the second source, and store the result in the
+/// target. No checks will be performed.
+/// @details It is safe to call this function from a worker thread. The second source is
+/// broadcast if it has only one item.
+/// @param begin (VDL_INDEX_T). Index of the first item of the chunk.
+/// @param end (VDL_INDEX_T). Index after the last item of the chunk.
+/// @param context (void *). A task (VDL_VECTOR_TASK_T *).
+static inline void vdl_StrictEqualUnsafeRunChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// Compare two vectors item by item.
+/// @details A vector of length 1 is compared with every item of the other vector. Vectors of
+/// different types are never equal. Long vectors are compared in parallel.
+/// @param v1 (VDL_VECTOR_P). A vector.
+/// @param v2 (VDL_VECTOR_P). Another vector.
+/// @return (VDL_VECTOR_P) An int vector of 1 for equal items and 0 otherwise.
+
 #define vdl_StrictEqual(...) vdl_CallFunction(vdl_StrictEqual_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_StrictEqual_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const v2)
 {
@@ -249,11 +415,11 @@ static inline VDL_VECTOR_P vdl_StrictEqual_BT(VDL_VECTOR_T *const v1, VDL_VECTOR
     vdl_CheckNullVectorAndNullContainer(v2);
 
     if (v1->Length == 0 || v2->Length == 0)
-        return vdl_vector_primitive_NewEmpty(v1->Type, 1);
+        return vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
 
     VDL_VECTOR_P short_v = NULL;
     VDL_VECTOR_P long_v  = NULL;
-    if (v1->Length > v2->Length)
+    if (v1->Length < v2->Length)
     {
         short_v = v1;
         long_v  = v2;
@@ -269,40 +435,16 @@ static inline VDL_VECTOR_P vdl_StrictEqual_BT(VDL_VECTOR_T *const v1, VDL_VECTOR
     if (v1->Type != v2->Type)
         return vdl_ZeroVector(vdl_Length(long_v));
 
-    VDL_VECTOR_P result             = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, long_v->Length);
-    result->Length                  = long_v->Length;
-    VDL_INT_ARRAY result_data_array = result->Data;
-    switch (long_v->Type)
-    {
-        case VDL_TYPE_CHAR:
-        {
-            VDL_CHAR_ARRAY long_data_array                 = long_v->Data;
-            VDL_CHAR_ARRAY short_data_array                = short_v->Data;
-            vdl_for_i(long_v->Length) result_data_array[i] = long_data_array[i] == short_data_array[i];
-            break;
-        }
-        case VDL_TYPE_INT:
-        {
-            VDL_INT_ARRAY long_data_array                  = long_v->Data;
-            VDL_INT_ARRAY short_data_array                 = short_v->Data;
-            vdl_for_i(long_v->Length) result_data_array[i] = long_data_array[i] == short_data_array[i];
-            break;
-        }
-        case VDL_TYPE_DOUBLE:
-        {
-            VDL_DOUBLE_ARRAY long_data_array               = long_v->Data;
-            VDL_DOUBLE_ARRAY short_data_array              = short_v->Data;
-            vdl_for_i(long_v->Length) result_data_array[i] = long_data_array[i] == short_data_array[i];
-            break;
-        }
-        case VDL_TYPE_VECTOR_POINTER:
-        {
-            VDL_VECTOR_POINTER_ARRAY long_data_array       = long_v->Data;
-            VDL_VECTOR_POINTER_ARRAY short_data_array      = short_v->Data;
-            vdl_for_i(long_v->Length) result_data_array[i] = long_data_array[i] == short_data_array[i];
-            break;
-        }
-    }
+    // The operands are compared after the result is allocated, which may run a collection
+    vdl_RootScopeBegin();
+    vdl_Root(v1);
+    vdl_Root(v2);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(VDL_TYPE_INT, long_v->Length);
+    result->Length      = long_v->Length;
+    vdl_RootScopeEnd();
+
+    VDL_VECTOR_TASK_T task = {.Target = result, .Sources = {long_v, short_v}, .Index = NULL, .Invalid = 0};
+    vdl_ParallelFor(0, long_v->Length, VDL_PARALLEL_GRAIN, vdl_StrictEqualUnsafeRunChunk, &task);
 
     return result;
 }
@@ -311,19 +453,104 @@ static inline VDL_VECTOR_P vdl_StrictEqual_BT(VDL_VECTOR_T *const v1, VDL_VECTOR
  |  Which True
  ----------------------------------------------------------------------------*/
 
+/// A task of `vdl_WhichParallel`.
+/// @param Data (const int *). Data of the int vector.
+/// @param Counts (VDL_INDEX_T *). Number of non-zero items of every grain of `VDL_PARALLEL_GRAIN` items,
+/// turned into the offsets of the grains in the result by a prefix sum.
+/// @param Result (VDL_INDEX_T *). Data of the result.
+typedef struct VDL_WHICH_TASK_T
+{
+    const int *Data;
+    VDL_INDEX_T *Counts;
+    VDL_INDEX_T *Result;
+} VDL_WHICH_TASK_T;
+
+/// Count the non-zero items of an int array. No checks will be performed.
+/// @param data (const int *). An int array.
+/// @param begin (VDL_INDEX_T). Index of the first item.
+/// @param end (VDL_INDEX_T). Index after the last item.
+/// @return (VDL_INDEX_T) The count.
+static inline VDL_INDEX_T vdl_WhichUnsafeCount(const int *data, VDL_INDEX_T begin, VDL_INDEX_T end);
+
+/// Store the indices of the non-zero items of an int array. No checks will be performed.
+/// @param data (const int *). An int array.
+/// @param begin (VDL_INDEX_T). Index of the first item.
+/// @param end (VDL_INDEX_T). Index after the last item.
+/// @param result (VDL_INDEX_T *). Where the indices are stored.
+static inline void vdl_WhichUnsafeFill(const int *data, VDL_INDEX_T begin, VDL_INDEX_T end, VDL_INDEX_T *result);
+
+/// Count the non-zero items of every grain of a chunk. No checks will be performed.
+/// @param begin (VDL_INDEX_T). Index of the first item of the chunk.
+/// @param end (VDL_INDEX_T). Index after the last item of the chunk.
+/// @param context (void *). A task (VDL_WHICH_TASK_T *).
+static inline void vdl_WhichUnsafeCountChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// Store the indices of the non-zero items of a chunk at the offset of its first grain.
+/// No checks will be performed.
+/// @param begin (VDL_INDEX_T). Index of the first item of the chunk.
+/// @param end (VDL_INDEX_T). Index after the last item of the chunk.
+/// @param context (void *). A task (VDL_WHICH_TASK_T *).
+static inline void vdl_WhichUnsafeFillChunk(VDL_INDEX_T begin, VDL_INDEX_T end, void *context);
+
+/// Find the indices of the non-zero items.
+/// @details The non-zero items are counted first, then the result is allocated at its exact
+/// length and filled. Both passes use the SIMD kernels.
+/// @param v (VDL_VECTOR_P). An int vector.
+/// @return (VDL_VECTOR_P) An index vector.
 #define vdl_Which(...) vdl_CallFunction(vdl_Which_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_Which_BT(VDL_VECTOR_T *const v)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckType(v->Type, VDL_TYPE_INT);
 
-    VDL_VECTOR_P result      = vdl_vector_primitive_NewEmpty(v->Type, 1);
-    VDL_INT_ARRAY data_array = v->Data;
-    vdl_for_i(v->Length)
+    const VDL_INDEX_T count = vdl_WhichUnsafeCount(v->Data, 0, v->Length);
+
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(VDL_TYPE_INDEX, count > 0 ? count : 1);
+    result->Length      = count;
+    vdl_RootScopeEnd();
+    vdl_WhichUnsafeFill(v->Data, 0, v->Length, result->Data);
+    return result;
+}
+
+/// Find the indices of the non-zero items with the thread pool.
+/// @details Every grain of `VDL_PARALLEL_GRAIN` items is counted by `vdl_ParallelFor`, the
+/// offsets of the grains in the result are computed by a prefix sum, then the grains are filled
+/// by `vdl_ParallelFor` again. The number of threads is set by `vdl_ThreadPoolSetThreadNum`,
+/// and short vectors are scanned by the calling thread alone.
+/// @param v (VDL_VECTOR_P). An int vector.
+/// @return (VDL_VECTOR_P) An index vector.
+#define vdl_WhichParallel(...) vdl_CallFunction(vdl_WhichParallel_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_WhichParallel_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckType(v->Type, VDL_TYPE_INT);
+
+    const VDL_INDEX_T grain_num = (v->Length + VDL_PARALLEL_GRAIN - 1) / VDL_PARALLEL_GRAIN;
+    VDL_WHICH_TASK_T task       = {.Data   = v->Data,
+                                   .Counts = vdl_Malloc(sizeof(VDL_INDEX_T) * (size_t) (grain_num > 0 ? grain_num : 1), 1, VDL_SUBSYSTEM_WORKSPACE),
+                                   .Result = NULL};
+    vdl_ParallelFor(0, v->Length, VDL_PARALLEL_GRAIN, vdl_WhichUnsafeCountChunk, &task);
+
+    VDL_INDEX_T total = 0;
+    for (VDL_INDEX_T g = 0; g < grain_num; g++)
     {
-        if (data_array[i])
-            vdl_vector_primitive_AppendInt(result, i);
+        const VDL_INDEX_T count = task.Counts[g];
+        task.Counts[g]          = total;
+        total += count;
     }
+
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(VDL_TYPE_INDEX, total > 0 ? total : 1);
+    result->Length      = total;
+    task.Result         = result->Data;
+    vdl_RootScopeEnd();
+    vdl_ParallelFor(0, v->Length, VDL_PARALLEL_GRAIN, vdl_WhichUnsafeFillChunk, &task);
+
+    vdl_ExceptionDeregisterCleanUp(task.Counts);
+    vdl_Free(task.Counts, VDL_SUBSYSTEM_WORKSPACE);
     return result;
 }
 
@@ -331,13 +558,98 @@ static inline VDL_VECTOR_P vdl_Which_BT(VDL_VECTOR_T *const v)
  |  Find the first identical element
  ----------------------------------------------------------------------------*/
 
+/// Find the first item of a vector that is equal to an item.
+/// @details The search stops at the first match, and no vector is allocated. Items are compared
+/// as in `vdl_StrictEqual`, so vectors of different types never match, and NaN is not equal
+/// to anything.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param item (VDL_VECTOR_P). A vector of length 1.
+/// @return (VDL_INDEX_T) Index of the first match, or -1 if there is no match.
+#define vdl_FindScalar(...) vdl_CallFunction(vdl_FindScalar_BT, VDL_INDEX_T, __VA_ARGS__)
+static inline VDL_INDEX_T vdl_FindScalar_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const item)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckNullVectorAndNullContainer(item);
+    vdl_CheckLength(item->Length, 1);
+
+    if (v->Type != item->Type || v->Length == 0)
+        return -1;
+
+    // The C library searches chars
+    if (v->Type == VDL_TYPE_CHAR)
+    {
+        const char *const match = memchr(v->Data, vdl_vector_primitive_UnsafeConstCharAt(item, 0), (size_t) v->Length);
+        return match == NULL ? -1 : (VDL_INDEX_T) (match - (const char *) v->Data);
+    }
+
+    // The SIMD kernels search a prefix, and the scalar loops search the rest
+    VDL_INDEX_T start       = 0;
+    const VDL_INDEX_T match = vdl_SimdFind(v->Type, v->Data, item->Data, v->Length, &start);
+    if (match != -1)
+        return match;
+
+    switch (v->Type)
+    {
+        case VDL_TYPE_CHAR:
+            break;
+        case VDL_TYPE_INT:
+        {
+            VDL_INT_ARRAY data_array = v->Data;
+            const int target         = vdl_vector_primitive_UnsafeConstIntAt(item, 0);
+            for (VDL_INDEX_T i = start; i < v->Length; i++)
+            {
+                if (data_array[i] == target)
+                    return i;
+            }
+            break;
+        }
+        case VDL_TYPE_DOUBLE:
+        {
+            VDL_DOUBLE_ARRAY data_array = v->Data;
+            const double target         = vdl_vector_primitive_UnsafeConstDoubleAt(item, 0);
+            for (VDL_INDEX_T i = start; i < v->Length; i++)
+            {
+                if (data_array[i] == target)
+                    return i;
+            }
+            break;
+        }
+        case VDL_TYPE_VECTOR_POINTER:
+        {
+            VDL_VECTOR_POINTER_ARRAY data_array = v->Data;
+            VDL_VECTOR_P target                 = vdl_vector_primitive_UnsafeVectorConstPointerAt(item, 0);
+            for (VDL_INDEX_T i = start; i < v->Length; i++)
+            {
+                if (data_array[i] == target)
+                    return i;
+            }
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_INDEX_ARRAY data_array = v->Data;
+            const VDL_INDEX_T target   = vdl_vector_primitive_UnsafeConstIndexAt(item, 0);
+            for (VDL_INDEX_T i = start; i < v->Length; i++)
+            {
+                if (data_array[i] == target)
+                    return i;
+            }
+            break;
+        }
+    }
+
+    return -1;
+}
+
+/// Find the first item of a vector that is equal to an item.
+/// @details See `vdl_FindScalar`.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @param item (VDL_VECTOR_P). A vector of length 1.
+/// @return (VDL_VECTOR_P) An index vector of length 1 holding the index of the first match, or -1 if there is no match.
+#define vdl_Find(...) vdl_CallFunction(vdl_Find_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_Find_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const item)
 {
-    VDL_VECTOR_P first_equal_index = vdl_Subset(vdl_Which(vdl_StrictEqual(v, item)),
-                                                vdl_LocalVector(0));
-    if (first_equal_index->Length == 0)
-        return vdl_vector_primitive_NewByInt(-1);
-    return first_equal_index;
+    return vdl_vector_primitive_NewByIndex(vdl_FindScalar(v, item), 1);
 }
 
 /*-----------------------------------------------------------------------------
@@ -345,13 +657,14 @@ static inline VDL_VECTOR_P vdl_Find_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *cons
  ----------------------------------------------------------------------------*/
 
 #define vdl_InsertChar(...) vdl_CallVoidFunction(vdl_InsertChar_BT, __VA_ARGS__)
-static inline void vdl_InsertChar_BT(VDL_VECTOR_T *const v, const int i, const char item)
+static inline void vdl_InsertChar_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const char item)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckIndexOutOfBound(v, i);
     vdl_CheckType(v->Type, VDL_TYPE_CHAR);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i + 1, vdl_vector_primitive_UnsafeAddressOf(v, i), v->Length - i);
     vdl_vector_primitive_UnsafeSetChar(v, i, item);
     v->Length++;
@@ -359,13 +672,14 @@ static inline void vdl_InsertChar_BT(VDL_VECTOR_T *const v, const int i, const c
 
 
 #define vdl_InsertInt(...) vdl_CallVoidFunction(vdl_InsertInt_BT, __VA_ARGS__)
-static inline void vdl_InsertInt_BT(VDL_VECTOR_T *const v, const int i, const int item)
+static inline void vdl_InsertInt_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const int item)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckIndexOutOfBound(v, i);
     vdl_CheckType(v->Type, VDL_TYPE_INT);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i + 1, vdl_vector_primitive_UnsafeAddressOf(v, i), v->Length - i);
     vdl_vector_primitive_UnsafeSetInt(v, i, item);
     v->Length++;
@@ -373,13 +687,14 @@ static inline void vdl_InsertInt_BT(VDL_VECTOR_T *const v, const int i, const in
 
 
 #define vdl_InsertDouble(...) vdl_CallVoidFunction(vdl_InsertDouble_BT, __VA_ARGS__)
-static inline void vdl_InsertDouble_BT(VDL_VECTOR_T *const v, const int i, const double item)
+static inline void vdl_InsertDouble_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const double item)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckIndexOutOfBound(v, i);
     vdl_CheckType(v->Type, VDL_TYPE_DOUBLE);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i + 1, vdl_vector_primitive_UnsafeAddressOf(v, i), v->Length - i);
     vdl_vector_primitive_UnsafeSetDouble(v, i, item);
     v->Length++;
@@ -387,26 +702,28 @@ static inline void vdl_InsertDouble_BT(VDL_VECTOR_T *const v, const int i, const
 
 
 #define vdl_InsertVectorPointer(...) vdl_CallVoidFunction(vdl_InsertVectorPointer_BT, __VA_ARGS__)
-static inline void vdl_InsertVectorPointer_BT(VDL_VECTOR_T *const v, const int i, VDL_VECTOR_T *const item)
+static inline void vdl_InsertVectorPointer_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, VDL_VECTOR_T *const item)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckIndexOutOfBound(v, i);
     vdl_CheckType(v->Type, VDL_TYPE_VECTOR_POINTER);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i + 1, vdl_vector_primitive_UnsafeAddressOf(v, i), v->Length - i);
     vdl_vector_primitive_UnsafeSetVectorPointer(v, i, item);
     v->Length++;
 }
 
 #define vdl_InsertByArray(...) vdl_CallVoidFunction(vdl_InsertByArray_BT, __VA_ARGS__)
-static inline void vdl_InsertByArray_BT(VDL_VECTOR_T *const v, const int i, const void *item_pointer, const int number)
+static inline void vdl_InsertByArray_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T i, const void *item_pointer, const VDL_INDEX_T number)
 {
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckNullArrayAndNegativeLength(item_pointer, number);
     vdl_CheckIndexOutOfBound(v, i);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, number));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, number));
     vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(v, i + number, vdl_vector_primitive_UnsafeAddressOf(v, i), number);
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v, i, item_pointer, number);
     v->Length += number;
@@ -417,14 +734,15 @@ static inline void vdl_Insert_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const i,
     vdl_CheckNullVectorAndNullContainer(v1);
     vdl_CheckNullVectorAndNullContainer(i);
     vdl_CheckNullVectorAndNullContainer(v2);
-    vdl_CheckType(i->Type, VDL_TYPE_INT);
+    vdl_CheckIndexVector(i);
     vdl_CheckLength(i->Length, 1);
     vdl_CheckType(v1->Type, v2->Type);
 
-    const int index = vdl_vector_primitive_UnsafeIntAt(i, 0);
+    const VDL_INDEX_T index = vdl_vector_primitive_UnsafeIndexOf(i, 0);
     vdl_CheckIndexOutOfBound(v1, index);
+    vdl_CheckWritable(v1);
 
-    vdl_vector_primitive_Reserve(v1, vdl_AddIntOverflow(v1->Length, v2->Length));
+    vdl_vector_primitive_Reserve(v1, vdl_AddIndexOverflow(v1->Length, v2->Length));
     vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(v1, index + v2->Length, vdl_vector_primitive_UnsafeAddressOf(v1, index), v2->Length);
     vdl_vector_primitive_UnsafeSetByArrayAndMemmove(v1, index, v2->Data, v2->Length);
     v1->Length += v2->Length;
@@ -432,10 +750,43 @@ static inline void vdl_Insert_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const i,
 
 // TODO: make member of vectors private (_name)
 
+/*-----------------------------------------------------------------------------
+ |  Shallow copy
+ ----------------------------------------------------------------------------*/
+
+/// Shallow copy a vector. All attributes will be dropped.
+/// @details A shareable data container is not copied. The copy shares it with the vector until
+/// either of them is modified through a safe setter or an in-place operator, which gives the
+/// modified vector a private copy first. The copy is writable even if the vector is read-only.
+/// @param v (VDL_VECTOR_P). A vector.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_ShallowCopy(...) vdl_CallFunction(vdl_ShallowCopy_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ShallowCopy_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+
+    if (v->Length > 0 && vdl_vector_primitive_IsShareable(v))
+        return vdl_vector_primitive_NewShared(v, 0, v->Length, 0);
+
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(v->Type, v->Capacity);
+    vdl_RootScopeEnd();
+    vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(result, 0, v->Data, v->Length);
+    result->Length = v->Length;
+    return result;
+}
+
 /*-----------------------------------------------------------------------------
  |  Concatenate two vectors
  ----------------------------------------------------------------------------*/
 
+/// Concatenate two vectors.
+/// @details If one of the vectors is empty, the result is a shallow copy of the other one,
+/// which may share its data container.
+/// @param v1 (VDL_VECTOR_P). A vector.
+/// @param v2 (VDL_VECTOR_P). Another vector.
+/// @return (VDL_VECTOR_P) A vector.
 #define vdl_Concatenate(...) vdl_CallFunction(vdl_Concatenate_BT, VDL_VECTOR_P, __VA_ARGS__)
 static inline VDL_VECTOR_P vdl_Concatenate_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const v2)
 {
@@ -443,28 +794,22 @@ static inline VDL_VECTOR_P vdl_Concatenate_BT(VDL_VECTOR_T *const v1, VDL_VECTOR
     vdl_CheckNullVectorAndNullContainer(v2);
     vdl_CheckType(v1->Type, v2->Type);
 
-    VDL_VECTOR_P result = vdl_vector_primitive_NewEmpty(v1->Type, vdl_AddIntOverflow(v1->Length, v2->Length));
+    if (v2->Length == 0)
+        return vdl_ShallowCopy(v1);
+    if (v1->Length == 0)
+        return vdl_ShallowCopy(v2);
+
+    vdl_RootScopeBegin();
+    vdl_Root(v1);
+    vdl_Root(v2);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(v1->Type, vdl_AddIndexOverflow(v1->Length, v2->Length));
+    vdl_RootScopeEnd();
     vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(result, 0, v1->Data, v1->Length);
     vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(result, v1->Length, v2->Data, v2->Length);
     result->Length = v1->Length + v2->Length;
     return result;
 }
 
-/*-----------------------------------------------------------------------------
- |  Shallow copy
- ----------------------------------------------------------------------------*/
-
-#define vdl_ShallowCopy(...) vdl_CallFunction(vdl_ShallowCopy_BT, VDL_VECTOR_P, __VA_ARGS__)
-static inline VDL_VECTOR_P vdl_ShallowCopy_BT(VDL_VECTOR_T *const v)
-{
-    vdl_CheckNullVectorAndNullContainer(v);
-
-    VDL_VECTOR_P result = vdl_vector_primitive_NewEmpty(v->Type, v->Capacity);
-    vdl_vector_primitive_UnsafeSetByArrayAndMemcpy(result, 0, v->Data, v->Length);
-    result->Length = v->Length;
-    return result;
-}
-
 /*-----------------------------------------------------------------------------
  |  New an attribute
  ----------------------------------------------------------------------------*/
@@ -475,15 +820,20 @@ static inline void vdl_vector_InitAttribute(VDL_VECTOR_T *const v)
     if (v->Attribute != NULL)
         return;
 
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+
     // Only need one space for the name vector
-    VDL_VECTOR_P attribute = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+    VDL_VECTOR_P attribute = vdl_Root(vdl_vector_primitive_NewOnHeap(VDL_TYPE_VECTOR_POINTER, 1, 1, 1));
 
     // New the name vector
-    VDL_VECTOR_P attribute_name = vdl_vector_primitive_NewEmpty(VDL_TYPE_CHAR, 1);
+    VDL_VECTOR_P attribute_name = vdl_vector_primitive_NewOnHeap(VDL_TYPE_CHAR, 1, 1, 1);
 
+    attribute->Length = 1;
     vdl_vector_primitive_SetVectorPointer(attribute, 0, attribute_name);
 
     v->Attribute = attribute;
+    vdl_RootScopeEnd();
 }
 
 
@@ -5,10 +5,108 @@
 #ifndef VDL_VDL_8_VECTOR_PORTAL_DEF_H
 #define VDL_VDL_8_VECTOR_PORTAL_DEF_H
 
+/*-----------------------------------------------------------------------------
+ |  Parallel vector operations
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_IndexUnsafeCheckChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_VECTOR_TASK_T *const task = context;
+    const VDL_VECTOR_P v          = task->Sources[0];
+    const VDL_VECTOR_P i          = task->Index;
+
+    // Chunks after an invalid index found by another chunk are skipped
+    VDL_INDEX_T invalid = __atomic_load_n(&task->Invalid, __ATOMIC_RELAXED);
+    for (VDL_INDEX_T j = begin; j < end && j < invalid; j++)
+    {
+        const VDL_INDEX_T index = vdl_vector_primitive_UnsafeIndexOf(i, j);
+        if (index == VDL_INDEX_NA || index < 0 || index >= v->Length)
+        {
+            while (j < invalid &&
+                   !__atomic_compare_exchange_n(&task->Invalid, &invalid, j, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                continue;
+            return;
+        }
+    }
+}
+
+static inline void vdl_CheckIndexVectorInBound_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const i)
+{
+    VDL_VECTOR_TASK_T task = {.Target = NULL, .Sources = {v, NULL}, .Index = i, .Invalid = i->Length};
+    vdl_ParallelFor(0, i->Length, VDL_PARALLEL_GRAIN, vdl_IndexUnsafeCheckChunk, &task);
+
+    // The checks are repeated on the first invalid index to raise the exception
+    if (task.Invalid < i->Length)
+    {
+        const VDL_INDEX_T index = vdl_vector_primitive_UnsafeIndexOf(i, task.Invalid);
+        vdl_CheckIndexNA(index);
+        vdl_CheckIndexOutOfBound(v, index);
+    }
+}
+
 /*-----------------------------------------------------------------------------
  |  Set the vector data safely
  ----------------------------------------------------------------------------*/
 
+static inline void vdl_vector_SetUnsafeRunChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_VECTOR_TASK_T *const task = context;
+    const VDL_VECTOR_P v          = task->Target;
+    const VDL_VECTOR_P value      = task->Sources[0];
+
+    if (value->Length != 1)
+    {
+        memmove(vdl_vector_primitive_UnsafeAddressOf(v, begin),
+                vdl_vector_primitive_UnsafeAddressOf(value, begin),
+                VDL_TYPE_SIZE[v->Type] * (size_t) (end - begin));
+        return;
+    }
+
+    switch (v->Type)
+    {
+        case VDL_TYPE_CHAR:
+        {
+            VDL_CHAR_ARRAY dest_array = v->Data;
+            const char element        = vdl_vector_primitive_UnsafeCharAt(value, 0);
+            for (VDL_INDEX_T i = begin; i < end; i++)
+                dest_array[i] = element;
+            break;
+        }
+        case VDL_TYPE_INT:
+        {
+            VDL_INT_ARRAY dest_array = v->Data;
+            const int element        = vdl_vector_primitive_UnsafeIntAt(value, 0);
+            for (VDL_INDEX_T i = begin; i < end; i++)
+                dest_array[i] = element;
+            break;
+        }
+        case VDL_TYPE_DOUBLE:
+        {
+            VDL_DOUBLE_ARRAY dest_array = v->Data;
+            const double element        = vdl_vector_primitive_UnsafeDoubleAt(value, 0);
+            for (VDL_INDEX_T i = begin; i < end; i++)
+                dest_array[i] = element;
+            break;
+        }
+        case VDL_TYPE_VECTOR_POINTER:
+        {
+            VDL_VECTOR_POINTER_ARRAY dest_array = v->Data;
+            VDL_VECTOR_T *const element         = vdl_vector_primitive_UnsafeVectorPointerAt(value, 0);
+            for (VDL_INDEX_T i = begin; i < end; i++)
+                dest_array[i] = element;
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_INDEX_ARRAY dest_array = v->Data;
+            const VDL_INDEX_T element  = vdl_vector_primitive_UnsafeIndexAt(value, 0);
+            for (VDL_INDEX_T i = begin; i < end; i++)
+                dest_array[i] = element;
+            break;
+        }
+    }
+}
+
 static inline void vdl_vector_Set_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const value)
 {
     vdl_CheckNullVectorAndNullContainer(v);
@@ -17,6 +115,27 @@ static inline void vdl_vector_Set_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const
     vdl_CheckZeroLength(v->Length);
     vdl_CheckIncompatibleLength(value->Length, v->Length);
 
+    vdl_vector_primitive_PrepareWrite(v);
+    VDL_VECTOR_TASK_T task = {.Target = v, .Sources = {value, NULL}, .Index = NULL, .Invalid = 0};
+    vdl_ParallelFor(0, v->Length, VDL_PARALLEL_GRAIN, vdl_vector_SetUnsafeRunChunk, &task);
+
+    if (v->Type == VDL_TYPE_VECTOR_POINTER)
+        vdl_GarbageCollectorWriteBarrier(v);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Set the vector data safely by index
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_vector_SetByIndexUnsafeRunChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_VECTOR_TASK_T *const task = context;
+    const VDL_VECTOR_P v          = task->Target;
+    const VDL_VECTOR_P value      = task->Sources[0];
+    const VDL_VECTOR_P i          = task->Index;
+
+    // The items of the value are walked by a zero step if it is broadcast
+    const VDL_INDEX_T step = value->Length == 1 ? 0 : 1;
 
     switch (v->Type)
     {
@@ -24,72 +143,48 @@ static inline void vdl_vector_Set_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const
         {
             VDL_CHAR_ARRAY dest_array = v->Data;
             VDL_CHAR_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const char element                 = src_array[0];
-                vdl_for_i(v->Length) dest_array[i] = element;
-            }
-            else
-            {
-                vdl_vector_primitive_SetByArrayAndMemmove(v, 0, value->Data, v->Length);
-            }
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                dest_array[vdl_vector_primitive_UnsafeIndexOf(i, j)] = src_array[j * step];
             break;
         }
         case VDL_TYPE_INT:
         {
             VDL_INT_ARRAY dest_array = v->Data;
             VDL_INT_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const int element                  = src_array[0];
-                vdl_for_i(v->Length) dest_array[i] = element;
-            }
-            else
-            {
-                vdl_vector_primitive_SetByArrayAndMemmove(v, 0, value->Data, v->Length);
-            }
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                dest_array[vdl_vector_primitive_UnsafeIndexOf(i, j)] = src_array[j * step];
             break;
         }
         case VDL_TYPE_DOUBLE:
         {
             VDL_DOUBLE_ARRAY dest_array = v->Data;
             VDL_DOUBLE_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const double element               = src_array[0];
-                vdl_for_i(v->Length) dest_array[i] = element;
-            }
-            else
-            {
-                vdl_vector_primitive_SetByArrayAndMemmove(v, 0, value->Data, v->Length);
-            }
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                dest_array[vdl_vector_primitive_UnsafeIndexOf(i, j)] = src_array[j * step];
             break;
         }
         case VDL_TYPE_VECTOR_POINTER:
         {
             VDL_VECTOR_POINTER_ARRAY dest_array = v->Data;
             VDL_VECTOR_POINTER_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                VDL_VECTOR_T *const element        = src_array[0];
-                vdl_for_i(v->Length) dest_array[i] = element;
-            }
-            else
-            {
-                vdl_vector_primitive_SetByArrayAndMemmove(v, 0, value->Data, v->Length);
-            }
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                dest_array[vdl_vector_primitive_UnsafeIndexOf(i, j)] = src_array[j * step];
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_INDEX_ARRAY dest_array = v->Data;
+            VDL_INDEX_ARRAY src_array  = value->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                dest_array[vdl_vector_primitive_UnsafeIndexOf(i, j)] = src_array[j * step];
             break;
         }
     }
 }
 
-/*-----------------------------------------------------------------------------
- |  Set the vector data safely by index
- ----------------------------------------------------------------------------*/
-
 static inline void vdl_vector_SetByIndex_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const i, VDL_VECTOR_T *const value)
 {
-    vdl_CheckIntVector(i);
+    vdl_CheckIndexVector(i);
     vdl_CheckNullVectorAndNullContainer(v);
     vdl_CheckNullVectorAndNullContainer(value);
     vdl_CheckType(v->Type, value->Type);
@@ -97,132 +192,174 @@ static inline void vdl_vector_SetByIndex_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T
     vdl_CheckIncompatibleLength(value->Length, i->Length);
 
     // Check index out of bound
-    VDL_INT_ARRAY index_array = i->Data;
-    vdl_for_j(i->Length)
-    {
-        const int index = index_array[j];
-        vdl_CheckIntNA(index);
-        vdl_CheckIndexOutOfBound(v, index);
-    }
+    vdl_CheckIndexVectorInBound(v, i);
+
+    // Only copy a shared data container once the write is known to succeed
+    vdl_vector_primitive_PrepareWrite(v);
+
+    // Chunks sharing a repeated index would write the same item at the same time, so the
+    // items are written by the calling thread
+    VDL_VECTOR_TASK_T task = {.Target = v, .Sources = {value, NULL}, .Index = i, .Invalid = 0};
+    vdl_vector_SetByIndexUnsafeRunChunk(0, i->Length, &task);
+
+    if (v->Type == VDL_TYPE_VECTOR_POINTER)
+        vdl_GarbageCollectorWriteBarrier(v);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Subset the vector
+ ----------------------------------------------------------------------------*/
 
+static inline void vdl_SubsetUnsafeRunChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_VECTOR_TASK_T *const task = context;
+    const VDL_VECTOR_P result     = task->Target;
+    const VDL_VECTOR_P v          = task->Sources[0];
+    const VDL_VECTOR_P i          = task->Index;
 
-    // Set the values
     switch (v->Type)
     {
         case VDL_TYPE_CHAR:
         {
-
-            VDL_CHAR_ARRAY dest_array = v->Data;
-            VDL_CHAR_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const char element                              = src_array[0];
-                vdl_for_j(i->Length) dest_array[index_array[j]] = element;
-            }
-            else
-            {
-                vdl_for_j(i->Length) dest_array[index_array[j]] = src_array[j];
-            }
+            VDL_CHAR_ARRAY result_array = result->Data;
+            VDL_CHAR_ARRAY data_array   = v->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                result_array[j] = data_array[vdl_vector_primitive_UnsafeIndexOf(i, j)];
             break;
         }
         case VDL_TYPE_INT:
         {
-            VDL_INT_ARRAY dest_array = v->Data;
-            VDL_INT_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const int element                               = src_array[0];
-                vdl_for_j(i->Length) dest_array[index_array[j]] = element;
-            }
-            else
-            {
-                vdl_for_j(i->Length) dest_array[index_array[j]] = src_array[j];
-            }
+            VDL_INT_ARRAY result_array = result->Data;
+            VDL_INT_ARRAY data_array   = v->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                result_array[j] = data_array[vdl_vector_primitive_UnsafeIndexOf(i, j)];
             break;
         }
         case VDL_TYPE_DOUBLE:
         {
-            VDL_DOUBLE_ARRAY dest_array = v->Data;
-            VDL_DOUBLE_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                const double element                            = src_array[0];
-                vdl_for_j(i->Length) dest_array[index_array[j]] = element;
-            }
-            else
-            {
-                vdl_for_j(i->Length) dest_array[index_array[j]] = src_array[j];
-            }
+            VDL_DOUBLE_ARRAY result_array = result->Data;
+            VDL_DOUBLE_ARRAY data_array   = v->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                result_array[j] = data_array[vdl_vector_primitive_UnsafeIndexOf(i, j)];
             break;
         }
         case VDL_TYPE_VECTOR_POINTER:
         {
-            VDL_VECTOR_POINTER_ARRAY dest_array = v->Data;
-            VDL_VECTOR_POINTER_ARRAY src_array  = value->Data;
-            if (value->Length == 1)
-            {
-                VDL_VECTOR_T *const element                     = src_array[0];
-                vdl_for_j(i->Length) dest_array[index_array[j]] = element;
-            }
-            else
-            {
-                vdl_for_j(i->Length) dest_array[index_array[j]] = src_array[j];
-            }
+            VDL_VECTOR_POINTER_ARRAY result_array = result->Data;
+            VDL_VECTOR_POINTER_ARRAY data_array   = v->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                result_array[j] = data_array[vdl_vector_primitive_UnsafeIndexOf(i, j)];
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_INDEX_ARRAY result_array = result->Data;
+            VDL_INDEX_ARRAY data_array   = v->Data;
+            for (VDL_INDEX_T j = begin; j < end; j++)
+                result_array[j] = data_array[vdl_vector_primitive_UnsafeIndexOf(i, j)];
             break;
         }
     }
 }
 
-/*-----------------------------------------------------------------------------
- |  Subset the vector
- ----------------------------------------------------------------------------*/
-
 static inline VDL_VECTOR_P vdl_Subset_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const i)
 {
     vdl_CheckNullVectorAndNullContainer(v);
-    vdl_CheckIntVector(i);
+    vdl_CheckIndexVector(i);
     vdl_CheckZeroLength(i->Length);
 
     // Index out of bound check
-    VDL_INT_ARRAY index_array = i->Data;
-    vdl_for_j(i->Length)
-    {
-        const int index = index_array[j];
-        vdl_CheckIntNA(index);
-        vdl_CheckIndexOutOfBound(v, index);
-    }
+    vdl_CheckIndexVectorInBound(v, i);
 
-    VDL_VECTOR_P result = vdl_vector_primitive_NewEmpty(v->Type, i->Length);
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+    vdl_Root(i);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(v->Type, i->Length);
     result->Length      = i->Length;
+    vdl_RootScopeEnd();
+
+    VDL_VECTOR_TASK_T task = {.Target = result, .Sources = {v, NULL}, .Index = i, .Invalid = 0};
+    vdl_ParallelFor(0, i->Length, VDL_PARALLEL_GRAIN, vdl_SubsetUnsafeRunChunk, &task);
+
+    if (v->Type == VDL_TYPE_VECTOR_POINTER)
+        vdl_GarbageCollectorWriteBarrier(result);
+
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+ |  Slice the vector
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_VECTOR_P vdl_Slice_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T start, const VDL_INDEX_T end, const VDL_INDEX_T step)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckIndexNA(start);
+    vdl_CheckIndexNA(end);
+    vdl_CheckIndexNA(step);
+    vdl_Expect(step != 0,
+               VDL_EXCEPTION_INVALID_SLICE,
+               "Step of a slice can not be 0!");
+    vdl_Expect(step > 0 ? 0 <= start && start <= end && end <= v->Length : -1 <= end && end <= start && start < v->Length,
+               VDL_EXCEPTION_INVALID_SLICE,
+               "Invalid slice from [" VDL_INDEX_FORMAT "] to [" VDL_INDEX_FORMAT "] by [" VDL_INDEX_FORMAT "] of a vector of length [" VDL_INDEX_FORMAT "]!",
+               start,
+               end,
+               step,
+               v->Length);
+
+    const VDL_INDEX_T distance = step > 0 ? end - start : start - end;
+    const VDL_INDEX_T length   = distance == 0 ? 0 : (distance - 1) / (step > 0 ? step : -step) + 1;
+
+    if (length == 0)
+        return vdl_vector_primitive_NewEmpty(v->Type, 1);
+
+    // A contiguous slice references the data container of the vector
+    if (step == 1 && vdl_vector_primitive_IsShareable(v))
+        return vdl_vector_primitive_NewShared(v, start, length, 1);
+
+    vdl_RootScopeBegin();
+    vdl_Root(v);
+    VDL_VECTOR_P result = vdl_vector_primitive_NewUninit(v->Type, length);
+    result->Length      = length;
+    vdl_RootScopeEnd();
 
     switch (v->Type)
     {
         case VDL_TYPE_CHAR:
         {
-            VDL_CHAR_ARRAY result_array          = result->Data;
-            VDL_CHAR_ARRAY data_array            = v->Data;
-            vdl_for_j(i->Length) result_array[j] = data_array[index_array[j]];
+            VDL_CHAR_ARRAY result_array       = result->Data;
+            VDL_CHAR_ARRAY data_array         = v->Data;
+            vdl_for_i(length) result_array[i] = data_array[start + i * step];
             break;
         }
         case VDL_TYPE_INT:
         {
-            VDL_INT_ARRAY result_array           = result->Data;
-            VDL_INT_ARRAY data_array             = v->Data;
-            vdl_for_j(i->Length) result_array[j] = data_array[index_array[j]];
+            VDL_INT_ARRAY result_array        = result->Data;
+            VDL_INT_ARRAY data_array          = v->Data;
+            vdl_for_i(length) result_array[i] = data_array[start + i * step];
             break;
         }
         case VDL_TYPE_DOUBLE:
         {
-            VDL_DOUBLE_ARRAY result_array        = result->Data;
-            VDL_DOUBLE_ARRAY data_array          = v->Data;
-            vdl_for_j(i->Length) result_array[j] = data_array[index_array[j]];
+            VDL_DOUBLE_ARRAY result_array     = result->Data;
+            VDL_DOUBLE_ARRAY data_array       = v->Data;
+            vdl_for_i(length) result_array[i] = data_array[start + i * step];
             break;
         }
         case VDL_TYPE_VECTOR_POINTER:
         {
             VDL_VECTOR_POINTER_ARRAY result_array = result->Data;
             VDL_VECTOR_POINTER_ARRAY data_array   = v->Data;
-            vdl_for_j(i->Length) result_array[j]  = data_array[index_array[j]];
+            vdl_for_i(length) result_array[i]     = data_array[start + i * step];
+            vdl_GarbageCollectorWriteBarrier(result);
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_INDEX_ARRAY result_array      = result->Data;
+            VDL_INDEX_ARRAY data_array        = v->Data;
+            vdl_for_i(length) result_array[i] = data_array[start + i * step];
             break;
         }
     }
@@ -237,8 +374,9 @@ static inline VDL_VECTOR_P vdl_Subset_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *co
 static inline void vdl_vector_primitive_AppendChar_BT(VDL_VECTOR_T *const v, const char item)
 {
     vdl_CheckCharVector(v);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetChar(v, v->Length, item);
     v->Length++;
 }
@@ -246,8 +384,9 @@ static inline void vdl_vector_primitive_AppendChar_BT(VDL_VECTOR_T *const v, con
 static inline void vdl_vector_primitive_AppendInt_BT(VDL_VECTOR_T *const v, const int item)
 {
     vdl_CheckIntVector(v);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetInt(v, v->Length, item);
     v->Length++;
 }
@@ -255,8 +394,9 @@ static inline void vdl_vector_primitive_AppendInt_BT(VDL_VECTOR_T *const v, cons
 static inline void vdl_vector_primitive_AppendDouble_BT(VDL_VECTOR_T *const v, const double item)
 {
     vdl_CheckDoubleVector(v);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetDouble(v, v->Length, item);
     v->Length++;
 }
@@ -264,11 +404,862 @@ static inline void vdl_vector_primitive_AppendDouble_BT(VDL_VECTOR_T *const v, c
 static inline void vdl_vector_primitive_AppendVectorPointer_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const item)
 {
     vdl_CheckVectorPointerVector(v);
+    vdl_CheckWritable(v);
 
-    vdl_vector_primitive_Reserve(v, vdl_AddIntOverflow(v->Length, 1));
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
     vdl_vector_primitive_UnsafeSetVectorPointer(v, v->Length, item);
     v->Length++;
 }
 
+static inline void vdl_vector_primitive_AppendIndex_BT(VDL_VECTOR_T *const v, const VDL_INDEX_T item)
+{
+    vdl_CheckNullVectorAndNullContainer(v);
+    vdl_CheckType(v->Type, VDL_TYPE_INDEX);
+    vdl_CheckWritable(v);
+
+    vdl_vector_primitive_Reserve(v, vdl_AddIndexOverflow(v->Length, 1));
+    vdl_vector_primitive_UnsafeSetIndex(v, v->Length, item);
+    v->Length++;
+}
+
+/*-----------------------------------------------------------------------------
+ |  Strict equal
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_StrictEqualUnsafeCompareArray(const VDL_TYPE_T type, const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    // The items of `b` are walked by a zero step if it is broadcast
+    const VDL_INDEX_T step  = broadcast ? 0 : 1;
+    const VDL_INDEX_T start = vdl_SimdEqual(type, a, b, broadcast, result, length);
+
+    switch (type)
+    {
+        case VDL_TYPE_CHAR:
+        {
+            VDL_CONST_CHAR_ARRAY a_array = a;
+            VDL_CONST_CHAR_ARRAY b_array = b;
+            for (VDL_INDEX_T i = start; i < length; i++)
+                result[i] = a_array[i] == b_array[i * step];
+            break;
+        }
+        case VDL_TYPE_INT:
+        {
+            VDL_CONST_INT_ARRAY a_array = a;
+            VDL_CONST_INT_ARRAY b_array = b;
+            for (VDL_INDEX_T i = start; i < length; i++)
+                result[i] = a_array[i] == b_array[i * step];
+            break;
+        }
+        case VDL_TYPE_DOUBLE:
+        {
+            VDL_CONST_DOUBLE_ARRAY a_array = a;
+            VDL_CONST_DOUBLE_ARRAY b_array = b;
+            for (VDL_INDEX_T i = start; i < length; i++)
+                result[i] = a_array[i] == b_array[i * step];
+            break;
+        }
+        case VDL_TYPE_VECTOR_POINTER:
+        {
+            VDL_VECTOR_CONST_POINTER_ARRAY a_array = a;
+            VDL_VECTOR_CONST_POINTER_ARRAY b_array = b;
+            for (VDL_INDEX_T i = start; i < length; i++)
+                result[i] = a_array[i] == b_array[i * step];
+            break;
+        }
+        case VDL_TYPE_INDEX:
+        {
+            VDL_CONST_INDEX_ARRAY a_array = a;
+            VDL_CONST_INDEX_ARRAY b_array = b;
+            for (VDL_INDEX_T i = start; i < length; i++)
+                result[i] = a_array[i] == b_array[i * step];
+            break;
+        }
+    }
+}
+
+static inline void vdl_StrictEqualUnsafeRunChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_VECTOR_TASK_T *const task = context;
+    const VDL_VECTOR_P long_v     = task->Sources[0];
+    const VDL_VECTOR_P short_v    = task->Sources[1];
+
+    // The short vector is broadcast if it has only one item
+    const int broadcast = short_v->Length == 1 && long_v->Length > 1;
+    vdl_StrictEqualUnsafeCompareArray(long_v->Type,
+                                      vdl_vector_primitive_UnsafeAddressOf(long_v, begin),
+                                      broadcast ? short_v->Data : vdl_vector_primitive_UnsafeAddressOf(short_v, begin),
+                                      broadcast,
+                                      (int *) task->Target->Data + begin,
+                                      end - begin);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Which true
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_INDEX_T vdl_WhichUnsafeCount(const int *const data, const VDL_INDEX_T begin, const VDL_INDEX_T end)
+{
+    VDL_INDEX_T count = 0;
+    for (VDL_INDEX_T i = begin + vdl_SimdCountNonZero(data + begin, end - begin, &count); i < end; i++)
+        count += data[i] != 0;
+
+    return count;
+}
+
+static inline void vdl_WhichUnsafeFill(const int *const data, const VDL_INDEX_T begin, const VDL_INDEX_T end, VDL_INDEX_T *const result)
+{
+    VDL_INDEX_T count = 0;
+    for (VDL_INDEX_T i = begin + vdl_SimdWhich(data + begin, begin, end - begin, result, &count); i < end; i++)
+    {
+        if (data[i])
+        {
+            result[count] = i;
+            count++;
+        }
+    }
+}
+
+static inline void vdl_WhichUnsafeCountChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_WHICH_TASK_T *const task = context;
+
+    // A chunk run by the calling thread alone may hold many grains
+    for (VDL_INDEX_T grain_begin = begin; grain_begin < end; grain_begin += VDL_PARALLEL_GRAIN)
+    {
+        const VDL_INDEX_T grain_end                     = end - grain_begin < VDL_PARALLEL_GRAIN ? end : grain_begin + VDL_PARALLEL_GRAIN;
+        task->Counts[grain_begin / VDL_PARALLEL_GRAIN] = vdl_WhichUnsafeCount(task->Data, grain_begin, grain_end);
+    }
+}
+
+static inline void vdl_WhichUnsafeFillChunk(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    VDL_WHICH_TASK_T *const task = context;
+
+    // The grains of a chunk are contiguous in the result, so the chunk is filled from the offset of its first grain
+    vdl_WhichUnsafeFill(task->Data, begin, end, task->Result + task->Counts[begin / VDL_PARALLEL_GRAIN]);
+}
+
+/*-----------------------------------------------------------------------------
+ |  SIMD kernels
+ ----------------------------------------------------------------------------*/
+
+#ifdef VDL_SIMD_X86
+
+// Kernels are named by the instruction set and the item width. Every kernel returns the
+// number of items processed, which is a multiple of its SIMD width.
+
+static inline VDL_INDEX_T vdl_SimdEqual8Sse2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m128i one   = _mm_set1_epi32(1);
+    const __m128i item  = _mm_set1_epi8(((const char *) b)[0]);
+    const VDL_INDEX_T n = length - length % 16;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m128i vb = broadcast ? item : _mm_loadu_si128((const __m128i *) ((const char *) b + i));
+        const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) ((const char *) a + i)), vb);
+
+        // Widen the byte masks to 32-bit masks
+        const __m128i lo = _mm_unpacklo_epi8(eq, eq);
+        const __m128i hi = _mm_unpackhi_epi8(eq, eq);
+        _mm_storeu_si128((__m128i *) (result + i), _mm_and_si128(_mm_unpacklo_epi16(lo, lo), one));
+        _mm_storeu_si128((__m128i *) (result + i + 4), _mm_and_si128(_mm_unpackhi_epi16(lo, lo), one));
+        _mm_storeu_si128((__m128i *) (result + i + 8), _mm_and_si128(_mm_unpacklo_epi16(hi, hi), one));
+        _mm_storeu_si128((__m128i *) (result + i + 12), _mm_and_si128(_mm_unpackhi_epi16(hi, hi), one));
+    }
+
+    return n;
+}
+
+static inline VDL_INDEX_T vdl_SimdEqual32Sse2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m128i one   = _mm_set1_epi32(1);
+    const __m128i item  = _mm_set1_epi32(((const int32_t *) b)[0]);
+    const VDL_INDEX_T n = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const __m128i vb = broadcast ? item : _mm_loadu_si128((const __m128i *) ((const int32_t *) b + i));
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) ((const int32_t *) a + i)), vb);
+        _mm_storeu_si128((__m128i *) (result + i), _mm_and_si128(eq, one));
+    }
+
+    return n;
+}
+
+static inline VDL_INDEX_T vdl_SimdEqual64Sse2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m128i one = _mm_set1_epi32(1);
+    int64_t first     = 0;
+    memcpy(&first, b, sizeof(int64_t));
+    const __m128i item  = _mm_set1_epi64x(first);
+    const VDL_INDEX_T n = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const __m128i vb0 = broadcast ? item : _mm_loadu_si128((const __m128i *) ((const int64_t *) b + i));
+        const __m128i vb1 = broadcast ? item : _mm_loadu_si128((const __m128i *) ((const int64_t *) b + i + 2));
+        __m128i eq0       = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) ((const int64_t *) a + i)), vb0);
+        __m128i eq1       = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) ((const int64_t *) a + i + 2)), vb1);
+
+        // SSE2 has no 64-bit comparison, so both halves of an item must be equal
+        eq0 = _mm_and_si128(eq0, _mm_shuffle_epi32(eq0, _MM_SHUFFLE(2, 3, 0, 1)));
+        eq1 = _mm_and_si128(eq1, _mm_shuffle_epi32(eq1, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        // Keep one half of each item
+        const __m128 packed = _mm_shuffle_ps(_mm_castsi128_ps(eq0), _mm_castsi128_ps(eq1), _MM_SHUFFLE(2, 0, 2, 0));
+        _mm_storeu_si128((__m128i *) (result + i), _mm_and_si128(_mm_castps_si128(packed), one));
+    }
+
+    return n;
+}
+
+static inline VDL_INDEX_T vdl_SimdEqualDoubleSse2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m128i one   = _mm_set1_epi32(1);
+    const __m128d item  = _mm_set1_pd(((const double *) b)[0]);
+    const VDL_INDEX_T n = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const __m128d vb0 = broadcast ? item : _mm_loadu_pd((const double *) b + i);
+        const __m128d vb1 = broadcast ? item : _mm_loadu_pd((const double *) b + i + 2);
+        const __m128d eq0 = _mm_cmpeq_pd(_mm_loadu_pd((const double *) a + i), vb0);
+        const __m128d eq1 = _mm_cmpeq_pd(_mm_loadu_pd((const double *) a + i + 2), vb1);
+
+        // Keep one half of each item
+        const __m128 packed = _mm_shuffle_ps(_mm_castpd_ps(eq0), _mm_castpd_ps(eq1), _MM_SHUFFLE(2, 0, 2, 0));
+        _mm_storeu_si128((__m128i *) (result + i), _mm_and_si128(_mm_castps_si128(packed), one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdEqual8Avx2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m256i one   = _mm256_set1_epi32(1);
+    const __m256i item  = _mm256_set1_epi8(((const char *) b)[0]);
+    const VDL_INDEX_T n = length - length % 32;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 32)
+    {
+        const __m256i vb = broadcast ? item : _mm256_loadu_si256((const __m256i *) ((const char *) b + i));
+        const __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) ((const char *) a + i)), vb);
+
+        // Sign extend every 8 byte masks to 32-bit masks
+        const __m128i lo = _mm256_castsi256_si128(eq);
+        const __m128i hi = _mm256_extracti128_si256(eq, 1);
+        _mm256_storeu_si256((__m256i *) (result + i), _mm256_and_si256(_mm256_cvtepi8_epi32(lo), one));
+        _mm256_storeu_si256((__m256i *) (result + i + 8), _mm256_and_si256(_mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8)), one));
+        _mm256_storeu_si256((__m256i *) (result + i + 16), _mm256_and_si256(_mm256_cvtepi8_epi32(hi), one));
+        _mm256_storeu_si256((__m256i *) (result + i + 24), _mm256_and_si256(_mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8)), one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdEqual32Avx2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m256i one   = _mm256_set1_epi32(1);
+    const __m256i item  = _mm256_set1_epi32(((const int32_t *) b)[0]);
+    const VDL_INDEX_T n = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __m256i vb = broadcast ? item : _mm256_loadu_si256((const __m256i *) ((const int32_t *) b + i));
+        const __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) ((const int32_t *) a + i)), vb);
+        _mm256_storeu_si256((__m256i *) (result + i), _mm256_and_si256(eq, one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdEqual64Avx2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    int64_t first     = 0;
+    memcpy(&first, b, sizeof(int64_t));
+    const __m256i item  = _mm256_set1_epi64x(first);
+    const VDL_INDEX_T n = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __m256i vb0 = broadcast ? item : _mm256_loadu_si256((const __m256i *) ((const int64_t *) b + i));
+        const __m256i vb1 = broadcast ? item : _mm256_loadu_si256((const __m256i *) ((const int64_t *) b + i + 4));
+        const __m256i eq0 = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) ((const int64_t *) a + i)), vb0);
+        const __m256i eq1 = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) ((const int64_t *) a + i + 4)), vb1);
+
+        // Keep one half of each item, then restore the order across the 128-bit lanes
+        const __m256 packed = _mm256_shuffle_ps(_mm256_castsi256_ps(eq0), _mm256_castsi256_ps(eq1), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256i mask  = _mm256_permute4x64_epi64(_mm256_castps_si256(packed), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *) (result + i), _mm256_and_si256(mask, one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdEqualDoubleAvx2(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m256i one   = _mm256_set1_epi32(1);
+    const __m256d item  = _mm256_set1_pd(((const double *) b)[0]);
+    const VDL_INDEX_T n = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __m256d vb0 = broadcast ? item : _mm256_loadu_pd((const double *) b + i);
+        const __m256d vb1 = broadcast ? item : _mm256_loadu_pd((const double *) b + i + 4);
+        const __m256d eq0 = _mm256_cmp_pd(_mm256_loadu_pd((const double *) a + i), vb0, _CMP_EQ_OQ);
+        const __m256d eq1 = _mm256_cmp_pd(_mm256_loadu_pd((const double *) a + i + 4), vb1, _CMP_EQ_OQ);
+
+        // Keep one half of each item, then restore the order across the 128-bit lanes
+        const __m256 packed = _mm256_shuffle_ps(_mm256_castpd_ps(eq0), _mm256_castpd_ps(eq1), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256i mask  = _mm256_permute4x64_epi64(_mm256_castps_si256(packed), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *) (result + i), _mm256_and_si256(mask, one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdEqual8Avx512(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m512i one   = _mm512_set1_epi32(1);
+    const __m512i item  = _mm512_set1_epi8(((const char *) b)[0]);
+    const VDL_INDEX_T n = length - length % 64;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 64)
+    {
+        const __m512i vb   = broadcast ? item : _mm512_loadu_si512((const char *) b + i);
+        const __mmask64 eq = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const char *) a + i), vb);
+
+        // Expand every 16 bits of the mask to 16 ints
+        _mm512_storeu_si512(result + i, _mm512_maskz_mov_epi32((__mmask16) eq, one));
+        _mm512_storeu_si512(result + i + 16, _mm512_maskz_mov_epi32((__mmask16) (eq >> 16), one));
+        _mm512_storeu_si512(result + i + 32, _mm512_maskz_mov_epi32((__mmask16) (eq >> 32), one));
+        _mm512_storeu_si512(result + i + 48, _mm512_maskz_mov_epi32((__mmask16) (eq >> 48), one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdEqual32Avx512(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m512i one   = _mm512_set1_epi32(1);
+    const __m512i item  = _mm512_set1_epi32(((const int32_t *) b)[0]);
+    const VDL_INDEX_T n = length - length % 16;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m512i vb   = broadcast ? item : _mm512_loadu_si512((const int32_t *) b + i);
+        const __mmask16 eq = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const int32_t *) a + i), vb);
+        _mm512_storeu_si512(result + i, _mm512_maskz_mov_epi32(eq, one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdEqual64Avx512(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m512i one = _mm512_set1_epi32(1);
+    int64_t first     = 0;
+    memcpy(&first, b, sizeof(int64_t));
+    const __m512i item  = _mm512_set1_epi64(first);
+    const VDL_INDEX_T n = length - length % 16;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m512i vb0  = broadcast ? item : _mm512_loadu_si512((const int64_t *) b + i);
+        const __m512i vb1  = broadcast ? item : _mm512_loadu_si512((const int64_t *) b + i + 8);
+        const __mmask8 eq0 = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const int64_t *) a + i), vb0);
+        const __mmask8 eq1 = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const int64_t *) a + i + 8), vb1);
+        const __mmask16 eq = (__mmask16) (eq0 | (unsigned) eq1 << 8);
+        _mm512_storeu_si512(result + i, _mm512_maskz_mov_epi32(eq, one));
+    }
+
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdEqualDoubleAvx512(const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+    const __m512i one   = _mm512_set1_epi32(1);
+    const __m512d item  = _mm512_set1_pd(((const double *) b)[0]);
+    const VDL_INDEX_T n = length - length % 16;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m512d vb0  = broadcast ? item : _mm512_loadu_pd((const double *) b + i);
+        const __m512d vb1  = broadcast ? item : _mm512_loadu_pd((const double *) b + i + 8);
+        const __mmask8 eq0 = _mm512_cmp_pd_mask(_mm512_loadu_pd((const double *) a + i), vb0, _CMP_EQ_OQ);
+        const __mmask8 eq1 = _mm512_cmp_pd_mask(_mm512_loadu_pd((const double *) a + i + 8), vb1, _CMP_EQ_OQ);
+        const __mmask16 eq = (__mmask16) (eq0 | (unsigned) eq1 << 8);
+        _mm512_storeu_si512(result + i, _mm512_maskz_mov_epi32(eq, one));
+    }
+
+    return n;
+}
+
+#endif//VDL_SIMD_X86
+
+static inline VDL_INDEX_T vdl_SimdEqual(const VDL_TYPE_T type, const void *const a, const void *const b, const int broadcast, int *const result, const VDL_INDEX_T length)
+{
+#ifdef VDL_SIMD_X86
+    // Items are compared by their bits, except for doubles
+    const size_t width = type == VDL_TYPE_DOUBLE ? 0 : VDL_TYPE_SIZE[type];
+
+    switch (vdl_SimdLevel())
+    {
+        case VDL_SIMD_AVX512:
+            if (width == 1)
+                return vdl_SimdEqual8Avx512(a, b, broadcast, result, length);
+            if (width == 4)
+                return vdl_SimdEqual32Avx512(a, b, broadcast, result, length);
+            if (width == 8)
+                return vdl_SimdEqual64Avx512(a, b, broadcast, result, length);
+            return vdl_SimdEqualDoubleAvx512(a, b, broadcast, result, length);
+        case VDL_SIMD_AVX2:
+            if (width == 1)
+                return vdl_SimdEqual8Avx2(a, b, broadcast, result, length);
+            if (width == 4)
+                return vdl_SimdEqual32Avx2(a, b, broadcast, result, length);
+            if (width == 8)
+                return vdl_SimdEqual64Avx2(a, b, broadcast, result, length);
+            return vdl_SimdEqualDoubleAvx2(a, b, broadcast, result, length);
+        case VDL_SIMD_SSE2:
+            if (width == 1)
+                return vdl_SimdEqual8Sse2(a, b, broadcast, result, length);
+            if (width == 4)
+                return vdl_SimdEqual32Sse2(a, b, broadcast, result, length);
+            if (width == 8)
+                return vdl_SimdEqual64Sse2(a, b, broadcast, result, length);
+            return vdl_SimdEqualDoubleSse2(a, b, broadcast, result, length);
+        case VDL_SIMD_NONE:
+            break;
+    }
+#else
+    (void) type;
+    (void) a;
+    (void) b;
+    (void) broadcast;
+    (void) result;
+    (void) length;
+#endif//VDL_SIMD_X86
+
+    return 0;
+}
+
+#ifdef VDL_SIMD_X86
+
+// Lanes count the zero items, and are added up before they could overflow
+#define VDL_SIMD_COUNT_BLOCK_LENGTH 65536
+
+static inline VDL_INDEX_T vdl_SimdCountNonZeroSse2(const int *const a, const VDL_INDEX_T length, VDL_INDEX_T *const count)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const VDL_INDEX_T n = length - length % 4;
+    VDL_INDEX_T zeros   = 0;
+
+    for (VDL_INDEX_T block = 0; block < n; block += VDL_SIMD_COUNT_BLOCK_LENGTH)
+    {
+        const VDL_INDEX_T end = n - block > VDL_SIMD_COUNT_BLOCK_LENGTH ? block + VDL_SIMD_COUNT_BLOCK_LENGTH : n;
+        __m128i acc           = _mm_setzero_si128();
+        for (VDL_INDEX_T i = block; i < end; i += 4)
+            acc = _mm_sub_epi32(acc, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a + i)), zero));
+
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i *) lanes, acc);
+        zeros += (VDL_INDEX_T) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    *count = n - zeros;
+    return n;
+}
+
+static inline VDL_INDEX_T vdl_SimdWhichSse2(const int *const a, const VDL_INDEX_T offset, const VDL_INDEX_T length, VDL_INDEX_T *const result, VDL_INDEX_T *const count)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const VDL_INDEX_T n = length - length % 4;
+    VDL_INDEX_T stored  = 0;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        // Visit the set bits of the mask of non-zero items
+        unsigned int mask = ~(unsigned int) _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a + i)), zero))) & 0xFu;
+        while (mask != 0)
+        {
+            result[stored] = offset + i + __builtin_ctz(mask);
+            stored++;
+            mask &= mask - 1;
+        }
+    }
+
+    *count = stored;
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdCountNonZeroAvx2(const int *const a, const VDL_INDEX_T length, VDL_INDEX_T *const count)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const VDL_INDEX_T n = length - length % 8;
+    VDL_INDEX_T zeros   = 0;
+
+    for (VDL_INDEX_T block = 0; block < n; block += VDL_SIMD_COUNT_BLOCK_LENGTH)
+    {
+        const VDL_INDEX_T end = n - block > VDL_SIMD_COUNT_BLOCK_LENGTH ? block + VDL_SIMD_COUNT_BLOCK_LENGTH : n;
+        __m256i acc           = _mm256_setzero_si256();
+        for (VDL_INDEX_T i = block; i < end; i += 8)
+            acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a + i)), zero));
+
+        int32_t lanes[8];
+        _mm256_storeu_si256((__m256i *) lanes, acc);
+        vdl_for_i(8) zeros += lanes[i];
+    }
+
+    *count = n - zeros;
+    return n;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdWhichAvx2(const int *const a, const VDL_INDEX_T offset, const VDL_INDEX_T length, VDL_INDEX_T *const result, VDL_INDEX_T *const count)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const VDL_INDEX_T n = length - length % 8;
+    VDL_INDEX_T stored  = 0;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        // Visit the set bits of the mask of non-zero items
+        unsigned int mask = ~(unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a + i)), zero))) & 0xFFu;
+        while (mask != 0)
+        {
+            result[stored] = offset + i + __builtin_ctz(mask);
+            stored++;
+            mask &= mask - 1;
+        }
+    }
+
+    *count = stored;
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt"))) static inline VDL_INDEX_T vdl_SimdCountNonZeroAvx512(const int *const a, const VDL_INDEX_T length, VDL_INDEX_T *const count)
+{
+    const VDL_INDEX_T n = length - length % 16;
+    VDL_INDEX_T stored  = 0;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m512i x = _mm512_loadu_si512(a + i);
+        stored += _mm_popcnt_u32(_mm512_test_epi32_mask(x, x));
+    }
+
+    *count = stored;
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt"))) static inline VDL_INDEX_T vdl_SimdWhichAvx512(const int *const a, const VDL_INDEX_T offset, const VDL_INDEX_T length, VDL_INDEX_T *const result, VDL_INDEX_T *const count)
+{
+    const VDL_INDEX_T n = length - length % 16;
+    VDL_INDEX_T stored  = 0;
+
+    // Indices of the 16 items of the current iteration
+    __m512i index_lo = _mm512_setzero_si512();
+    __m512i index_hi = _mm512_setzero_si512();
+    __m512i step     = _mm512_setzero_si512();
+    if (sizeof(VDL_INDEX_T) == sizeof(int32_t))
+    {
+        index_lo = _mm512_add_epi32(_mm512_set1_epi32((int32_t) offset), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        step     = _mm512_set1_epi32(16);
+    }
+    else
+    {
+        index_lo = _mm512_add_epi64(_mm512_set1_epi64((int64_t) offset), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+        index_hi = _mm512_add_epi64(index_lo, _mm512_set1_epi64(8));
+        step     = _mm512_set1_epi64(16);
+    }
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __m512i x      = _mm512_loadu_si512(a + i);
+        const __mmask16 mask = _mm512_test_epi32_mask(x, x);
+
+        // Pack the indices of the non-zero items to the front
+        if (sizeof(VDL_INDEX_T) == sizeof(int32_t))
+        {
+            _mm512_mask_compressstoreu_epi32(result + stored, mask, index_lo);
+            index_lo = _mm512_add_epi32(index_lo, step);
+        }
+        else
+        {
+            const __mmask8 mask_lo = (__mmask8) mask;
+            const __mmask8 mask_hi = (__mmask8) (mask >> 8);
+            _mm512_mask_compressstoreu_epi64(result + stored, mask_lo, index_lo);
+            _mm512_mask_compressstoreu_epi64(result + stored + _mm_popcnt_u32(mask_lo), mask_hi, index_hi);
+            index_lo = _mm512_add_epi64(index_lo, step);
+            index_hi = _mm512_add_epi64(index_hi, step);
+        }
+        stored += _mm_popcnt_u32(mask);
+    }
+
+    *count = stored;
+    return n;
+}
+
+#endif//VDL_SIMD_X86
+
+static inline VDL_INDEX_T vdl_SimdCountNonZero(const int *const a, const VDL_INDEX_T length, VDL_INDEX_T *const count)
+{
+#ifdef VDL_SIMD_X86
+    switch (vdl_SimdLevel())
+    {
+        case VDL_SIMD_AVX512:
+            return vdl_SimdCountNonZeroAvx512(a, length, count);
+        case VDL_SIMD_AVX2:
+            return vdl_SimdCountNonZeroAvx2(a, length, count);
+        case VDL_SIMD_SSE2:
+            return vdl_SimdCountNonZeroSse2(a, length, count);
+        case VDL_SIMD_NONE:
+            break;
+    }
+#else
+    (void) a;
+    (void) length;
+#endif//VDL_SIMD_X86
+
+    *count = 0;
+    return 0;
+}
+
+static inline VDL_INDEX_T vdl_SimdWhich(const int *const a, const VDL_INDEX_T offset, const VDL_INDEX_T length, VDL_INDEX_T *const result, VDL_INDEX_T *const count)
+{
+#ifdef VDL_SIMD_X86
+    switch (vdl_SimdLevel())
+    {
+        case VDL_SIMD_AVX512:
+            return vdl_SimdWhichAvx512(a, offset, length, result, count);
+        case VDL_SIMD_AVX2:
+            return vdl_SimdWhichAvx2(a, offset, length, result, count);
+        case VDL_SIMD_SSE2:
+            return vdl_SimdWhichSse2(a, offset, length, result, count);
+        case VDL_SIMD_NONE:
+            break;
+    }
+#else
+    (void) a;
+    (void) offset;
+    (void) length;
+    (void) result;
+#endif//VDL_SIMD_X86
+
+    *count = 0;
+    return 0;
+}
+
+#ifdef VDL_SIMD_X86
+
+// Search kernels return the index of the first match, or -1 with the searched length
+// stored in `searched`
+
+static inline VDL_INDEX_T vdl_SimdFind32Sse2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m128i target = _mm_set1_epi32(((const int32_t *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) ((const int32_t *) a + i)), target);
+        const int mask   = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+static inline VDL_INDEX_T vdl_SimdFind64Sse2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    int64_t first = 0;
+    memcpy(&first, item, sizeof(int64_t));
+    const __m128i target = _mm_set1_epi64x(first);
+    const VDL_INDEX_T n  = length - length % 2;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 2)
+    {
+        // SSE2 has no 64-bit comparison, so both halves of an item must be equal
+        __m128i eq     = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) ((const int64_t *) a + i)), target);
+        eq             = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        const int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+static inline VDL_INDEX_T vdl_SimdFindDoubleSse2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m128d target = _mm_set1_pd(((const double *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 2;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 2)
+    {
+        const int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd((const double *) a + i), target));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdFind32Avx2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m256i target = _mm256_set1_epi32(((const int32_t *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) ((const int32_t *) a + i)), target);
+        const int mask   = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdFind64Avx2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    int64_t first = 0;
+    memcpy(&first, item, sizeof(int64_t));
+    const __m256i target = _mm256_set1_epi64x(first);
+    const VDL_INDEX_T n  = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) ((const int64_t *) a + i)), target);
+        const int mask   = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx2"))) static inline VDL_INDEX_T vdl_SimdFindDoubleAvx2(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m256d target = _mm256_set1_pd(((const double *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 4;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 4)
+    {
+        const int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd((const double *) a + i), target, _CMP_EQ_OQ));
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdFind32Avx512(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m512i target = _mm512_set1_epi32(((const int32_t *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 16;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 16)
+    {
+        const __mmask16 mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const int32_t *) a + i), target);
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdFind64Avx512(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    int64_t first = 0;
+    memcpy(&first, item, sizeof(int64_t));
+    const __m512i target = _mm512_set1_epi64(first);
+    const VDL_INDEX_T n  = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __mmask8 mask = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const int64_t *) a + i), target);
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+__attribute__((target("avx512f,avx512bw"))) static inline VDL_INDEX_T vdl_SimdFindDoubleAvx512(const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    const __m512d target = _mm512_set1_pd(((const double *) item)[0]);
+    const VDL_INDEX_T n  = length - length % 8;
+
+    for (VDL_INDEX_T i = 0; i < n; i += 8)
+    {
+        const __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd((const double *) a + i), target, _CMP_EQ_OQ);
+        if (mask != 0)
+            return i + __builtin_ctz((unsigned int) mask);
+    }
+
+    *searched = n;
+    return -1;
+}
+
+#endif//VDL_SIMD_X86
+
+static inline VDL_INDEX_T vdl_SimdFind(const VDL_TYPE_T type, const void *const a, const void *const item, const VDL_INDEX_T length, VDL_INDEX_T *const searched)
+{
+    *searched = 0;
+
+#ifdef VDL_SIMD_X86
+    // Items are compared by their bits, except for doubles
+    const size_t width = type == VDL_TYPE_DOUBLE ? 0 : VDL_TYPE_SIZE[type];
+
+    switch (vdl_SimdLevel())
+    {
+        case VDL_SIMD_AVX512:
+            if (width == 4)
+                return vdl_SimdFind32Avx512(a, item, length, searched);
+            if (width == 8)
+                return vdl_SimdFind64Avx512(a, item, length, searched);
+            if (width == 0)
+                return vdl_SimdFindDoubleAvx512(a, item, length, searched);
+            break;
+        case VDL_SIMD_AVX2:
+            if (width == 4)
+                return vdl_SimdFind32Avx2(a, item, length, searched);
+            if (width == 8)
+                return vdl_SimdFind64Avx2(a, item, length, searched);
+            if (width == 0)
+                return vdl_SimdFindDoubleAvx2(a, item, length, searched);
+            break;
+        case VDL_SIMD_SSE2:
+            if (width == 4)
+                return vdl_SimdFind32Sse2(a, item, length, searched);
+            if (width == 8)
+                return vdl_SimdFind64Sse2(a, item, length, searched);
+            if (width == 0)
+                return vdl_SimdFindDoubleSse2(a, item, length, searched);
+            break;
+        case VDL_SIMD_NONE:
+            break;
+    }
+#else
+    (void) type;
+    (void) a;
+    (void) item;
+    (void) length;
+#endif//VDL_SIMD_X86
+
+    return -1;
+}
 
 #endif//VDL_VDL_8_VECTOR_PORTAL_DEF_H
@@ -0,0 +1,199 @@
+//
+// Lazy evaluation of vector operations.
+//
+
+#ifndef VDL_VDL_9_LAZY_EVALUATION_H
+#define VDL_VDL_9_LAZY_EVALUATION_H
+
+/*-----------------------------------------------------------------------------
+ |  Expression nodes
+ ----------------------------------------------------------------------------*/
+
+/// Operation of an expression node.
+/// @details
+/// VDL_OP_STRICT_EQUAL: 0, `vdl_StrictEqual`. \n\n
+/// VDL_OP_WHICH: 1, `vdl_Which`. \n\n
+/// VDL_OP_SUBSET: 2, `vdl_Subset`.
+typedef enum VDL_OP_T
+{
+    VDL_OP_STRICT_EQUAL = 0,
+    VDL_OP_WHICH        = 1,
+    VDL_OP_SUBSET       = 2
+} VDL_OP_T;
+
+/// String representation of operation of an expression node.
+static const char *const VDL_OP_STRING[3] = {
+        [VDL_OP_STRICT_EQUAL] = "VDL_OP_STRICT_EQUAL",
+        [VDL_OP_WHICH]        = "VDL_OP_WHICH",
+        [VDL_OP_SUBSET]       = "VDL_OP_SUBSET"};
+
+/// An expression node is a vector pointer vector of the class `VDL_CLASS_EXPRESSION`.
+/// The first two items are the operands, which are vectors or other expression nodes.
+/// The second operand is NULL for unary operations. The third item is an int vector
+/// storing the state of the node, indexed by the following macros.
+/// @details
+/// VDL_EXPRESSION_STATE_OP: 0, operation of the node. \n\n
+/// VDL_EXPRESSION_STATE_EPOCH: 1, epoch of the last evaluation that visited the node. \n\n
+/// VDL_EXPRESSION_STATE_REF_COUNT: 2, number of references to the node in the evaluated graph. \n\n
+/// VDL_EXPRESSION_STATE_MEMO: 3, index of the materialized value in the memo, or -1.
+#define VDL_EXPRESSION_STATE_OP 0
+#define VDL_EXPRESSION_STATE_EPOCH 1
+#define VDL_EXPRESSION_STATE_REF_COUNT 2
+#define VDL_EXPRESSION_STATE_MEMO 3
+#define VDL_EXPRESSION_STATE_LENGTH 4
+
+/// A global variable for storing the epoch of the last evaluation.
+static int vdl_GlobalVar_ExpressionEpoch = 0;
+
+/// Get the ith operand of an expression node. No checks will be performed.
+/// @param node (VDL_VECTOR_P). An expression node.
+/// @param i (int). 0 or 1.
+/// @return (VDL_VECTOR_P) An operand.
+#define vdl_ExpressionOperandAt(node, i) vdl_vector_primitive_UnsafeVectorPointerAt(node, i)
+
+/// Get the ith item of the state of an expression node. No checks will be performed.
+/// @param node (VDL_VECTOR_P). An expression node.
+/// @param i (int). One of the `VDL_EXPRESSION_STATE_*` macros.
+/// @return (int) An item of the state.
+#define vdl_ExpressionStateAt(node, i) vdl_vector_primitive_UnsafeIntAt(vdl_vector_primitive_UnsafeVectorPointerAt(node, 2), i)
+
+/// Check whether a vector is an expression node.
+/// @param v (VDL_VECTOR_P). A vector or NULL.
+/// @return (int) A boolean value.
+#define vdl_IsExpression(v) ((v) != NULL && (v)->Class == VDL_CLASS_EXPRESSION)
+
+/// New an expression node.
+/// @param op (VDL_OP_T). Operation.
+/// @param operand0 (VDL_VECTOR_P). The first operand.
+/// @param operand1 (VDL_VECTOR_P). The second operand, or NULL for unary operations.
+/// @return (VDL_VECTOR_P) An expression node.
+#define vdl_ExpressionNew(...) vdl_CallFunction(vdl_ExpressionNew_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ExpressionNew_BT(VDL_OP_T op, VDL_VECTOR_P operand0, VDL_VECTOR_P operand1);
+
+/*-----------------------------------------------------------------------------
+ |  Lazy operations
+ ----------------------------------------------------------------------------*/
+
+// Lazy operations take vectors or expression nodes, and return an expression node without
+// touching the data. Expression nodes must be evaluated by `vdl_Force` before they are
+// passed to other functions.
+
+/// Defer `vdl_StrictEqual`.
+/// @param v1 (VDL_VECTOR_P). A vector or an expression node.
+/// @param v2 (VDL_VECTOR_P). Another vector or expression node.
+/// @return (VDL_VECTOR_P) An expression node.
+#define vdl_LazyStrictEqual(...) vdl_CallFunction(vdl_LazyStrictEqual_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_LazyStrictEqual_BT(VDL_VECTOR_P v1, VDL_VECTOR_P v2);
+
+/// Defer `vdl_Which`.
+/// @param v (VDL_VECTOR_P). An int vector or an expression node.
+/// @return (VDL_VECTOR_P) An expression node.
+#define vdl_LazyWhich(...) vdl_CallFunction(vdl_LazyWhich_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_LazyWhich_BT(VDL_VECTOR_P v);
+
+/// Defer `vdl_Subset`.
+/// @param v (VDL_VECTOR_P). A vector or an expression node.
+/// @param i (VDL_VECTOR_P). An index vector or an expression node.
+/// @return (VDL_VECTOR_P) An expression node.
+#define vdl_LazySubset(...) vdl_CallFunction(vdl_LazySubset_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_LazySubset_BT(VDL_VECTOR_P v, VDL_VECTOR_P i);
+
+/*-----------------------------------------------------------------------------
+ |  Fused loops
+ ----------------------------------------------------------------------------*/
+
+/// Number of items evaluated at a time by a fused loop.
+#define VDL_EXPRESSION_BLOCK_LENGTH 1024
+
+/// Maximum number of element-wise operations fused into one loop.
+#define VDL_EXPRESSION_MAX_STEP_NUM 16
+
+/// An element-wise operation of a fused loop.
+/// @param Length (VDL_INDEX_T). Length of the result.
+/// @param Types (VDL_TYPE_T [2]). Types of the operands.
+/// @param Lengths (VDL_INDEX_T [2]). Lengths of the operands.
+/// @param Operands (VDL_VECTOR_P [2]). Materialized operands, or NULL if an operand is produced by another step.
+/// @param Inputs (int [2]). Steps producing the operands, or -1 if an operand is materialized.
+typedef struct VDL_EXPRESSION_STEP_T
+{
+    VDL_INDEX_T Length;
+    VDL_TYPE_T Types[2];
+    VDL_INDEX_T Lengths[2];
+    VDL_VECTOR_P Operands[2];
+    int Inputs[2];
+} VDL_EXPRESSION_STEP_T;
+
+/// A fused loop compiled from a tree of element-wise operations.
+/// @details A step is numbered before its operands, so the steps are run backwards,
+/// and the result of the root of the tree is in the first buffer.
+/// @param StepNum (int). Number of steps.
+/// @param Steps (VDL_EXPRESSION_STEP_T [VDL_EXPRESSION_MAX_STEP_NUM]). Steps.
+/// @param Buffers (int [VDL_EXPRESSION_MAX_STEP_NUM][VDL_EXPRESSION_BLOCK_LENGTH]). Results of the steps for the current block.
+typedef struct VDL_EXPRESSION_PLAN_T
+{
+    int StepNum;
+    VDL_EXPRESSION_STEP_T Steps[VDL_EXPRESSION_MAX_STEP_NUM];
+    int Buffers[VDL_EXPRESSION_MAX_STEP_NUM][VDL_EXPRESSION_BLOCK_LENGTH];
+} VDL_EXPRESSION_PLAN_T;
+
+/// Count the references to every node of a graph. No checks will be performed.
+/// @param node (VDL_VECTOR_P). A vector or an expression node.
+/// @param epoch (int). Epoch of the evaluation.
+static inline void vdl_ExpressionUnsafeCount(VDL_VECTOR_P node, int epoch);
+
+/// Check whether an expression node can be fused into the loop of its parent.
+/// @details Element-wise nodes that are not shared can be fused. No checks will be performed.
+/// @param node (VDL_VECTOR_P). A vector or an expression node.
+/// @return (int) A boolean value.
+static inline int vdl_ExpressionIsFusible(VDL_VECTOR_P node);
+
+/// Compile a tree of element-wise nodes into the steps of a fused loop.
+/// @details Operands that can not be fused are evaluated first.
+/// @param node (VDL_VECTOR_P). A fusible expression node.
+/// @param plan (VDL_EXPRESSION_PLAN_T *). A plan with at least one free step.
+/// @param memo (VDL_VECTOR_P). Materialized values of the shared nodes.
+/// @return (int) The step of the node.
+#define vdl_ExpressionCompile(...) vdl_CallFunction(vdl_ExpressionCompile_BT, int, __VA_ARGS__)
+static inline int vdl_ExpressionCompile_BT(VDL_VECTOR_P node, VDL_EXPRESSION_PLAN_T *plan, VDL_VECTOR_P memo);
+
+/// Run all the steps of a plan on a block of items. No checks will be performed.
+/// @param plan (VDL_EXPRESSION_PLAN_T *). A plan.
+/// @param begin (VDL_INDEX_T). Index of the first item of the block.
+/// @param length (VDL_INDEX_T). Number of items of the block.
+static inline void vdl_ExpressionUnsafeRunBlock(VDL_EXPRESSION_PLAN_T *plan, VDL_INDEX_T begin, VDL_INDEX_T length);
+
+/// Evaluate an operation on the result of a tree of element-wise nodes in one pass.
+/// @details The result of the tree is produced block by block and consumed right away,
+/// so it is never materialized.
+/// @param op (VDL_OP_T). Operation applied to the result of the tree.
+/// @param mask (VDL_VECTOR_P). A fusible expression node.
+/// @param data (VDL_VECTOR_P). The vector to subset for `VDL_OP_SUBSET`, or NULL.
+/// @param memo (VDL_VECTOR_P). Materialized values of the shared nodes.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_ExpressionFuse(...) vdl_CallFunction(vdl_ExpressionFuse_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ExpressionFuse_BT(VDL_OP_T op, VDL_VECTOR_P mask, VDL_VECTOR_P data, VDL_VECTOR_P memo);
+
+/// Evaluate an expression node.
+/// @details The value of a shared node is materialized once and stored in the memo.
+/// @param node (VDL_VECTOR_P). A vector or an expression node.
+/// @param memo (VDL_VECTOR_P). Materialized values of the shared nodes.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_ExpressionEvaluate(...) vdl_CallFunction(vdl_ExpressionEvaluate_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_ExpressionEvaluate_BT(VDL_VECTOR_P node, VDL_VECTOR_P memo);
+
+/*-----------------------------------------------------------------------------
+ |  Force the evaluation
+ ----------------------------------------------------------------------------*/
+
+/// Evaluate an expression graph.
+/// @details Chains of element-wise operations are compiled into fused loops, which are run
+/// block by block, such that their intermediates are never materialized. A `vdl_Which` or a
+/// `vdl_Subset` by a `vdl_Which` is fused into the loop of its mask. Nodes referenced more
+/// than once in the graph are materialized once. Automatic collection is paused during the
+/// evaluation.
+/// @param v (VDL_VECTOR_P). An expression node. Other vectors are returned as they are.
+/// @return (VDL_VECTOR_P) A vector.
+#define vdl_Force(...) vdl_CallFunction(vdl_Force_BT, VDL_VECTOR_P, __VA_ARGS__)
+static inline VDL_VECTOR_P vdl_Force_BT(VDL_VECTOR_P v);
+
+#endif//VDL_VDL_9_LAZY_EVALUATION_H
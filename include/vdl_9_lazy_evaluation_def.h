@@ -0,0 +1,370 @@
+//
+// Lazy evaluation of vector operations.
+//
+
+#ifndef VDL_VDL_9_LAZY_EVALUATION_DEF_H
+#define VDL_VDL_9_LAZY_EVALUATION_DEF_H
+
+/*-----------------------------------------------------------------------------
+ |  Expression nodes
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_VECTOR_P vdl_ExpressionNew_BT(const VDL_OP_T op, VDL_VECTOR_T *const operand0, VDL_VECTOR_T *const operand1)
+{
+    vdl_CheckNullPointer(operand0);
+
+    // The state is only referred by a local variable before it is stored in the node
+    vdl_GarbageCollectorCriticalBegin();
+
+    VDL_VECTOR_P state = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, VDL_EXPRESSION_STATE_LENGTH);
+    state->Length      = VDL_EXPRESSION_STATE_LENGTH;
+    vdl_vector_primitive_UnsafeSetInt(state, VDL_EXPRESSION_STATE_OP, (int) op);
+    vdl_vector_primitive_UnsafeSetInt(state, VDL_EXPRESSION_STATE_EPOCH, 0);
+    vdl_vector_primitive_UnsafeSetInt(state, VDL_EXPRESSION_STATE_REF_COUNT, 0);
+    vdl_vector_primitive_UnsafeSetInt(state, VDL_EXPRESSION_STATE_MEMO, -1);
+
+    VDL_VECTOR_P node = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 3);
+    node->Length      = 3;
+    vdl_vector_primitive_UnsafeSetVectorPointer(node, 0, operand0);
+    vdl_vector_primitive_UnsafeSetVectorPointer(node, 1, operand1);
+    vdl_vector_primitive_UnsafeSetVectorPointer(node, 2, state);
+
+    const VDL_CLASS_T class = VDL_CLASS_EXPRESSION;
+    memcpy((void *) &node->Class, &class, sizeof(VDL_CLASS_T));
+
+    vdl_GarbageCollectorCriticalEnd();
+
+    return node;
+}
+
+/*-----------------------------------------------------------------------------
+ |  Lazy operations
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_VECTOR_P vdl_LazyStrictEqual_BT(VDL_VECTOR_T *const v1, VDL_VECTOR_T *const v2)
+{
+    vdl_CheckNullPointer(v2);
+    return vdl_ExpressionNew(VDL_OP_STRICT_EQUAL, v1, v2);
+}
+
+static inline VDL_VECTOR_P vdl_LazyWhich_BT(VDL_VECTOR_T *const v)
+{
+    return vdl_ExpressionNew(VDL_OP_WHICH, v, NULL);
+}
+
+static inline VDL_VECTOR_P vdl_LazySubset_BT(VDL_VECTOR_T *const v, VDL_VECTOR_T *const i)
+{
+    vdl_CheckNullPointer(i);
+    return vdl_ExpressionNew(VDL_OP_SUBSET, v, i);
+}
+
+/*-----------------------------------------------------------------------------
+ |  Fused loops
+ ----------------------------------------------------------------------------*/
+
+static inline void vdl_ExpressionUnsafeCount(VDL_VECTOR_T *const node, const int epoch)
+{
+    if (!vdl_IsExpression(node))
+        return;
+
+    // Operands are only visited the first time the node is reached
+    if (vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_EPOCH) == epoch)
+    {
+        vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_REF_COUNT)++;
+        return;
+    }
+
+    vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_EPOCH)     = epoch;
+    vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_REF_COUNT) = 1;
+    vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_MEMO)      = -1;
+
+    vdl_ExpressionUnsafeCount(vdl_ExpressionOperandAt(node, 0), epoch);
+    vdl_ExpressionUnsafeCount(vdl_ExpressionOperandAt(node, 1), epoch);
+}
+
+static inline int vdl_ExpressionIsFusible(VDL_VECTOR_T *const node)
+{
+    return vdl_IsExpression(node) &&
+           vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_OP) == VDL_OP_STRICT_EQUAL &&
+           vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_REF_COUNT) == 1;
+}
+
+static inline int vdl_ExpressionCompile_BT(VDL_VECTOR_T *const node, VDL_EXPRESSION_PLAN_T *const plan, VDL_VECTOR_T *const memo)
+{
+    // Claim a step before the operands, so the steps of the operands come after it
+    const int id = plan->StepNum;
+    plan->StepNum++;
+
+    VDL_EXPRESSION_STEP_T step = {0};
+    for (int k = 0; k < 2; k++)
+    {
+        VDL_VECTOR_P operand = vdl_ExpressionOperandAt(node, k);
+        if (vdl_ExpressionIsFusible(operand) && plan->StepNum < VDL_EXPRESSION_MAX_STEP_NUM)
+        {
+            step.Inputs[k]   = vdl_ExpressionCompile(operand, plan, memo);
+            step.Operands[k] = NULL;
+            step.Types[k]    = VDL_TYPE_INT;
+            step.Lengths[k]  = plan->Steps[step.Inputs[k]].Length;
+        }
+        else
+        {
+            step.Inputs[k]   = -1;
+            step.Operands[k] = vdl_ExpressionEvaluate(operand, memo);
+            vdl_CheckNullVectorAndNullContainer(step.Operands[k]);
+            step.Types[k]   = step.Operands[k]->Type;
+            step.Lengths[k] = step.Operands[k]->Length;
+        }
+    }
+
+    // Same as `vdl_StrictEqual`, an empty operand gives an empty result
+    if (step.Lengths[0] == 0 || step.Lengths[1] == 0)
+    {
+        step.Length = 0;
+    }
+    else
+    {
+        const int short_k = step.Lengths[0] < step.Lengths[1] ? 0 : 1;
+        vdl_CheckIncompatibleLength(step.Lengths[short_k], step.Lengths[1 - short_k]);
+        step.Length = step.Lengths[1 - short_k];
+    }
+
+    plan->Steps[id] = step;
+    return id;
+}
+
+static inline void vdl_ExpressionUnsafeRunBlock(VDL_EXPRESSION_PLAN_T *const plan, const VDL_INDEX_T begin, const VDL_INDEX_T length)
+{
+    for (int id = plan->StepNum - 1; id >= 0; id--)
+    {
+        const VDL_EXPRESSION_STEP_T *const step = &plan->Steps[id];
+        int *const result                       = plan->Buffers[id];
+
+        // A step of length 1 only has one item, which is broadcast by the step using it
+        const VDL_INDEX_T step_begin  = step->Length == 1 ? 0 : begin;
+        const VDL_INDEX_T step_length = step->Length == 1 ? 1 : length;
+
+        if (step->Types[0] != step->Types[1])
+        {
+            memset(result, 0, sizeof(int) * (size_t) step_length);
+            continue;
+        }
+
+        const void *data[2];
+        int broadcast[2];
+        for (int k = 0; k < 2; k++)
+        {
+            broadcast[k] = step->Lengths[k] == 1 && step->Length > 1;
+            if (step->Inputs[k] >= 0)
+                data[k] = plan->Buffers[step->Inputs[k]];
+            else
+                data[k] = (const char *) step->Operands[k]->Data + (size_t) (broadcast[k] ? 0 : step_begin) * VDL_TYPE_SIZE[step->Types[k]];
+        }
+
+        // Only the second array can be broadcast
+        if (broadcast[0])
+            vdl_StrictEqualUnsafeCompareArray(step->Types[0], data[1], data[0], 1, result, step_length);
+        else
+            vdl_StrictEqualUnsafeCompareArray(step->Types[0], data[0], data[1], broadcast[1], result, step_length);
+    }
+}
+
+static inline VDL_VECTOR_P vdl_ExpressionFuse_BT(const VDL_OP_T op, VDL_VECTOR_T *const mask, VDL_VECTOR_T *const data, VDL_VECTOR_T *const memo)
+{
+    VDL_EXPRESSION_PLAN_T *const plan = vdl_Malloc(sizeof(VDL_EXPRESSION_PLAN_T), 1, VDL_SUBSYSTEM_WORKSPACE);
+    plan->StepNum                     = 0;
+    vdl_ExpressionCompile(mask, plan, memo);
+
+    const VDL_INDEX_T length = plan->Steps[0].Length;
+    const int *const block   = plan->Buffers[0];
+
+    // Indices out of bound are left for `vdl_Subset` to report
+    const int out_of_bound = op == VDL_OP_SUBSET && length > data->Length;
+    const VDL_OP_T loop_op = out_of_bound ? VDL_OP_WHICH : op;
+
+    VDL_VECTOR_P result = NULL;
+    switch (loop_op)
+    {
+        case VDL_OP_STRICT_EQUAL:
+            result         = vdl_vector_primitive_NewUninit(VDL_TYPE_INT, length > 0 ? length : 1);
+            result->Length = length;
+            break;
+        case VDL_OP_WHICH:
+            result = vdl_vector_primitive_NewUninit(VDL_TYPE_INDEX, length > 0 ? length : 1);
+            break;
+        case VDL_OP_SUBSET:
+            result = vdl_vector_primitive_NewUninit(data->Type, length > 0 ? length : 1);
+            break;
+    }
+
+    for (VDL_INDEX_T begin = 0; begin < length; begin += VDL_EXPRESSION_BLOCK_LENGTH)
+    {
+        const VDL_INDEX_T block_length = length - begin < VDL_EXPRESSION_BLOCK_LENGTH ? length - begin : VDL_EXPRESSION_BLOCK_LENGTH;
+        vdl_ExpressionUnsafeRunBlock(plan, begin, block_length);
+
+        switch (loop_op)
+        {
+            case VDL_OP_STRICT_EQUAL:
+            {
+                memcpy((int *) result->Data + begin, block, sizeof(int) * (size_t) block_length);
+                break;
+            }
+            case VDL_OP_WHICH:
+            {
+                VDL_INDEX_ARRAY result_data = result->Data;
+                VDL_INDEX_T count           = 0;
+                for (VDL_INDEX_T i = vdl_SimdWhich(block, begin, block_length, result_data + result->Length, &count); i < block_length; i++)
+                {
+                    if (block[i])
+                    {
+                        result_data[result->Length + count] = begin + i;
+                        count++;
+                    }
+                }
+                result->Length += count;
+                break;
+            }
+            case VDL_OP_SUBSET:
+            {
+                // Items are copied by their bits
+                VDL_INDEX_T count = result->Length;
+                switch (VDL_TYPE_SIZE[data->Type])
+                {
+                    case 1:
+                    {
+                        const uint8_t *const src = (const uint8_t *) data->Data + begin;
+                        uint8_t *const dest      = result->Data;
+                        vdl_for_i(block_length)
+                        {
+                            if (block[i])
+                                dest[count++] = src[i];
+                        }
+                        break;
+                    }
+                    case 4:
+                    {
+                        const uint32_t *const src = (const uint32_t *) data->Data + begin;
+                        uint32_t *const dest      = result->Data;
+                        vdl_for_i(block_length)
+                        {
+                            if (block[i])
+                                dest[count++] = src[i];
+                        }
+                        break;
+                    }
+                    default:
+                    {
+                        const uint64_t *const src = (const uint64_t *) data->Data + begin;
+                        uint64_t *const dest      = result->Data;
+                        vdl_for_i(block_length)
+                        {
+                            if (block[i])
+                                dest[count++] = src[i];
+                        }
+                        break;
+                    }
+                }
+                result->Length = count;
+                break;
+            }
+        }
+    }
+
+    vdl_ExceptionDeregisterCleanUp(plan);
+    vdl_Free(plan, VDL_SUBSYSTEM_WORKSPACE);
+
+    if (out_of_bound)
+        return vdl_Subset(data, result);
+
+    // Behave as `vdl_Subset`, which rejects an empty selection
+    if (op == VDL_OP_SUBSET)
+    {
+        vdl_CheckZeroLength(result->Length);
+        if (data->Type == VDL_TYPE_VECTOR_POINTER)
+            vdl_GarbageCollectorWriteBarrier(result);
+    }
+
+    return result;
+}
+
+static inline VDL_VECTOR_P vdl_ExpressionEvaluate_BT(VDL_VECTOR_T *const node, VDL_VECTOR_T *const memo)
+{
+    vdl_CheckNullPointer(node);
+
+    if (!vdl_IsExpression(node))
+        return node;
+
+    const int memo_index = vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_MEMO);
+    if (memo_index >= 0)
+        return vdl_vector_primitive_UnsafeVectorPointerAt(memo, memo_index);
+
+    VDL_VECTOR_P result = NULL;
+    switch ((VDL_OP_T) vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_OP))
+    {
+        case VDL_OP_STRICT_EQUAL:
+        {
+            result = vdl_ExpressionFuse(VDL_OP_STRICT_EQUAL, node, NULL, memo);
+            break;
+        }
+        case VDL_OP_WHICH:
+        {
+            VDL_VECTOR_P mask = vdl_ExpressionOperandAt(node, 0);
+            if (vdl_ExpressionIsFusible(mask))
+                result = vdl_ExpressionFuse(VDL_OP_WHICH, mask, NULL, memo);
+            else
+                result = vdl_Which(vdl_ExpressionEvaluate(mask, memo));
+            break;
+        }
+        case VDL_OP_SUBSET:
+        {
+            VDL_VECTOR_P data  = vdl_ExpressionEvaluate(vdl_ExpressionOperandAt(node, 0), memo);
+            VDL_VECTOR_P index = vdl_ExpressionOperandAt(node, 1);
+            vdl_CheckNullVectorAndNullContainer(data);
+
+            // Subset by an unshared which of a fusible mask is a filter
+            if (vdl_IsExpression(index) &&
+                vdl_ExpressionStateAt(index, VDL_EXPRESSION_STATE_OP) == VDL_OP_WHICH &&
+                vdl_ExpressionStateAt(index, VDL_EXPRESSION_STATE_REF_COUNT) == 1 &&
+                vdl_ExpressionIsFusible(vdl_ExpressionOperandAt(index, 0)))
+                result = vdl_ExpressionFuse(VDL_OP_SUBSET, vdl_ExpressionOperandAt(index, 0), data, memo);
+            else
+                result = vdl_Subset(data, vdl_ExpressionEvaluate(index, memo));
+            break;
+        }
+    }
+
+    if (vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_REF_COUNT) > 1)
+    {
+        vdl_ExpressionStateAt(node, VDL_EXPRESSION_STATE_MEMO) = (int) memo->Length;
+        vdl_vector_primitive_AppendVectorPointer(memo, result);
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+ |  Force the evaluation
+ ----------------------------------------------------------------------------*/
+
+static inline VDL_VECTOR_P vdl_Force_BT(VDL_VECTOR_T *const v)
+{
+    vdl_CheckNullPointer(v);
+
+    if (!vdl_IsExpression(v))
+        return v;
+
+    // Intermediates are only referred by local variables and the memo
+    vdl_GarbageCollectorCriticalBegin();
+
+    // A new epoch resets the states of the nodes when they are first reached
+    vdl_GlobalVar_ExpressionEpoch = vdl_GlobalVar_ExpressionEpoch == INT_MAX ? 1 : vdl_GlobalVar_ExpressionEpoch + 1;
+    vdl_ExpressionUnsafeCount(v, vdl_GlobalVar_ExpressionEpoch);
+
+    VDL_VECTOR_P memo   = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+    VDL_VECTOR_P result = vdl_ExpressionEvaluate(v, memo);
+
+    vdl_GarbageCollectorCriticalEnd();
+
+    return result;
+}
+
+#endif//VDL_VDL_9_LAZY_EVALUATION_DEF_H
@@ -1,4 +1,7 @@
-source_filenames = ["test_vdlutil/test_vdlutil.c", "test_vdlerr/test_vdlerr.c", "test_vdlbt/test_vdlbt.c"]
+source_filenames = ["test_vdlutil/test_vdlutil.c", "test_vdlerr/test_vdlerr.c", "test_vdlbt/test_vdlbt.c",
+                    "test_vdlgc/test_vdlgc.c", "test_vdlmem/test_vdlmem.c",
+                    "test_vdlsimd/test_vdlsimd.c", "test_vdllazy/test_vdllazy.c",
+                    "test_vdlparallel/test_vdlparallel.c"]
 
 expected_output = []
 expected_exitcode = []
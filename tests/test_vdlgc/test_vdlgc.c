@@ -0,0 +1,396 @@
+//
+// Tests of the garbage collector.
+//
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../../include/vdl.h"
+#include "../test.h"
+
+#define TEST_GRAPH_SIZE 20000
+
+static void test_ThrowInRootScope(void)
+{
+    vdl_RootScopeBegin();
+    vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2));
+    vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2));
+    vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+}
+
+static void test_VectorTable(void)
+{
+    static VDL_VECTOR_P vs[TEST_GRAPH_SIZE];
+
+    // echo
+    echo("Test vdl_VectorTableRecord and vdl_VectorTableUntrack:");
+    vdl_GarbageCollectorInit();
+    vdl_for_i(TEST_GRAPH_SIZE) vs[i] = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_Nursery->Length == TEST_GRAPH_SIZE);
+    int found = 1;
+    vdl_for_i(TEST_GRAPH_SIZE) found &= vdl_FindInVectorTable(vdl_GlobalVar_Nursery, vs[i]) >= 0;
+    // expect(1)
+    test_printf("%d", found);
+
+    for (int i = 0; i < TEST_GRAPH_SIZE; i += 2)
+        vdl_VectorTableUntrack(vdl_GlobalVar_Nursery, vs[i], 0);
+    found = 1;
+    vdl_for_i(TEST_GRAPH_SIZE) found &= (vdl_FindInVectorTable(vdl_GlobalVar_Nursery, vs[i]) < 0) == (i % 2 == 0);
+    // expect(1)
+    test_printf("%d", found);
+    int count = 0;
+    vdl_VectorTableForEach(vdl_GlobalVar_Nursery, slot) count++;
+    // expect(10000)
+    test_printf("%d", count);
+
+    // The untracked vectors are no longer owned by the collector
+    for (int i = 0; i < TEST_GRAPH_SIZE; i += 2)
+        vdl_FreeVector(vs[i]);
+    VDL_VECTOR_P root = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 2);
+    vdl_vector_primitive_AppendVectorPointer(root, vs[1]);
+    vdl_vector_primitive_AppendVectorPointer(root, vs[3]);
+    vdl_DeclareDirectlyReachable(root);
+    vdl_GarbageCollectorCleanUp();
+    // expect(3)
+    test_printf("%d", vdl_GlobalVar_VectorTable->Length + vdl_GlobalVar_Nursery->Length);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_SweepStatistics(void)
+{
+    // echo
+    echo("Test vdl_GarbageCollectorCleanUp statistics:");
+    VDL_VECTOR_P keep = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 2);
+    vdl_for_i(1000) vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 10);
+    VDL_VECTOR_P child = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 4);
+    child->Attribute   = vdl_vector_primitive_NewEmpty(VDL_TYPE_CHAR, 4);
+    vdl_vector_primitive_AppendVectorPointer(keep, child);
+    vdl_DeclareDirectlyReachable(keep);
+
+    const VDL_GARBAGE_COLLECTOR_STATS_T before = vdl_GarbageCollectorStats();
+    // expect(1003)
+    test_printf("%zu", before.LiveObject);
+    const VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorCleanUp();
+    // expect(1000)
+    test_printf("%d", result.ObjectFreed);
+    // expect(1)
+    test_printf("%d", result.BytesFreed >= 1000 * 10 * sizeof(double));
+    // expect(1)
+    test_printf("%d", result.Completed && result.PauseTime >= 0);
+
+    const VDL_GARBAGE_COLLECTOR_STATS_T after = vdl_GarbageCollectorStats();
+    // expect(3)
+    test_printf("%zu", after.LiveObject);
+    // expect(1)
+    test_printf("%d", after.Collection == before.Collection + 1 && after.TotalLiveBytes < before.TotalLiveBytes);
+    vdl_GarbageCollectorKill();
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_VectorTable == NULL);
+}
+
+static void test_SweepWrap(void)
+{
+    static VDL_VECTOR_P vs[TEST_GRAPH_SIZE];
+
+    // echo
+    echo("Test vdl_GarbageCollectorCleanUp with a probe sequence wrapping around the table:");
+    vdl_GarbageCollectorInit();
+    const int last = vdl_GlobalVar_VectorTable->Capacity - 1;
+
+    // Promote two vectors homed at the last slot, so the second one wraps to the first slot
+    int found = 0;
+    vdl_for_i(TEST_GRAPH_SIZE)
+    {
+        vs[i] = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+        if (found < 2 && vdl_VectorTableHomeSlot(vdl_GlobalVar_VectorTable, vs[i]) == last)
+        {
+            vdl_DeclareDirectlyReachable(vs[i]);
+            found++;
+        }
+    }
+    vdl_GarbageCollectorMinorCleanUp();
+    VDL_VECTOR_CONST_POINTER_ARRAY slots = vdl_GlobalVar_VectorTable->Data;
+    VDL_VECTOR_P dead                    = slots[last];
+    VDL_VECTOR_P alive                   = slots[0];
+    // expect(2 1)
+    test_printf("%d %d", vdl_GlobalVar_VectorTable->Length, dead != NULL && alive != NULL);
+
+    // Removing the last slot shifts the survivor back across the end of the table
+    vdl_DeclareDirectlyUnreachable(dead);
+    const VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorCleanUp();
+    // expect(1 1)
+    test_printf("%d %d", result.ObjectFreed, result.BytesSurvived == vdl_vector_primitive_SizeOfVector(alive));
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_VectorTable->Length == 1 && vdl_FindInVectorTable(vdl_GlobalVar_VectorTable, alive) >= 0);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Nursery(void)
+{
+    // echo
+    echo("Test vdl_GarbageCollectorMinorCleanUp and the remembered set:");
+    VDL_VECTOR_P root = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 4);
+    root->Length      = 4;
+    vdl_DeclareDirectlyReachable(root);
+    vdl_for_i(100) vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3);
+    VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorMinorCleanUp();
+    // expect(100 1)
+    test_printf("%d %d", result.ObjectFreed, result.ObjectPromoted);
+    // expect(1)
+    test_printf("%d", (root->Flag & VDL_FLAG_OLD) != 0);
+
+    // An old vector pointing to a young one is remembered by the write barrier
+    VDL_VECTOR_P young = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+    young->Length      = 1;
+    vdl_vector_primitive_SetVectorPointer(root, 0, young);
+    vdl_vector_primitive_SetVectorPointer(young, 0, vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 2));
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_RememberedSet->Length);
+    vdl_for_i(50) vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3);
+    result = vdl_GarbageCollectorMinorCleanUp();
+    // expect(50 2)
+    test_printf("%d %d", result.ObjectFreed, result.ObjectPromoted);
+    // expect(0)
+    test_printf("%d", (root->Flag & VDL_FLAG_REMEMBERED) != 0);
+
+    // Old garbage is only reclaimed by a full collection
+    vdl_vector_primitive_SetVectorPointer(root, 0, NULL);
+    vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3);
+    result = vdl_GarbageCollectorMinorCleanUp();
+    // expect(1)
+    test_printf("%d", result.ObjectFreed);
+    result = vdl_GarbageCollectorCleanUp();
+    // expect(2 1)
+    test_printf("%d %d", result.ObjectFreed, vdl_GlobalVar_VectorTable->Length);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Incremental(void)
+{
+    // echo
+    echo("Test vdl_GarbageCollectorStep and the write barrier:");
+    VDL_VECTOR_P root = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 2000);
+    root->Length      = 2000;
+    vdl_DeclareDirectlyReachable(root);
+    vdl_for_i(1000)
+    {
+        VDL_VECTOR_P child = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+        child->Length      = 1;
+        vdl_vector_primitive_SetVectorPointer(child, 0, vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1));
+        vdl_vector_primitive_SetVectorPointer(root, i, child);
+    }
+    vdl_GarbageCollectorCleanUp();
+    vdl_for_i(500) vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3);
+
+    // Move a white grandchild from a grey parent to a black one in the middle of the cycle
+    int step = 0, freed = 0, colour = 1;
+    VDL_VECTOR_P moved = NULL;
+    VDL_GARBAGE_COLLECTOR_RESULT_T result;
+    do
+    {
+        result = vdl_GarbageCollectorStep(50, 0);
+        freed += result.ObjectFreed;
+        if (step == 5)
+        {
+            VDL_VECTOR_P grey  = vdl_vector_primitive_GetVectorPointer(root, 0);
+            VDL_VECTOR_P black = vdl_vector_primitive_GetVectorPointer(root, 999);
+            moved              = vdl_vector_primitive_GetVectorPointer(grey, 0);
+            colour             = !vdl_IsMarked(moved) && vdl_IsMarked(black);
+            vdl_vector_primitive_SetVectorPointer(black, 0, moved);
+            vdl_vector_primitive_SetVectorPointer(grey, 0, NULL);
+            vdl_vector_primitive_SetVectorPointer(root, 1500, vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 4));
+        }
+        step++;
+    } while (!result.Completed && step < 10000);
+    // expect(1)
+    test_printf("%d", colour && step > 5);
+    // expect(500)
+    test_printf("%d", freed);
+    // expect(1)
+    test_printf("%d", vdl_FindInVectorTable(vdl_GlobalVar_VectorTable, moved) >= 0);
+
+    // The grandchild overwritten above is freed by the next cycle
+    result = vdl_GarbageCollectorStep(0, 100.0);
+    while (!result.Completed)
+        result = vdl_GarbageCollectorStep(0, 100.0);
+    // expect(1)
+    test_printf("%d", result.ObjectFreed);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_ParallelMark(void)
+{
+    static VDL_VECTOR_P vs[TEST_GRAPH_SIZE];
+    static char serial[TEST_GRAPH_SIZE];
+
+    // echo
+    echo("Test the parallel mark phase:");
+    srand(7);
+    vdl_for_i(TEST_GRAPH_SIZE) vs[i] = vdl_vector_primitive_NewEmpty(rand() % 3 == 0 ? VDL_TYPE_INT : VDL_TYPE_VECTOR_POINTER, 4);
+    vdl_for_i(TEST_GRAPH_SIZE)
+    {
+        if (vs[i]->Type != VDL_TYPE_VECTOR_POINTER)
+            continue;
+        vs[i]->Length = rand() % 5;
+        vdl_for_j(vs[i]->Length) vdl_vector_primitive_SetVectorPointer(vs[i], j, rand() % 4 ? vs[rand() % TEST_GRAPH_SIZE] : NULL);
+        if (rand() % 10 == 0)
+            vs[i]->Attribute = vs[rand() % TEST_GRAPH_SIZE];
+    }
+    vdl_for_i(5) vdl_DeclareDirectlyReachable(vs[rand() % TEST_GRAPH_SIZE]);
+
+    vdl_ThreadPoolSetThreadNum(1);
+    vdl_UpdateReachable();
+    int marked = 0;
+    vdl_for_i(TEST_GRAPH_SIZE)
+    {
+        serial[i] = (char) vdl_IsMarked(vs[i]);
+        marked += serial[i];
+    }
+    int same = 1;
+    for (int thread_num = 2; thread_num <= 8; thread_num *= 2)
+    {
+        vdl_ThreadPoolSetThreadNum(thread_num);
+        vdl_UpdateReachable();
+        vdl_for_i(TEST_GRAPH_SIZE) same &= (char) vdl_IsMarked(vs[i]) == serial[i];
+    }
+    // expect(1)
+    test_printf("%d", same);
+
+    // The workers are kept by the thread pool between marks
+    // expect(7)
+    test_printf("%d", vdl_GlobalVar_ThreadPool.StartedNum);
+    const VDL_GARBAGE_COLLECTOR_RESULT_T result = vdl_GarbageCollectorCleanUp();
+    // expect(1)
+    test_printf("%d", result.ObjectFreed == TEST_GRAPH_SIZE - marked);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_AutoCollection(void)
+{
+    // echo
+    echo("Test vdl_GarbageCollectorSetGrowthFactor and vdl_GarbageCollectorPoll:");
+    vdl_DeclareDirectlyReachable(vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1));
+    vdl_GarbageCollectorSetGrowthFactor(100);
+
+    // Allocations run the collections without a safepoint
+    vdl_for_i(20000) vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 128);
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_VectorTable->Length + vdl_GlobalVar_Nursery->Length < 20000);
+
+    // The collection waits for the end of a critical section
+    vdl_GarbageCollectorCleanUp();
+    vdl_GarbageCollectorCriticalBegin();
+    vdl_for_i(10000) vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 128);
+    vdl_GarbageCollectorPoll();
+    vdl_GarbageCollectorCriticalEnd();
+    // expect(10001 1)
+    test_printf("%d %d", vdl_GlobalVar_VectorTable->Length + vdl_GlobalVar_Nursery->Length, vdl_GlobalVar_AutoCollection.Pending);
+    vdl_GarbageCollectorPoll();
+    // expect(1 0)
+    test_printf("%d %d", vdl_GlobalVar_VectorTable->Length + vdl_GlobalVar_Nursery->Length, vdl_GlobalVar_AutoCollection.Pending);
+
+    // Or for the next allocation, which is not swept
+    vdl_GarbageCollectorCriticalBegin();
+    vdl_for_i(10000) vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 128);
+    vdl_GarbageCollectorCriticalEnd();
+    vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    // expect(2 0)
+    test_printf("%d %d", vdl_GlobalVar_VectorTable->Length + vdl_GlobalVar_Nursery->Length, vdl_GlobalVar_AutoCollection.Pending);
+
+    // Operations root their operands, so unrooted intermediate results survive collections inside them
+    vdl_GarbageCollectorSetGrowthFactor(0);
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3000000));
+    VDL_VECTOR_P b = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 3000000));
+    a->Length      = 3000000;
+    b->Length      = 3000000;
+    vdl_for_i(3000000)
+    {
+        vdl_vector_primitive_UnsafeSetInt(a, i, (int) (i % 2));
+        vdl_vector_primitive_UnsafeSetInt(b, i, (int) (i % 4));
+    }
+    const size_t collection = vdl_GarbageCollectorStats().Collection;
+    VDL_VECTOR_P s          = vdl_Subset(a, vdl_Which(vdl_StrictEqual(a, b)));
+    int agree               = 1;
+    vdl_for_i(s->Length) agree &= vdl_vector_primitive_GetInt(s, i) == (int) (i % 2);
+    // expect(1500000 1 3)
+    test_printf("%d %d %d", (int) s->Length, agree, (int) (vdl_GarbageCollectorStats().Collection - collection));
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorPoll();
+    // expect(1)
+    test_printf("%zu", vdl_GarbageCollectorStats().LiveObject);
+    vdl_GarbageCollectorSetGrowthFactor(VDL_AUTO_COLLECTION_OFF);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_CriticalSection(void)
+{
+    // echo
+    echo("Test critical sections with exceptions:");
+    vdl_GarbageCollectorCriticalBegin();
+    vdl_Try
+    {
+        vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+    }
+    vdl_Catch {}
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_AutoCollection.CriticalDepth);
+    vdl_GarbageCollectorCriticalEnd();
+    vdl_Try
+    {
+        vdl_GarbageCollectorCriticalBegin();
+        vdl_GarbageCollectorCriticalBegin();
+        vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+    }
+    vdl_Catch {}
+    // expect(0)
+    test_printf("%d", vdl_GlobalVar_AutoCollection.CriticalDepth);
+}
+
+static void test_RootScope(void)
+{
+    // echo
+    echo("Test root scopes with exceptions:");
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 2));
+    vdl_vector_primitive_AppendVectorPointer(a, vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2));
+    vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2);
+    // expect(1)
+    test_printf("%d", vdl_GarbageCollectorCleanUp().ObjectFreed);
+
+    int caught = 0;
+    vdl_Try
+    {
+        vdl_RootScopeBegin();
+        vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2));
+        test_ThrowInRootScope();
+    }
+    vdl_Catch
+    {
+        caught = vdl_GlobalVar_ExceptionFrames.Exception == VDL_EXCEPTION_NULL_POINTER;
+    }
+    // expect(1 1 1)
+    test_printf("%d %d %d", caught, vdl_GlobalVar_RootScopes.Length, vdl_GlobalVar_RootStack.Length);
+    // expect(3)
+    test_printf("%d", vdl_GarbageCollectorCleanUp().ObjectFreed);
+    vdl_RootScopeEnd();
+    // expect(2)
+    test_printf("%d", vdl_GarbageCollectorCleanUp().ObjectFreed);
+    vdl_GarbageCollectorKill();
+}
+
+int main(void)
+{
+    test_VectorTable();
+    test_SweepStatistics();
+    test_SweepWrap();
+    test_Nursery();
+    test_Incremental();
+    test_ParallelMark();
+    test_AutoCollection();
+    test_CriticalSection();
+    test_RootScope();
+
+    // exit(0)
+    return 0;
+}
@@ -0,0 +1,189 @@
+//
+// Tests of the lazy expressions against the eager operations.
+//
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../../include/vdl.h"
+#include "../test.h"
+
+static const VDL_INDEX_T test_Lengths[] = {1, 2, 5, 1023, 1024, 1025, 5000};
+
+#define TEST_LENGTH_NUM ((int) (sizeof(test_Lengths) / sizeof(test_Lengths[0])))
+
+static int test_Same(VDL_VECTOR_P x, VDL_VECTOR_P y)
+{
+    if (x->Type != y->Type || x->Length != y->Length)
+        return 0;
+    return x->Length == 0 || memcmp(x->Data, y->Data, VDL_TYPE_SIZE[x->Type] * (size_t) x->Length) == 0;
+}
+
+static VDL_VECTOR_P test_RandomInt(const VDL_INDEX_T length, const int range)
+{
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, length > 0 ? length : 1);
+    v->Length      = length;
+    vdl_for_i(length) vdl_vector_primitive_UnsafeSetInt(v, i, rand() % range);
+    return v;
+}
+
+static void test_Force(void)
+{
+    int same_equal = 1, same_which = 1, same_subset = 1, same_exception = 1;
+
+    // echo
+    echo("Test vdl_Force against the eager operations:");
+    vdl_for_i(TEST_LENGTH_NUM)
+    {
+        vdl_for_j(5)
+        {
+            vdl_RootScopeBegin();
+            const VDL_INDEX_T n = test_Lengths[i];
+            VDL_VECTOR_P a      = vdl_Root(test_RandomInt(n, 3));
+            VDL_VECTOR_P b      = vdl_Root(test_RandomInt(n, 3));
+            VDL_VECTOR_P c      = vdl_Root(test_RandomInt(n, 2));
+            VDL_VECTOR_P one    = vdl_Root(vdl_vector_primitive_NewByInt(1, 1));
+            VDL_VECTOR_P d      = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, n));
+            d->Length           = n;
+            for (VDL_INDEX_T k = 0; k < n; k++)
+                vdl_vector_primitive_UnsafeSetDouble(d, k, (double) k * 0.5);
+
+            // Broadcasting, mixed types and nested comparisons
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(a, b)), vdl_StrictEqual(a, b));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(a, one)), vdl_StrictEqual(a, one));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(one, a)), vdl_StrictEqual(one, a));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(a, d)), vdl_StrictEqual(a, d));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(vdl_LazyStrictEqual(a, b), c)),
+                                    vdl_StrictEqual(vdl_StrictEqual(a, b), c));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(vdl_LazyStrictEqual(a, one), vdl_LazyStrictEqual(b, c))),
+                                    vdl_StrictEqual(vdl_StrictEqual(a, one), vdl_StrictEqual(b, c)));
+            same_equal &= test_Same(vdl_Force(vdl_LazyStrictEqual(vdl_LazyStrictEqual(one, one), c)),
+                                    vdl_StrictEqual(vdl_StrictEqual(one, one), c));
+
+            VDL_VECTOR_P w = vdl_Which(vdl_StrictEqual(a, b));
+            same_which &= test_Same(vdl_Force(vdl_LazyWhich(vdl_LazyStrictEqual(a, b))), w);
+            same_which &= test_Same(vdl_Force(vdl_LazyWhich(c)), vdl_Which(c));
+
+            if (w->Length > 0)
+            {
+                same_subset &= test_Same(vdl_Force(vdl_LazySubset(d, vdl_LazyWhich(vdl_LazyStrictEqual(a, b)))), vdl_Subset(d, w));
+                same_subset &= test_Same(vdl_Force(vdl_LazySubset(c, vdl_LazyWhich(vdl_LazyStrictEqual(a, b)))), vdl_Subset(c, w));
+                same_subset &= test_Same(vdl_Force(vdl_LazySubset(d, w)), vdl_Subset(d, w));
+                same_subset &= test_Same(vdl_Force(vdl_LazySubset(vdl_LazyStrictEqual(a, c), vdl_LazyWhich(vdl_LazyStrictEqual(a, b)))),
+                                         vdl_Subset(vdl_StrictEqual(a, c), w));
+
+                // A node shared by two parents is evaluated once, and forcing twice is harmless
+                VDL_VECTOR_P equal    = vdl_LazyStrictEqual(a, b);
+                VDL_VECTOR_P which    = vdl_LazyWhich(equal);
+                VDL_VECTOR_P both     = vdl_LazyStrictEqual(vdl_LazySubset(equal, which), vdl_LazySubset(d, which));
+                VDL_VECTOR_P expected = vdl_StrictEqual(vdl_Subset(vdl_StrictEqual(a, b), w), vdl_Subset(d, w));
+                same_subset &= test_Same(vdl_Force(both), expected);
+                same_subset &= test_Same(vdl_Force(both), expected);
+                same_subset &= test_Same(vdl_Force(which), w);
+            }
+            else
+            {
+                // An empty selection throws the same exception as vdl_Subset
+                int lazy_code = 0, eager_code = 0;
+                vdl_Try
+                {
+                    vdl_Force(vdl_LazySubset(d, vdl_LazyWhich(vdl_LazyStrictEqual(a, b))));
+                }
+                vdl_Catch
+                {
+                    lazy_code = vdl_GlobalVar_ExceptionFrames.Exception;
+                }
+                vdl_Try
+                {
+                    vdl_Subset(d, w);
+                }
+                vdl_Catch
+                {
+                    eager_code = vdl_GlobalVar_ExceptionFrames.Exception;
+                }
+                same_exception &= lazy_code != 0 && lazy_code == eager_code;
+            }
+            vdl_RootScopeEnd();
+            vdl_GarbageCollectorCleanUp();
+        }
+    }
+    // expect(1)
+    test_printf("%d", same_equal);
+    // expect(1)
+    test_printf("%d", same_which);
+    // expect(1)
+    test_printf("%d", same_subset);
+    // expect(1)
+    test_printf("%d", same_exception);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_ForceEdgeCase(void)
+{
+    // echo
+    echo("Test vdl_Force with edge cases:");
+
+    // Lazy expressions keep pointers to their operands, so the stack vectors must outlive them
+    VDL_VECTOR_P four  = vdl_LocalVector(1, 1, 1, 1);
+    VDL_VECTOR_P two   = vdl_LocalVector(1, 2);
+    VDL_VECTOR_P one   = vdl_LocalVector(1);
+    VDL_VECTOR_P empty = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    int code           = 0;
+    vdl_Try
+    {
+        vdl_Force(vdl_LazyStrictEqual(four, two));
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1)
+    test_printf("%d", code == VDL_EXCEPTION_INCOMPATIBLE_LENGTH);
+    code = 0;
+    vdl_Try
+    {
+        vdl_Force(vdl_LazySubset(two, vdl_LazyWhich(vdl_LazyStrictEqual(four, one))));
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1)
+    test_printf("%d", code == VDL_EXCEPTION_INDEX_OUT_OF_BOUND);
+
+    // Empty operands
+    VDL_VECTOR_P result = vdl_Force(vdl_LazyStrictEqual(empty, two));
+    // expect(0 1)
+    test_printf("%d %d", (int) result->Length, result->Type == VDL_TYPE_INT);
+    result = vdl_Force(vdl_LazyWhich(vdl_LazyStrictEqual(empty, one)));
+    // expect(0 1)
+    test_printf("%d %d", (int) result->Length, result->Type == VDL_TYPE_INDEX);
+
+    // A chain deeper than one fused kernel
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a     = vdl_Root(test_RandomInt(3000, 2));
+    VDL_VECTOR_P lazy  = a;
+    VDL_VECTOR_P eager = a;
+    vdl_for_i(40)
+    {
+        lazy  = vdl_Root(vdl_LazyStrictEqual(lazy, a));
+        eager = vdl_Root(vdl_StrictEqual(eager, a));
+    }
+    // expect(1)
+    test_printf("%d", test_Same(vdl_Force(lazy), eager));
+    // expect(1)
+    test_printf("%d", vdl_Force(a) == a);
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorKill();
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(VDL_AUTO_COLLECTION_OFF);
+    srand(2023);
+
+    test_Force();
+    test_ForceEdgeCase();
+
+    // exit(0)
+    return 0;
+}
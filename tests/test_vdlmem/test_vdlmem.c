@@ -0,0 +1,616 @@
+//
+// Tests of the vector memory.
+//
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../../include/vdl.h"
+#include "../test.h"
+
+#define TEST_FILE "test_vdlmem/test_vdlmem.bin"
+#define TEST_LIST_LENGTH 1000000
+
+typedef struct TEST_COUNTER_T
+{
+    long Live;
+    long Total;
+    long Subsystem[VDL_SUBSYSTEM_NUM];
+} TEST_COUNTER_T;
+
+static void *test_CounterAlloc(void *const context, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    ((TEST_COUNTER_T *) context)->Live++;
+    ((TEST_COUNTER_T *) context)->Total++;
+    ((TEST_COUNTER_T *) context)->Subsystem[subsystem]++;
+    return malloc(bytes);
+}
+
+static void *test_CounterCalloc(void *const context, const size_t num, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    ((TEST_COUNTER_T *) context)->Live++;
+    ((TEST_COUNTER_T *) context)->Total++;
+    ((TEST_COUNTER_T *) context)->Subsystem[subsystem]++;
+    return calloc(num, bytes);
+}
+
+static void *test_CounterRealloc(void *const context, void *const object, const size_t bytes, const VDL_SUBSYSTEM_T subsystem)
+{
+    if (object == NULL)
+        ((TEST_COUNTER_T *) context)->Live++;
+    ((TEST_COUNTER_T *) context)->Subsystem[subsystem]++;
+    return realloc(object, bytes);
+}
+
+static void test_CounterFree(void *const context, void *const object, const VDL_SUBSYSTEM_T subsystem)
+{
+    if (object != NULL)
+        ((TEST_COUNTER_T *) context)->Live--;
+    ((TEST_COUNTER_T *) context)->Subsystem[subsystem]++;
+    free(object);
+}
+
+static VDL_VECTOR_P test_View  = NULL;
+static VDL_VECTOR_P test_Other = NULL;
+
+// Write to the read-only view with one of the modifiers. The exception code is returned
+static int test_WriteView(const int op)
+{
+    int code = 0;
+    vdl_Try
+    {
+        switch (op)
+        {
+            case 0:
+                vdl_vector_primitive_AppendInt(test_View, 1);
+                break;
+            case 1:
+                vdl_InsertInt(test_View, 0, 1);
+                break;
+            case 2:
+                vdl_Extend(test_View, test_Other);
+                break;
+            case 3:
+                vdl_InsertByArray(test_View, 0, test_Other->Data, 1);
+                break;
+            default:
+                vdl_vector_primitive_SetInt(test_View, 0, 1);
+                break;
+        }
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    return code;
+}
+
+static void test_NewByScalar(void)
+{
+    // echo
+    echo("Test vdl_vector_primitive_NewByInt and vdl_vector_primitive_NewByDouble:");
+    VDL_VECTOR_P v = vdl_vector_primitive_NewByInt(7, 100);
+    int same       = v->Length == 100 && v->Capacity >= 100;
+    vdl_for_i(100) same &= vdl_vector_primitive_GetInt(v, i) == 7;
+    // expect(1)
+    test_printf("%d", same);
+    v    = vdl_vector_primitive_NewByDouble(1.5, 50);
+    same = v->Length == 50 && v->Capacity >= 50;
+    vdl_for_i(50) same &= vdl_vector_primitive_GetDouble(v, i) == 1.5;
+    // expect(1)
+    test_printf("%d", same);
+    v    = vdl_vector_primitive_NewByVectorPointer(v, 20);
+    same = v->Length == 20;
+    vdl_for_i(20) same &= vdl_vector_primitive_GetVectorPointer(v, i) == vdl_vector_primitive_GetVectorPointer(v, 0);
+    // expect(1)
+    test_printf("%d", same);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Arena(void)
+{
+    // echo
+    echo("Test vdl_ArenaBegin, vdl_ArenaEscape and vdl_ArenaEnd:");
+    VDL_VECTOR_P keep = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 2);
+    vdl_DeclareDirectlyReachable(keep);
+    vdl_ArenaBegin();
+    VDL_VECTOR_P a = vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 3);
+    // expect(1)
+    test_printf("%d", a->Mode == VDL_MODE_ARENA);
+    vdl_for_i(200000) vdl_vector_primitive_AppendDouble(a, (double) i);
+    VDL_VECTOR_P list = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 4);
+    vdl_vector_primitive_AppendVectorPointer(list, a);
+    vdl_vector_primitive_AppendVectorPointer(list, a);
+    vdl_vector_primitive_AppendVectorPointer(list, keep);
+    vdl_vector_primitive_AppendVectorPointer(list, list);
+    vdl_ArenaBegin();
+    vdl_for_i(1000) vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 100);
+    vdl_ArenaEnd();
+    VDL_VECTOR_P out = vdl_ArenaEscape(list);
+    vdl_DeclareDirectlyReachable(out);
+    // expect(3)
+    test_printf("%d", vdl_GlobalVar_Nursery->Length + vdl_GlobalVar_VectorTable->Length);
+    vdl_ArenaEnd();
+
+    // The escaped graph keeps its shape and its contents
+    VDL_VECTOR_POINTER_ARRAY items = out->Data;
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_Arena.Current.Chunk == NULL && out->Mode == VDL_MODE_HEAP);
+    // expect(1)
+    test_printf("%d", items[0] == items[1] && items[2] == keep && items[3] == out);
+    // expect(1)
+    test_printf("%d", items[0]->Length == 200000 && vdl_vector_primitive_GetDouble(items[0], 199999) == 199999.0);
+    // expect(0)
+    test_printf("%d", vdl_GarbageCollectorCleanUp().ObjectFreed);
+
+    int code = 0;
+    vdl_Try
+    {
+        vdl_ArenaEnd();
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1)
+    test_printf("%d", code == VDL_EXCEPTION_INVALID_ARENA_STATE);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_ArenaException(void)
+{
+    // echo
+    echo("Test arenas with exceptions:");
+    vdl_ArenaBegin();
+    vdl_Try
+    {
+        vdl_ArenaBegin();
+        vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1 << 20);
+        vdl_ArenaBegin();
+        vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+    }
+    vdl_Catch {}
+    // expect(1)
+    test_printf("%d", vdl_GlobalVar_Arena.Depth);
+    vdl_ArenaEnd();
+    vdl_Try
+    {
+        vdl_ArenaBegin();
+        vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+    }
+    vdl_Catch {}
+    // expect(0)
+    test_printf("%d", vdl_GlobalVar_Arena.Depth);
+    // expect(1)
+    test_printf("%d", vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 4)->Mode == VDL_MODE_HEAP);
+
+    // An arena vector can not grow inside a nested arena
+    vdl_ArenaBegin();
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    vdl_vector_primitive_AppendInt(v, 1);
+    vdl_vector_primitive_AppendInt(v, 2);
+    vdl_ArenaBegin();
+    int code = 0;
+    vdl_Try
+    {
+        vdl_for_i(100) vdl_vector_primitive_AppendInt(v, (int) i);
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1 2)
+    test_printf("%d %d", code == VDL_EXCEPTION_INVALID_ARENA_STATE, vdl_GlobalVar_Arena.Depth);
+    vdl_ArenaEnd();
+    vdl_for_i(100) vdl_vector_primitive_AppendInt(v, (int) i);
+    // expect(1 1)
+    test_printf("%d %d", vdl_vector_primitive_GetInt(v, v->Length - 1) == 99, vdl_ArenaDepthOf(v));
+    vdl_ArenaEnd();
+    vdl_GarbageCollectorKill();
+}
+
+static void test_ArenaEscapeList(void)
+{
+    // echo
+    echo("Test vdl_ArenaEscape with a long list:");
+    vdl_ArenaBegin();
+    VDL_VECTOR_P tail = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+    vdl_vector_primitive_AppendVectorPointer(tail, NULL);
+    VDL_VECTOR_P head = tail;
+    vdl_for_i(TEST_LIST_LENGTH - 1)
+    {
+        VDL_VECTOR_P node = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 1);
+        vdl_vector_primitive_AppendVectorPointer(node, head);
+        head = node;
+    }
+    tail->Attribute = head;
+
+    // The list is followed without recursion, and the cycle through the attribute ends at the head
+    VDL_VECTOR_P out = vdl_ArenaEscape(head);
+    vdl_DeclareDirectlyReachable(out);
+    vdl_ArenaEnd();
+    int count = 0, heap = 1;
+    VDL_VECTOR_P last = NULL;
+    for (VDL_VECTOR_P node = out; node != NULL; node = vdl_vector_primitive_GetVectorPointer(node, 0))
+    {
+        heap &= node->Mode == VDL_MODE_HEAP;
+        last = node;
+        count++;
+    }
+    // expect(1000000 1 1)
+    test_printf("%d %d %d", count, heap, last->Attribute == out);
+    // expect(1000000)
+    test_printf("%zu", vdl_GarbageCollectorStats().LiveObject);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Allocator(void)
+{
+    // echo
+    echo("Test vdl_SetAllocator and vdl_MemoryPoolRelease:");
+    TEST_COUNTER_T counter    = {0};
+    VDL_ALLOCATOR_T allocator = {test_CounterAlloc, test_CounterCalloc, test_CounterRealloc, test_CounterFree, &counter};
+    vdl_SetAllocator(&allocator);
+    vdl_for_i(100) vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1000);
+    vdl_DeclareDirectlyReachable(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 4));
+    // expect(1)
+    test_printf("%d", counter.Total >= 100);
+
+    // The allocator can not be swapped while vectors are alive
+    int code = 0;
+    vdl_Try
+    {
+        vdl_SetAllocator(&vdl_MemoryPoolAllocator);
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1)
+    test_printf("%d", code != 0);
+    vdl_GarbageCollectorCleanUp();
+    vdl_GarbageCollectorKill();
+    // expect(0)
+    test_printf("%ld", counter.Live);
+
+    vdl_SetAllocator(&vdl_MemoryPoolAllocator);
+    char *p = vdl_Malloc(10, 0, VDL_SUBSYSTEM_WORKSPACE);
+    p       = vdl_Realloc(p, 20, VDL_SUBSYSTEM_WORKSPACE);
+    p       = vdl_Realloc(p, 5000, VDL_SUBSYSTEM_WORKSPACE);
+    p       = vdl_Realloc(p, 100000, VDL_SUBSYSTEM_WORKSPACE);
+    p       = vdl_Realloc(p, 30, VDL_SUBSYSTEM_WORKSPACE);
+    vdl_Free(p, VDL_SUBSYSTEM_WORKSPACE);
+    // expect(0)
+    test_printf("%zu", (size_t) vdl_GlobalVar_MemoryPool.BlockInUse);
+    vdl_MemoryPoolRelease();
+}
+
+static void test_AllocatorSubsystem(void)
+{
+    // echo
+    echo("Test the subsystems passed to the allocator:");
+    TEST_COUNTER_T counter    = {0};
+    VDL_ALLOCATOR_T allocator = {test_CounterAlloc, test_CounterCalloc, test_CounterRealloc, test_CounterFree, &counter};
+    vdl_SetAllocator(&allocator);
+
+    // Vectors, an attribute, the vector tables and the root stack
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P v = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1000));
+    v->Length      = 1000;
+    vdl_vector_InitAttribute(v);
+    vdl_WhichParallel(v);
+
+    // An arena chunk and the map of the escaping vectors
+    vdl_ArenaBegin();
+    vdl_Root(vdl_ArenaEscape(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 10)));
+    vdl_ArenaEnd();
+
+    // Registered memory is freed by the exception cleanup
+    vdl_Try
+    {
+        vdl_Malloc(16, 1, VDL_SUBSYSTEM_WORKSPACE);
+        vdl_Throw(VDL_EXCEPTION_NULL_POINTER, "Mock exception!");
+    }
+    vdl_Catch
+    {
+    }
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorCleanUp();
+    vdl_GarbageCollectorKill();
+
+    int seen = 1;
+    vdl_for_i(VDL_SUBSYSTEM_NUM) seen &= counter.Subsystem[i] > 0;
+    // expect(1 0)
+    test_printf("%d %ld", seen, counter.Live);
+    vdl_SetAllocator(&vdl_MemoryPoolAllocator);
+}
+
+static void test_Realloc(void)
+{
+    // echo
+    echo("Test vdl_Realloc growth:");
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 1);
+    vdl_DeclareDirectlyReachable(v);
+    vdl_for_i(3000000) vdl_vector_primitive_AppendInt(v, (int) i);
+    int same = 1;
+    vdl_for_i(3000000) same &= vdl_vector_primitive_GetInt(v, i) == (int) i;
+    vdl_for_i(3000000, v->Capacity) same &= ((int *) v->Data)[i] == 0;
+    // expect(1)
+    test_printf("%d", same);
+    VDL_VECTOR_P d = vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 10);
+    vdl_DeclareDirectlyReachable(d);
+    vdl_for_i(1000) vdl_vector_primitive_AppendDouble(d, (double) i * 0.5);
+    same = 1;
+    vdl_for_i(1000) same &= vdl_vector_primitive_GetDouble(d, i) == (double) i * 0.5;
+    // expect(1)
+    test_printf("%d", same);
+    double *big = vdl_Calloc(20000, sizeof(double), 0, VDL_SUBSYSTEM_WORKSPACE);
+    // expect(1)
+    test_printf("%d", big[0] == 0.0 && big[19999] == 0.0);
+    vdl_Free(big, VDL_SUBSYSTEM_WORKSPACE);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_File(void)
+{
+    // echo
+    echo("Test vdl_vector_primitive_NewByFile:");
+    FILE *file        = fopen(TEST_FILE, "wb");
+    char header[104] = {0};
+    fwrite(header, 1, 104, file);
+    vdl_for_i(5000)
+    {
+        const double x = (double) i * 0.5;
+        fwrite(&x, sizeof(double), 1, file);
+    }
+    fclose(file);
+
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P v = vdl_Root(vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 104, 0, 0));
+    // expect(1)
+    test_printf("%d", v->Mode == VDL_MODE_MMAP && v->Length == 5000 && (v->Flag & VDL_FLAG_READ_ONLY));
+    // expect(2499.5)
+    test_printf("%.1f", vdl_vector_primitive_GetDouble(v, 4999));
+    VDL_VECTOR_P cat = vdl_Concatenate(v, vdl_Subset(v, vdl_LocalVector(2, 10)));
+    // expect(1)
+    test_printf("%d", cat->Mode == VDL_MODE_HEAP && cat->Length == 5002 && vdl_vector_primitive_GetDouble(cat, 5001) == 5.0);
+
+    // Read-only mappings and their views reject every modifier
+    test_View  = vdl_Root(vdl_vector_primitive_NewByFile(VDL_TYPE_INT, TEST_FILE, 0, 100, 0));
+    test_Other = vdl_Root(vdl_Slice(test_View, 0, 3, 1));
+    int read_only = 1;
+    vdl_for_i(5) read_only &= test_WriteView((int) i) == VDL_EXCEPTION_READ_ONLY_VECTOR;
+    test_View = vdl_Root(vdl_Slice(test_View, 0, 10, 1));
+    vdl_for_i(5) read_only &= test_WriteView((int) i) == VDL_EXCEPTION_READ_ONLY_VECTOR;
+    // expect(1)
+    test_printf("%d", read_only && test_View->Mode == VDL_MODE_VIEW && test_View->Length == 10);
+
+    // Copy-on-write mappings are modified privately
+    VDL_VECTOR_P w = vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 104, 10, 1);
+    vdl_vector_primitive_SetDouble(w, 3, -7.0);
+    VDL_VECTOR_P r = vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 104, 10, 0);
+    // expect(-7.0 1.5)
+    test_printf("%.1f %.1f", vdl_vector_primitive_GetDouble(w, 3), vdl_vector_primitive_GetDouble(r, 3));
+
+    // Misaligned offsets, out of bound lengths and missing files
+    int caught = 0;
+    vdl_Try
+    {
+        vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 100, 0, 0);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    vdl_Try
+    {
+        vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 104, 5001, 0);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    vdl_Try
+    {
+        vdl_vector_primitive_NewByFile(VDL_TYPE_INT, "test_vdlmem/nonexistent.bin", 0, 0, 0);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    // expect(3)
+    test_printf("%d", caught);
+
+    // Shallow copies of a read-only mapping are writable, its views are not
+    VDL_VECTOR_P copy   = vdl_Root(vdl_ShallowCopy(v));
+    VDL_VECTOR_P joined = vdl_Root(vdl_Concatenate(v, vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 1)));
+    vdl_vector_primitive_SetDouble(copy, 0, 1.0);
+    vdl_vector_primitive_SetDouble(joined, 0, 2.0);
+    // expect(1.0 2.0 0.0 1)
+    test_printf("%.1f %.1f %.1f %d",
+                vdl_vector_primitive_GetDouble(copy, 0),
+                vdl_vector_primitive_GetDouble(joined, 0),
+                vdl_vector_primitive_GetDouble(v, 0),
+                (vdl_Slice(v, 0, 10, 1)->Flag & VDL_FLAG_READ_ONLY) != 0);
+
+    // The last copy of a read-only mapping still copies before it writes
+    VDL_VECTOR_P sole = vdl_Root(vdl_ShallowCopy(vdl_vector_primitive_NewByFile(VDL_TYPE_DOUBLE, TEST_FILE, 104, 10, 0)));
+    vdl_GarbageCollectorCleanUp();
+    const size_t ref_count = sole->Buffer->RefCount;
+    vdl_vector_primitive_SetDouble(sole, 1, 5.0);
+    // expect(1 5.0 1)
+    test_printf("%zu %.1f %d", ref_count, vdl_vector_primitive_GetDouble(sole, 1), sole->Mode == VDL_MODE_HEAP);
+
+    // Unreachable mappings are unmapped by the sweep
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorCleanUp();
+    // expect(0)
+    test_printf("%zu", vdl_GarbageCollectorStats().LiveObject);
+    vdl_GarbageCollectorKill();
+    remove(TEST_FILE);
+}
+
+static void test_Slice(void)
+{
+    // echo
+    echo("Test vdl_Slice:");
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P p = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 100));
+    vdl_for_i(100) vdl_vector_primitive_AppendInt(p, (int) i);
+
+    // Contiguous slices share the data
+    VDL_VECTOR_P s = vdl_Root(vdl_Slice(p, 10, 20, 1));
+    // expect(1)
+    test_printf("%d", s->Mode == VDL_MODE_VIEW && s->Length == 10 && s->Data == (int *) p->Data + 10);
+    VDL_VECTOR_P s2 = vdl_Root(vdl_Slice(s, 2, 5, 1));
+    // expect(3 12)
+    test_printf("%zu %d", p->Buffer->RefCount, vdl_vector_primitive_GetInt(s2, 0));
+
+    // Writing to a shared view detaches it
+    vdl_vector_primitive_SetInt(s, 0, -1);
+    // expect(1 10 2)
+    test_printf("%d %d %zu", s->Mode == VDL_MODE_HEAP && s->Buffer == NULL, vdl_vector_primitive_GetInt(p, 10), p->Buffer->RefCount);
+    vdl_vector_primitive_SetInt(p, 12, 99);
+    // expect(1 12 1)
+    test_printf("%d %d %zu", p->Buffer == NULL, vdl_vector_primitive_GetInt(s2, 0), s2->Buffer->RefCount);
+
+    // The sole view writes in place and detaches when it grows
+    vdl_vector_primitive_SetInt(s2, 0, 7);
+    // expect(1)
+    test_printf("%d", s2->Mode == VDL_MODE_VIEW);
+    vdl_vector_primitive_AppendInt(s2, 5);
+    // expect(1 7 5)
+    test_printf("%d %d %d", s2->Mode == VDL_MODE_HEAP, vdl_vector_primitive_GetInt(s2, 0), vdl_vector_primitive_GetInt(s2, 3));
+
+    // Strided, reversed and empty slices are copied
+    VDL_VECTOR_P r = vdl_Slice(p, 9, -1, -3);
+    // expect(1 9 0)
+    test_printf("%d %d %d", r->Mode == VDL_MODE_HEAP && r->Length == 4, vdl_vector_primitive_GetInt(r, 0), vdl_vector_primitive_GetInt(r, 3));
+    // expect(0 3)
+    test_printf("%d %d", (int) vdl_Slice(p, 5, 5, 1)->Length, (int) vdl_Slice(p, 0, 10, 4)->Length);
+
+    // Zero step and out of bound ranges
+    int caught = 0;
+    vdl_Try
+    {
+        vdl_Slice(p, 0, 1, 0);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    vdl_Try
+    {
+        vdl_Slice(p, 5, 4, 1);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    vdl_Try
+    {
+        vdl_Slice(p, 0, p->Length + 1, 1);
+    }
+    vdl_Catch
+    {
+        caught++;
+    }
+    // expect(3)
+    test_printf("%d", caught);
+
+    // Views of vector pointers keep the items reachable
+    VDL_VECTOR_P list = vdl_vector_primitive_NewEmpty(VDL_TYPE_VECTOR_POINTER, 32);
+    vdl_for_i(32) vdl_vector_primitive_AppendVectorPointer(list, vdl_vector_primitive_NewByIndex(i, 1));
+    VDL_VECTOR_P view = vdl_Root(vdl_Slice(list, 30, 32, 1));
+    vdl_GarbageCollectorCleanUp();
+    // expect(31)
+    test_printf("%d", (int) vdl_vector_primitive_GetIndex(vdl_vector_primitive_GetVectorPointer(view, 1), 0));
+
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorCleanUp();
+    // expect(0)
+    test_printf("%zu", vdl_GarbageCollectorStats().LiveObject);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_ShallowCopy(void)
+{
+    // echo
+    echo("Test vdl_ShallowCopy:");
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P p = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, 100));
+    vdl_for_i(90) vdl_vector_primitive_AppendDouble(p, (double) i);
+    VDL_VECTOR_P c  = vdl_Root(vdl_ShallowCopy(p));
+    VDL_VECTOR_P c2 = vdl_Root(vdl_ShallowCopy(c));
+    // expect(1 3)
+    test_printf("%d %zu", c->Data == p->Data && c2->Data == p->Data, p->Buffer->RefCount);
+
+    // Every writer detaches before it writes
+    vdl_vector_primitive_AppendDouble(p, 90.0);
+    // expect(1 90 91)
+    test_printf("%d %d %d", p->Buffer == NULL && p->Data != c->Data, (int) c->Length, (int) p->Length);
+    vdl_vector_primitive_SetDouble(c, 0, -1.0);
+    // expect(0.0 1)
+    test_printf("%.1f %zu", vdl_vector_primitive_GetDouble(c2, 0), c2->Buffer->RefCount);
+
+    // The sole holder takes the data back without copying
+    void *data = c2->Data;
+    vdl_vector_primitive_AppendDouble(c2, 1.0);
+    // expect(1)
+    test_printf("%d", c2->Buffer == NULL && c2->Data == data);
+
+    VDL_VECTOR_P d = vdl_Root(vdl_ShallowCopy(p));
+    vdl_InsertDouble(d, 0, 5.0);
+    VDL_VECTOR_P e = vdl_Root(vdl_ShallowCopy(p));
+    vdl_vector_Set(e, vdl_LocalVector(3.0));
+    VDL_VECTOR_P f = vdl_Root(vdl_ShallowCopy(p));
+    vdl_vector_SetByIndex(f, vdl_LocalVector(1, 2), vdl_LocalVector(7.0));
+    // expect(5.0 3.0 7.0)
+    test_printf("%.1f %.1f %.1f", vdl_vector_primitive_GetDouble(d, 0), vdl_vector_primitive_GetDouble(e, 5), vdl_vector_primitive_GetDouble(f, 2));
+    // expect(0.0 5.0 2.0)
+    test_printf("%.1f %.1f %.1f", vdl_vector_primitive_GetDouble(p, 0), vdl_vector_primitive_GetDouble(p, 5), vdl_vector_primitive_GetDouble(p, 2));
+
+    // A failed write leaves the data shared
+    VDL_VECTOR_P g = vdl_Root(vdl_ShallowCopy(p));
+    int code       = 0;
+    vdl_Try
+    {
+        vdl_vector_primitive_SetDouble(g, g->Length, 1.0);
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    // expect(1)
+    test_printf("%d", code == VDL_EXCEPTION_INDEX_OUT_OF_BOUND && g->Data == p->Data);
+
+    // Copies outlive the original
+    VDL_VECTOR_P tmp = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, 100);
+    vdl_for_i(100) vdl_vector_primitive_AppendInt(tmp, (int) i);
+    VDL_VECTOR_P keep = vdl_Root(vdl_ShallowCopy(tmp));
+    vdl_GarbageCollectorCleanUp();
+    // expect(99 1)
+    test_printf("%d %zu", vdl_vector_primitive_GetInt(keep, 99), keep->Buffer->RefCount);
+
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorCleanUp();
+    // expect(0)
+    test_printf("%zu", vdl_GarbageCollectorStats().LiveObject);
+    vdl_GarbageCollectorKill();
+}
+
+int main(void)
+{
+    test_NewByScalar();
+    test_Arena();
+    test_ArenaException();
+    test_ArenaEscapeList();
+    test_Allocator();
+    test_AllocatorSubsystem();
+    test_Realloc();
+    test_File();
+    test_Slice();
+    test_ShallowCopy();
+
+    // exit(0)
+    return 0;
+}
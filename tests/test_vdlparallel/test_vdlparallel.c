@@ -0,0 +1,182 @@
+//
+// Tests of the thread pool and of the vector operations run by it.
+//
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../../include/vdl.h"
+#include "../test.h"
+
+#define TEST_HIT_NUM 1000010
+#define TEST_LENGTH  300007
+#define TEST_NESTED  100000
+
+static void test_Hit(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    int *const hits = context;
+    for (VDL_INDEX_T i = begin; i < end; i++)
+        __atomic_add_fetch(&hits[i], 1, __ATOMIC_RELAXED);
+}
+
+// A nested loop runs serially on the calling worker
+static void test_HitNested(const VDL_INDEX_T begin, const VDL_INDEX_T end, void *const context)
+{
+    (void) begin;
+    (void) end;
+    vdl_ParallelFor(0, TEST_NESTED, 7, test_Hit, context);
+}
+
+static void test_ParallelFor(void)
+{
+    static int hits[TEST_HIT_NUM];
+    const VDL_INDEX_T sizes[]  = {0, 1, 65535, 65536, 65537, 200001, 1000003};
+    const VDL_INDEX_T grains[] = {0, 1, 63, 1000, 16384, 5000000};
+
+    // echo
+    echo("Test vdl_ParallelFor:");
+    vdl_ThreadPoolSetThreadNum(4);
+    // expect(4)
+    test_printf("%d", vdl_ThreadPoolThreadNum());
+
+    // Every index is visited exactly once
+    int once = 1;
+    vdl_for_i(7)
+    {
+        vdl_for_j(6)
+        {
+            memset(hits, 0, sizeof(hits));
+            vdl_ParallelFor(3, 3 + sizes[i], grains[j], test_Hit, hits);
+            for (VDL_INDEX_T k = 0; k < TEST_HIT_NUM; k++)
+                once &= hits[k] == (k >= 3 && k < 3 + sizes[i]);
+        }
+    }
+    // expect(1)
+    test_printf("%d", once);
+
+    memset(hits, 0, sizeof(hits));
+    vdl_ParallelFor(0, 400000, 1000, test_HitNested, hits);
+    int nested = 1;
+    vdl_for_i(TEST_NESTED) nested &= hits[i] == 400;
+    // expect(1)
+    test_printf("%d", nested);
+}
+
+static VDL_VECTOR_P test_Double = NULL;
+static VDL_VECTOR_P test_Index  = NULL;
+
+// Run a subset or a set by index with `test_Index`. The exception code is returned
+static int test_IndexException(const int set)
+{
+    int code = 0;
+    vdl_Try
+    {
+        if (set)
+            vdl_vector_SetByIndex(test_Double, test_Index, vdl_LocalDoubleVector(1.0));
+        else
+            vdl_Subset(test_Double, test_Index);
+    }
+    vdl_Catch
+    {
+        code = vdl_GlobalVar_ExceptionFrames.Exception;
+    }
+    return code;
+}
+
+static int test_Same(VDL_VECTOR_P x, VDL_VECTOR_P y)
+{
+    if (x->Type != y->Type || x->Length != y->Length)
+        return 0;
+    return x->Length == 0 || memcmp(x->Data, y->Data, VDL_TYPE_SIZE[x->Type] * (size_t) x->Length) == 0;
+}
+
+static void test_Operation(void)
+{
+    // echo
+    echo("Test the parallel vector operations against one thread:");
+    vdl_RootScopeBegin();
+    VDL_VECTOR_P a      = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, TEST_LENGTH));
+    VDL_VECTOR_P b      = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, TEST_LENGTH));
+    VDL_VECTOR_P x      = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_INDEX, TEST_LENGTH));
+    test_Double         = vdl_Root(vdl_vector_primitive_NewEmpty(VDL_TYPE_DOUBLE, TEST_LENGTH));
+    a->Length           = TEST_LENGTH;
+    b->Length           = TEST_LENGTH;
+    x->Length           = TEST_LENGTH;
+    test_Double->Length = TEST_LENGTH;
+    vdl_for_i(TEST_LENGTH)
+    {
+        vdl_vector_primitive_UnsafeSetInt(a, i, rand() % 3);
+        vdl_vector_primitive_UnsafeSetInt(b, i, rand() % 3);
+        vdl_vector_primitive_UnsafeSetDouble(test_Double, i, (double) rand());
+        vdl_vector_primitive_UnsafeSetIndex(x, i, (VDL_INDEX_T) (rand() % TEST_LENGTH));
+    }
+
+    // The results of four threads and of one thread, rooted in this order
+    VDL_VECTOR_P results[2][7];
+    for (int round = 0; round < 2; round++)
+    {
+        vdl_ThreadPoolSetThreadNum(round == 0 ? 4 : 1);
+        results[round][0] = vdl_Root(vdl_StrictEqual(a, b));
+        results[round][1] = vdl_Root(vdl_StrictEqual(vdl_Slice(b, 5, 6, 1), a));
+        results[round][2] = vdl_Root(vdl_StrictEqual(vdl_Slice(a, 1, TEST_LENGTH, 1), vdl_Slice(b, 0, TEST_LENGTH - 1, 1)));
+        results[round][3] = vdl_Root(vdl_Subset(test_Double, x));
+        results[round][4] = vdl_Root(vdl_ShallowCopy(test_Double));
+        vdl_vector_SetByIndex(results[round][4], x, results[round][3]);
+        results[round][5] = vdl_Root(vdl_ShallowCopy(test_Double));
+        vdl_vector_Set(results[round][5], vdl_LocalDoubleVector(2.5));
+        results[round][6] = vdl_Root(vdl_WhichParallel(results[round][0]));
+        vdl_GarbageCollectorCleanUp();
+    }
+    int same = 1;
+    vdl_for_i(7) same &= test_Same(results[0][i], results[1][i]);
+    // expect(1)
+    test_printf("%d", same);
+
+    // The serial results agree with the definitions
+    int agree = 1;
+    vdl_for_i(TEST_LENGTH)
+    {
+        const int ai         = vdl_vector_primitive_GetInt(a, i);
+        const int bi         = vdl_vector_primitive_GetInt(b, i);
+        const VDL_INDEX_T xi = vdl_vector_primitive_GetIndex(x, i);
+        agree &= vdl_vector_primitive_GetInt(results[1][0], i) == (ai == bi);
+        agree &= vdl_vector_primitive_GetInt(results[1][1], i) == (ai == vdl_vector_primitive_GetInt(b, 5));
+        agree &= vdl_vector_primitive_GetDouble(results[1][3], i) == vdl_vector_primitive_GetDouble(test_Double, xi);
+        agree &= vdl_vector_primitive_GetDouble(results[1][5], i) == 2.5;
+    }
+    // expect(1)
+    test_printf("%d", agree);
+    // expect(1)
+    test_printf("%d", test_Same(results[1][6], vdl_Which(results[1][0])));
+
+    // The first invalid index is reported, and a failed write leaves the vector untouched
+    vdl_ThreadPoolSetThreadNum(4);
+    test_Index = vdl_Root(vdl_ShallowCopy(x));
+    vdl_vector_primitive_SetIndex(test_Index, TEST_LENGTH - 10, VDL_INDEX_NA);
+    vdl_vector_primitive_SetIndex(test_Index, TEST_LENGTH - 100, TEST_LENGTH);
+    // expect(1)
+    test_printf("%d", test_IndexException(0) == VDL_EXCEPTION_INDEX_OUT_OF_BOUND);
+    vdl_vector_primitive_SetIndex(test_Index, TEST_LENGTH - 1000, VDL_INDEX_NA);
+    // expect(1)
+    test_printf("%d", test_IndexException(0) == VDL_EXCEPTION_MISSING_VALUE);
+    VDL_VECTOR_P original = test_Double;
+    test_Double           = vdl_Root(vdl_ShallowCopy(original));
+    // expect(1 1)
+    test_printf("%d %d", test_IndexException(1) == VDL_EXCEPTION_MISSING_VALUE, test_Same(test_Double, original));
+
+    vdl_RootScopeEnd();
+    vdl_GarbageCollectorKill();
+    // expect(0)
+    test_printf("%d", vdl_GlobalVar_ThreadPool.StartedNum);
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(VDL_AUTO_COLLECTION_OFF);
+    srand(2023);
+
+    test_ParallelFor();
+    test_Operation();
+
+    // exit(0)
+    return 0;
+}
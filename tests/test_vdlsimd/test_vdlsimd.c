@@ -0,0 +1,229 @@
+//
+// Tests of the SIMD kernels against the scalar loops at every instruction set.
+// Instruction sets not supported by the CPU are lowered by vdl_SimdSetLevel, so the output does
+// not depend on the machine.
+//
+
+#pragma clang diagnostic ignored "-Wshadow"
+
+#include "../../include/vdl.h"
+#include "../test.h"
+#include <math.h>
+
+static const VDL_INDEX_T test_Lengths[] = {0, 1, 2, 3, 7, 15, 16, 17, 31, 33, 63, 64, 65, 100, 1000, 4097};
+
+#define TEST_LENGTH_NUM ((int) (sizeof(test_Lengths) / sizeof(test_Lengths[0])))
+
+// Whether the i-th item of `x` equals the i-th item of `y`, or the only item of `y`
+static int test_ItemEqual(VDL_VECTOR_P x, VDL_VECTOR_P y, const VDL_INDEX_T i)
+{
+    const VDL_INDEX_T j = y->Length == 1 ? 0 : i;
+    switch (x->Type)
+    {
+        case VDL_TYPE_CHAR:
+            return ((char *) x->Data)[i] == ((char *) y->Data)[j];
+        case VDL_TYPE_INT:
+            return ((int *) x->Data)[i] == ((int *) y->Data)[j];
+        case VDL_TYPE_DOUBLE:
+            return ((double *) x->Data)[i] == ((double *) y->Data)[j];
+        case VDL_TYPE_VECTOR_POINTER:
+            return ((VDL_VECTOR_P *) x->Data)[i] == ((VDL_VECTOR_P *) y->Data)[j];
+        case VDL_TYPE_INDEX:
+            return ((VDL_INDEX_T *) x->Data)[i] == ((VDL_INDEX_T *) y->Data)[j];
+    }
+    return -1;
+}
+
+// Fill the i-th item of a vector with a small value. The value 2 of a double vector is a NaN
+static void test_SetItem(VDL_VECTOR_P v, const VDL_INDEX_T i, const int value)
+{
+    switch (v->Type)
+    {
+        case VDL_TYPE_CHAR:
+            ((char *) v->Data)[i] = (char) (value - 1);
+            break;
+        case VDL_TYPE_INT:
+            ((int *) v->Data)[i] = value << 20;
+            break;
+        case VDL_TYPE_DOUBLE:
+            ((double *) v->Data)[i] = value == 2 ? NAN : (double) value;
+            break;
+        case VDL_TYPE_VECTOR_POINTER:
+            ((VDL_VECTOR_P *) v->Data)[i] = (VDL_VECTOR_P) (uintptr_t) ((uint64_t) value << 33 | 8u);
+            break;
+        case VDL_TYPE_INDEX:
+            ((VDL_INDEX_T *) v->Data)[i] = value;
+            break;
+    }
+}
+
+static VDL_VECTOR_P test_RandomVector(const VDL_TYPE_T type, const VDL_INDEX_T length, const int range)
+{
+    VDL_VECTOR_P v = vdl_vector_primitive_NewEmpty(type, length > 0 ? length : 1);
+    v->Length      = length;
+    vdl_for_i(length) test_SetItem(v, i, rand() % range);
+    return v;
+}
+
+static int test_StrictEqualAgree(VDL_VECTOR_P x, VDL_VECTOR_P y)
+{
+    VDL_VECTOR_P result = vdl_StrictEqual(x, y);
+    VDL_VECTOR_P longer = x->Length >= y->Length ? x : y;
+    VDL_VECTOR_P other  = longer == x ? y : x;
+    if (result->Type != VDL_TYPE_INT)
+        return 0;
+
+    // An empty operand gives an empty result
+    if (other->Length == 0)
+        return result->Length == 0;
+    if (result->Length != longer->Length)
+        return 0;
+    vdl_for_i(longer->Length) if (((int *) result->Data)[i] != test_ItemEqual(longer, other, i)) return 0;
+    return 1;
+}
+
+static int test_WhichAgree(VDL_VECTOR_P v)
+{
+    VDL_VECTOR_P result = vdl_Which(v);
+    VDL_INDEX_T k       = 0;
+    if (result->Type != VDL_TYPE_INDEX)
+        return 0;
+    vdl_for_i(v->Length)
+    {
+        if (((int *) v->Data)[i] == 0)
+            continue;
+        if (k >= result->Length || ((VDL_INDEX_T *) result->Data)[k] != i)
+            return 0;
+        k++;
+    }
+    return k == result->Length;
+}
+
+static int test_FindAgree(VDL_VECTOR_P v, VDL_VECTOR_P item)
+{
+    VDL_INDEX_T expected = -1;
+    vdl_for_i(v->Length)
+    {
+        if (test_ItemEqual(v, item, i))
+        {
+            expected = i;
+            break;
+        }
+    }
+    VDL_VECTOR_P result = vdl_Find(v, item);
+    return vdl_FindScalar(v, item) == expected && vdl_vector_primitive_GetIndex(result, 0) == expected;
+}
+
+static void test_StrictEqual(void)
+{
+    // echo
+    echo("Test vdl_StrictEqual:");
+    int agree = 1;
+    for (int level = VDL_SIMD_NONE; level <= VDL_SIMD_AVX512; level++)
+    {
+        vdl_SimdSetLevel((VDL_SIMD_T) level);
+        vdl_for_i(VDL_TYPE_NUM)
+        {
+            vdl_for_j(TEST_LENGTH_NUM)
+            {
+                // Views starting at the second item are not aligned
+                const VDL_INDEX_T n = test_Lengths[j];
+                VDL_VECTOR_P a      = test_RandomVector((VDL_TYPE_T) i, n + 1, 3);
+                VDL_VECTOR_P b      = test_RandomVector((VDL_TYPE_T) i, n + 1, 3);
+                VDL_VECTOR_P av     = vdl_Slice(a, 1, n + 1, 1);
+                VDL_VECTOR_P bv     = vdl_Slice(b, 1, n + 1, 1);
+                VDL_VECTOR_P scalar = vdl_Slice(b, 0, 1, 1);
+                agree &= test_StrictEqualAgree(a, b);
+                agree &= test_StrictEqualAgree(av, bv);
+                agree &= test_StrictEqualAgree(av, scalar);
+                agree &= test_StrictEqualAgree(scalar, av);
+            }
+            vdl_GarbageCollectorCleanUp();
+        }
+    }
+    // expect(1)
+    test_printf("%d", agree);
+
+    // Signed zeros are equal, NaNs are not
+    VDL_VECTOR_P result = vdl_StrictEqual(vdl_LocalDoubleVector(-0.0, NAN), vdl_LocalDoubleVector(0.0, NAN));
+    // expect(1 0)
+    test_printf("%d %d", vdl_vector_primitive_GetInt(result, 0), vdl_vector_primitive_GetInt(result, 1));
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Which(void)
+{
+    // echo
+    echo("Test vdl_Which:");
+    const int densities[] = {0, 1, 50, 99, 100};
+    int agree             = 1;
+    for (int level = VDL_SIMD_NONE; level <= VDL_SIMD_AVX512; level++)
+    {
+        vdl_SimdSetLevel((VDL_SIMD_T) level);
+        vdl_for_i(TEST_LENGTH_NUM)
+        {
+            vdl_for_j(5)
+            {
+                const VDL_INDEX_T n = test_Lengths[i];
+                VDL_VECTOR_P v      = vdl_vector_primitive_NewEmpty(VDL_TYPE_INT, n + 1);
+                v->Length           = n + 1;
+                for (VDL_INDEX_T k = 0; k <= n; k++)
+                    ((int *) v->Data)[k] = rand() % 100 < densities[j] ? rand() % 7 - 3 : 0;
+                agree &= test_WhichAgree(v);
+                agree &= test_WhichAgree(vdl_Slice(v, 1, n + 1, 1));
+            }
+            vdl_GarbageCollectorCleanUp();
+        }
+    }
+    // expect(1)
+    test_printf("%d", agree);
+    vdl_GarbageCollectorKill();
+}
+
+static void test_Find(void)
+{
+    // echo
+    echo("Test vdl_Find and vdl_FindScalar:");
+    int agree = 1;
+    for (int level = VDL_SIMD_NONE; level <= VDL_SIMD_AVX512; level++)
+    {
+        vdl_SimdSetLevel((VDL_SIMD_T) level);
+        vdl_for_i(VDL_TYPE_NUM)
+        {
+            vdl_for_j(TEST_LENGTH_NUM)
+            {
+                // Wider ranges make the item rarer, down to being missing
+                for (int range = 2; range <= 1024; range *= 4)
+                {
+                    const VDL_INDEX_T n = test_Lengths[j];
+                    VDL_VECTOR_P v      = test_RandomVector((VDL_TYPE_T) i, n + 1, range);
+                    VDL_VECTOR_P item   = test_RandomVector((VDL_TYPE_T) i, 1, range);
+                    agree &= test_FindAgree(v, item);
+                    agree &= test_FindAgree(vdl_Slice(v, 1, n + 1, 1), item);
+                }
+            }
+            vdl_GarbageCollectorCleanUp();
+        }
+    }
+    // expect(1)
+    test_printf("%d", agree);
+
+    // -0.0 is found by 0.0, a NaN is never found
+    VDL_VECTOR_P v = vdl_LocalDoubleVector(1.0, NAN, -0.0);
+    // expect(2 -1)
+    test_printf("%d %d", (int) vdl_FindScalar(v, vdl_LocalDoubleVector(0.0)), (int) vdl_FindScalar(v, vdl_LocalDoubleVector(NAN)));
+    vdl_GarbageCollectorKill();
+}
+
+int main(void)
+{
+    vdl_GarbageCollectorSetGrowthFactor(VDL_AUTO_COLLECTION_OFF);
+    srand(2023);
+
+    test_StrictEqual();
+    test_Which();
+    test_Find();
+
+    // exit(0)
+    return 0;
+}
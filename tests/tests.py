@@ -5,7 +5,7 @@ import test_meta
 
 def compile_c(filename):
     exe_name = filename.replace('.c', '')
-    command = f"clang -std=gnu17 -O3 -Wconversion -Wshadow -Wall -Wextra -Wpedantic -Wno-gnu-zero-variadic-macro-arguments -Wno-gnu-statement-expression -Werror {filename} -o {exe_name} 2> {exe_name}.compilemsg"
+    command = f"clang -std=gnu17 -O3 -Wconversion -Wshadow -Wall -Wextra -Wpedantic -Wno-gnu-zero-variadic-macro-arguments -Wno-gnu-statement-expression -Werror -pthread {filename} -o {exe_name} 2> {exe_name}.compilemsg"
     print(f"\tCompiling ./{filename} with \"{command}\".")
     success = os.system(command) == 0
     print(f"\t\t{['Failed', 'Succeed'][success]}!")